@@ -0,0 +1,207 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../libpsemu/include/analyzer.h"
+#include "../libpsemu/include/exe.h"
+#include "../libpsemu/include/file.h"
+
+/// @brief Address main RAM dumps are assumed to begin at, unless told
+/// otherwise
+constexpr PlayStation::Word RAM_BASE{ 0x80000000 };
+
+/// @brief Address exceptions are vectored to, which is always an entry point
+/// of a RAM dump containing the kernel
+constexpr PlayStation::Word EXCEPTION_VECTOR{ 0x80000080 };
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s [--base ADDR] [--entry ADDR]... [--scan-calls] "
+                 "[--output FILE]\n"
+                 "       [--symbols FILE] FILE\n"
+                 "\n"
+                 "Recovers the functions, basic blocks, calls and jump tables "
+                 "of a PS-X EXE or\n"
+                 "a dump of main RAM, and writes them as an index.\n"
+                 "\n"
+                 "  --base ADDR  Address a RAM dump begins at (default: "
+                 "0x80000000)\n"
+                 "  --entry ADDR Add a function entry point; may be given "
+                 "more than once\n"
+                 "  --scan-calls Also treat the target of every jal found "
+                 "anywhere as an\n"
+                 "               entry point (always done for RAM dumps)\n"
+                 "  --output FILE\n"
+                 "               Write the index to FILE instead of stdout\n"
+                 "  --symbols FILE\n"
+                 "               Write a name for every function to FILE in "
+                 "nm format, for\n"
+                 "               use with psemu_headless --symbols\n",
+                 program);
+}
+
+/// @brief Writes the output of the analyzer to a file.
+/// @param path The path of the file to write.
+/// @param write The method of the analyzer to call.
+/// @return `false` if the file couldn't be opened.
+static auto write_file(const char* path,
+                       const PlayStation::Analyzer& analyzer,
+                       void (PlayStation::Analyzer::*write)(FILE*) const)
+noexcept -> bool
+{
+    FILE* file{ std::fopen(path, "w") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    (analyzer.*write)(file);
+    std::fclose(file);
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path{ nullptr };
+    const char* output_path{ nullptr };
+    const char* symbols_path{ nullptr };
+    std::vector<PlayStation::Word> entries;
+    PlayStation::Word base{ RAM_BASE };
+    bool scan_calls{ false };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--base") == 0 && index + 1 < argc)
+        {
+            base = std::strtoul(argv[++index], nullptr, 16);
+        }
+        else if (std::strcmp(argv[index], "--entry") == 0 && index + 1 < argc)
+        {
+            entries.push_back(std::strtoul(argv[++index], nullptr, 16));
+        }
+        else if (std::strcmp(argv[index], "--scan-calls") == 0)
+        {
+            scan_calls = true;
+        }
+        else if (std::strcmp(argv[index], "--output") == 0 && index + 1 < argc)
+        {
+            output_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--symbols") == 0 &&
+                 index + 1 < argc)
+        {
+            symbols_path = argv[++index];
+        }
+        else if (argv[index][0] != '-' && !path)
+        {
+            path = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!path)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<PlayStation::Byte> data;
+
+    if (!PlayStation::read_file(path, data))
+    {
+        std::fprintf(stderr, "Unable to read %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::EXE exe;
+
+    // Anything that isn't an EXE is taken to be a RAM dump, whose entry
+    // points can only be guessed.
+    const bool is_exe{ exe.load(data) };
+
+    if (is_exe)
+    {
+        data = std::move(exe.text);
+        base = exe.dest;
+
+        entries.push_back(exe.pc);
+    }
+    else
+    {
+        entries.push_back(EXCEPTION_VECTOR);
+        scan_calls = true;
+    }
+
+    PlayStation::Analyzer analyzer{ data, base };
+
+    for (const auto entry : entries)
+    {
+        if (!analyzer.add_entry(entry) && entry != EXCEPTION_VECTOR)
+        {
+            std::fprintf(stderr,
+                         "Entry point 0x%08X is outside of the image\n",
+                         entry);
+        }
+    }
+
+    if (scan_calls)
+    {
+        analyzer.scan_calls();
+    }
+
+    analyzer.run();
+
+    std::fprintf(stderr,
+                 "%zu functions, %zu blocks, %zu calls, %zu jump tables\n",
+                 analyzer.functions.size(),
+                 analyzer.blocks.size(),
+                 analyzer.calls.size(),
+                 analyzer.jump_tables.size());
+
+    if (output_path)
+    {
+        if (!write_file(output_path,
+                        analyzer,
+                        &PlayStation::Analyzer::write_index))
+        {
+            std::fprintf(stderr, "Unable to write %s\n", output_path);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        analyzer.write_index(stdout);
+    }
+
+    if (symbols_path && !write_file(symbols_path,
+                                    analyzer,
+                                    &PlayStation::Analyzer::write_symbols))
+    {
+        std::fprintf(stderr, "Unable to write %s\n", symbols_path);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
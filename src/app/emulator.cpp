@@ -20,7 +20,63 @@
 /// @param parent The owner of this object.
 Emulator::Emulator(QObject* parent) noexcept : QThread(parent),
                                                disasm(cpu, bus)
-{ }
+{
+    // The status bar shows the GPU time too.
+    bus.perf = &perf;
+}
+
+/// @brief Stops the emulator and emits `time_to_inject_exe()` once the BIOS
+/// reaches the shell.
+auto Emulator::break_at_shell() noexcept -> void
+{
+    exe_hook = bus.hooks.add_breakpoint(SHELL_ADDRESS,
+    [](const PlayStation::Word)
+    {
+        return PlayStation::HookAction::Break;
+    });
+}
+
+/// @brief Runs for a number of frames with video and TTY output suppressed,
+/// then prints the results to stdout and emits `benchmark_finished()`. Call
+/// this right before the EXE starts.
+/// @param frames The number of frames to run.
+auto Emulator::start_benchmark(const unsigned long frames) noexcept -> void
+{
+    tty.discard();
+
+    benchmark_frames    = frames;
+    benchmark_completed = 0;
+    benchmark_start     = PlayStation::Perf::Clock::now();
+}
+
+/// @brief Publishes every frame rendered to other processes through a shared
+/// memory frame ring.
+/// @param name The name of the frame ring.
+/// @return `false` if the frame ring couldn't be created.
+auto Emulator::export_frames(const std::string& name) noexcept -> bool
+{
+    return exporter.open(name);
+}
+
+/// @brief Records every frame rendered to a video file.
+/// @param path The path of the file, see `PlayStation::Recorder`.
+/// @return `false` if the file couldn't be opened.
+auto Emulator::record(const std::string& path) noexcept -> bool
+{
+    return video.open(path);
+}
+
+/// @brief Prints the benchmark results and emits `benchmark_finished()`.
+auto Emulator::finish_benchmark() noexcept -> void
+{
+    PlayStation::Perf::print_benchmark(stdout,
+                                       benchmark_completed,
+                                       benchmark_completed * CYCLES_PER_FRAME,
+                                       PlayStation::Perf::Clock::now() -
+                                       benchmark_start);
+    benchmark_frames = 0;
+    emit benchmark_finished();
+}
 
 /// @brief Thread entry point.
 auto Emulator::run() -> void
@@ -34,43 +90,42 @@ auto Emulator::run() -> void
 
     for (;;)
     {
+        if (cycles == 0)
+        {
+            perf.begin_frame();
+        }
+
         while (cycles++ != max_cycles)
         {
-            if (cpu.pc == 0x80030000)
+            if (tracing)
             {
-                emit time_to_inject_exe();
-                //tracing = true;
-
-                // The thread will be restarted when the EXE is loaded.
-                quit();
-                break;
+                disasm.before();
             }
 
-            if (cpu.pc == 0x000000A0)
+            if (!step())
             {
-                switch (cpu.gpr[9])
+                if (hle.exited())
                 {
-                    case 0x3C:
-                        QTextStream(stdout) << static_cast<char>(cpu.gpr[4]);
-                        break;
-                }
-            }
+                    if (benchmark_frames != 0)
+                    {
+                        finish_benchmark();
+                        return;
+                    }
 
-            if (cpu.pc == 0x000000B0)
-            {
-                switch (cpu.gpr[9])
-                {
-                    case 0x3D:
-                        QTextStream(stdout) << static_cast<char>(cpu.gpr[4]);
-                        break;
+                    // Nothing left to run, keep showing the last frame.
+                    emit render_frame(bus.gpu.vram);
+                    return;
                 }
-            }
 
-            if (tracing)
-            {
-                disasm.before();
+                // The only other breakpoint we register is the one for EXE
+                // injection, which we only need once.
+                bus.hooks.remove(exe_hook);
+                emit time_to_inject_exe();
+                //tracing = true;
+
+                // The thread will be restarted when the EXE is loaded.
+                return;
             }
-            step();
 
             if (tracing)
             {
@@ -79,6 +134,26 @@ auto Emulator::run() -> void
             }
         }
         cycles = 0;
+
+        if (perf.end_frame(max_cycles))
+        {
+            emit perf_updated(perf.counters());
+        }
+
+        if (benchmark_frames != 0)
+        {
+            if (++benchmark_completed == benchmark_frames)
+            {
+                finish_benchmark();
+                return;
+            }
+
+            // Video output is suppressed while benchmarking.
+            continue;
+        }
+        exporter.publish(bus.gpu.vram);
+        video.push(bus.gpu.vram);
+
         emit render_frame(bus.gpu.vram);
     }
 }
@@ -31,6 +31,27 @@ public:
     /// @brief Thread entry point.
     auto run() -> void;
 
+    /// @brief Stops the emulator and emits `time_to_inject_exe()` once the
+    /// BIOS reaches the shell.
+    auto break_at_shell() noexcept -> void;
+
+    /// @brief Runs for a number of frames with video and TTY output
+    /// suppressed, then prints the results to stdout and emits
+    /// `benchmark_finished()`. Call this right before the EXE starts.
+    /// @param frames The number of frames to run.
+    auto start_benchmark(const unsigned long frames) noexcept -> void;
+
+    /// @brief Publishes every frame rendered to other processes through a
+    /// shared memory frame ring.
+    /// @param name The name of the frame ring.
+    /// @return `false` if the frame ring couldn't be created.
+    auto export_frames(const std::string& name) noexcept -> bool;
+
+    /// @brief Records every frame rendered to a video file.
+    /// @param path The path of the file, see `PlayStation::Recorder`.
+    /// @return `false` if the file couldn't be opened.
+    auto record(const std::string& path) noexcept -> bool;
+
 private:
     /// @brief Disassembler instance
     Disassembler disasm;
@@ -38,10 +59,38 @@ private:
     /// @brief Are we generating a trace log?
     bool tracing{ false };
 
+    /// @brief Breakpoint used to determine when to inject the EXE
+    PlayStation::Hooks::Handle exe_hook;
+
+    /// @brief Number of frames to benchmark, or 0 if not benchmarking
+    unsigned long benchmark_frames{ 0 };
+
+    /// @brief Number of frames benchmarked so far
+    unsigned long benchmark_completed{ 0 };
+
+    /// @brief When the benchmark started
+    PlayStation::Perf::Clock::time_point benchmark_start;
+
+    /// @brief Frame ring frames are published to, if enabled
+    PlayStation::FrameExport exporter;
+
+    /// @brief Recorder frames are queued to, if enabled
+    PlayStation::Recorder video;
+
+    /// @brief Prints the benchmark results and emits `benchmark_finished()`.
+    auto finish_benchmark() noexcept -> void;
+
 signals:
     /// @brief Emitted when it is time to render a frame.
     void render_frame(const PlayStation::VRAM& vram);
 
     /// @brief Emitted when it is time to inject the EXE.
     void time_to_inject_exe();
+
+    /// @brief Emitted when the performance counters have been updated.
+    void perf_updated(const PlayStation::Perf::Counters& counters);
+
+    /// @brief Emitted when the benchmark started by `start_benchmark()` has
+    /// finished.
+    void benchmark_finished();
 };
@@ -13,6 +13,7 @@
 // CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include "psemu.h"
 
 int main(int argc, char* argv[])
@@ -22,6 +23,47 @@ int main(int argc, char* argv[])
     qt.setApplicationName("psemu");
     qt.setApplicationVersion("1.0");
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PlayStation emulator");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption fast_boot_option
+    {
+        "fast-boot",
+        "Start the EXE directly, without executing the BIOS."
+    };
+
+    const QCommandLineOption benchmark_option
+    {
+        "benchmark",
+        "Run the EXE for <frames> frames with video output suppressed, then "
+        "print the wall time, FPS, MIPS and peak RSS and quit.",
+        "frames"
+    };
+
+    const QCommandLineOption export_option
+    {
+        "export",
+        "Publish every frame to other processes through a shared memory ring "
+        "named <name>, e.g. /psemu.",
+        "name"
+    };
+
+    const QCommandLineOption record_option
+    {
+        "record",
+        "Record every frame to <file>: YUV4MPEG2 if it ends in .y4m, FFV1 "
+        "through ffmpeg otherwise.",
+        "file"
+    };
+
+    parser.addOption(fast_boot_option);
+    parser.addOption(benchmark_option);
+    parser.addOption(export_option);
+    parser.addOption(record_option);
+    parser.process(qt);
+
     // Required to ensure that we are able to acquire an OpenGL 3.2 Core
     // profile.
     QSurfaceFormat fmt;
@@ -30,7 +72,15 @@ int main(int argc, char* argv[])
     QSurfaceFormat::setDefaultFormat(fmt);
 
     qRegisterMetaType<PlayStation::VRAM>("PlayStation::VRAM");
+    qRegisterMetaType<PlayStation::Perf::Counters>
+    ("PlayStation::Perf::Counters");
 
-    PSEmu psemu;
+    PSEmu psemu
+    {
+        parser.isSet(fast_boot_option),
+        parser.value(benchmark_option).toULong(),
+        parser.value(export_option),
+        parser.value(record_option)
+    };
     return qt.exec();
 }
@@ -12,70 +12,107 @@
 // OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
 // CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
+#include <QCoreApplication>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QStatusBar>
 #include "psemu.h"
 #include "../libpsemu/include/types.h"
 
-PSEmu::PSEmu() noexcept : emu_thread(new Emulator(this))
+PSEmu::PSEmu(const bool fast_boot,
+             const unsigned long benchmark_frames,
+             const QString& export_name,
+             const QString& record_file) noexcept :
+emu_thread(new Emulator(this))
 {
-    const auto bios_file{ file_open_force("Select PlayStation BIOS",
-                                          "PlayStation BIOS files (*.bin)") };
+    if (!export_name.isEmpty() &&
+        !emu_thread->export_frames(export_name.toStdString()))
+    {
+        QMessageBox::critical(nullptr,
+                              tr("Error"),
+                              QString("Unable to create frame ring %1")
+                              .arg(export_name));
+        exit(EXIT_FAILURE);
+    }
+
+    if (!record_file.isEmpty() &&
+        !emu_thread->record(record_file.toStdString()))
+    {
+        QMessageBox::critical(nullptr,
+                              tr("Error"),
+                              QString("Unable to record to %1")
+                              .arg(record_file));
+        exit(EXIT_FAILURE);
+    }
+
+    const auto bios_file
+    {
+        fast_boot ? QString() :
+                    file_open_force("Select PlayStation BIOS",
+                                    "PlayStation BIOS files (*.bin)")
+    };
 
     const auto exe_file{ file_open_force("Select PS-X EXE",
                                          "PS-X EXEs (*.exe)") };
 
-    load_bios_file(bios_file);
+    const auto exe{ load_exe_file(exe_file) };
 
     connect(emu_thread, &Emulator::render_frame, &opengl, &OpenGL::render_frame);
 
-    connect(emu_thread, &Emulator::time_to_inject_exe, this, [=]()
+    connect(emu_thread, &Emulator::perf_updated, this,
+    [=](const PlayStation::Perf::Counters& counters)
     {
-        QFile file(exe_file);
+        using PlayStation::Perf;
 
-        if (!file.open(QIODevice::ReadOnly))
+        const auto message
         {
-            const auto error_string{ QString("Unable to open %1: %2")
-                                     .arg(exe_file)
-                                     .arg(file.errorString()) };
-
-            QMessageBox::critical(nullptr, tr("Error"), error_string);
-            exit(EXIT_FAILURE);
-        }
-
-        const auto file_handle{ file.readAll() };
-        const auto file_data{ file_handle.constData() };
+            QString("%1 MIPS | %2 FPS (%3%) | CPU %4 ms, GPU %5 ms")
+            .arg(counters.instructions_per_second / 1000000.0, 0, 'f', 2)
+            .arg(counters.frames_per_second, 0, 'f', 1)
+            .arg(counters.speed, 0, 'f', 0)
+            .arg(counters.frame_time[Perf::CPU], 0, 'f', 2)
+            .arg(counters.frame_time[Perf::GPU], 0, 'f', 2)
+        };
+
+        main_window.statusBar()->showMessage(message);
+    });
 
-        PlayStation::Word initial_pc;
-        PlayStation::Word initial_gp;
-        PlayStation::Word dest_in_ram;
-        PlayStation::Word file_size;
+    connect(emu_thread,
+            &Emulator::benchmark_finished,
+            QCoreApplication::instance(),
+            &QCoreApplication::quit);
 
-        std::memcpy(&initial_pc,  &file_data[0x10], sizeof(PlayStation::Word));
-        std::memcpy(&initial_gp,  &file_data[0x14], sizeof(PlayStation::Word));
-        std::memcpy(&dest_in_ram, &file_data[0x18], sizeof(PlayStation::Word));
-        std::memcpy(&file_size,   &file_data[0x1C], sizeof(PlayStation::Word));
+    if (fast_boot)
+    {
+        emu_thread->fast_boot(exe);
 
-        for (auto index{ 0x800 }; index != file_size;
-             index += 4, dest_in_ram += 4)
+        if (benchmark_frames != 0)
         {
-            std::memcpy(&emu_thread->bus.ram.data()[dest_in_ram & 0x1FFF'FFFF],
-                        &file_data[index],
-                        sizeof(PlayStation::Word));
+            emu_thread->start_benchmark(benchmark_frames);
         }
+    }
+    else
+    {
+        load_bios_file(bios_file);
+        emu_thread->break_at_shell();
 
-        file.close();
-
-        emu_thread->cpu.pc      = initial_pc;
-        emu_thread->cpu.next_pc = initial_pc + 4;
+        connect(emu_thread, &Emulator::time_to_inject_exe, this, [=]()
+        {
+            // The signal is emitted right before the emulator thread returns,
+            // make sure it has actually stopped before we touch its state.
+            emu_thread->wait();
+            emu_thread->load_exe(exe);
 
-        emu_thread->cpu.instruction.word =
-        emu_thread->bus.memory_access<PlayStation::Word>(emu_thread->cpu.pc);
+            if (benchmark_frames != 0)
+            {
+                emu_thread->start_benchmark(benchmark_frames);
+            }
 
-        // The emulator thread is halted during this process, restart it now
-        // that the EXE has been injected.
-        emu_thread->start();
-    });
+            // The emulator thread is halted during this process, restart it
+            // now that the EXE has been injected.
+            emu_thread->start();
+        });
+    }
 
     main_window.setCentralWidget(&opengl);
     main_window.show();
@@ -83,6 +120,41 @@ PSEmu::PSEmu() noexcept : emu_thread(new Emulator(this))
     emu_thread->start();
 }
 
+/// @brief Load a PS-X EXE for use by the emulator.
+/// @param file_name The file path to load the EXE from.
+/// @return The parsed EXE.
+auto PSEmu::load_exe_file(const QString& file_name) noexcept
+-> PlayStation::EXE
+{
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        const auto error_string{ QString("Unable to open %1: %2")
+                                .arg(file_name)
+                                .arg(file.errorString()) };
+
+        QMessageBox::critical(nullptr, tr("Error"), error_string);
+        exit(EXIT_FAILURE);
+    }
+
+    const auto file_data{ file.readAll() };
+    file.close();
+
+    const std::vector<PlayStation::Byte> data(file_data.cbegin(),
+                                              file_data.cend());
+    PlayStation::EXE exe;
+
+    if (!exe.load(data))
+    {
+        QMessageBox::critical(nullptr,
+                              tr("Error"),
+                              QString("%1 is not a PS-X EXE").arg(file_name));
+        exit(EXIT_FAILURE);
+    }
+    return exe;
+}
+
 /// @brief Load a BIOS file for use by the emulator.
 /// @param file The file path to load the BIOS data from.
 auto PSEmu::load_bios_file(const QString& file_name) noexcept -> void
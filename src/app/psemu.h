@@ -25,13 +25,29 @@ class PSEmu : public QObject
     Q_OBJECT
 
 public:
-    PSEmu() noexcept;
+    /// @brief Initializes the main controller.
+    /// @param fast_boot Start the EXE without executing the BIOS?
+    /// @param benchmark_frames Number of frames to run the EXE for before
+    /// printing benchmark results and quitting, or 0 to run normally.
+    /// @param export_name Name of the shared memory frame ring to publish
+    /// frames to, or an empty string not to.
+    /// @param record_file File to record frames to, or an empty string not
+    /// to.
+    PSEmu(const bool fast_boot,
+          const unsigned long benchmark_frames,
+          const QString& export_name,
+          const QString& record_file) noexcept;
 
 private:
     /// @brief Load a BIOS file for use by the emulator.
     /// @param file The file path to load the BIOS data from.
     auto load_bios_file(const QString& file_name) noexcept -> void;
 
+    /// @brief Load a PS-X EXE for use by the emulator.
+    /// @param file_name The file path to load the EXE from.
+    /// @return The parsed EXE.
+    auto load_exe_file(const QString& file_name) noexcept -> PlayStation::EXE;
+
     /// @brief Spawn a QFileDialog and force the user to choose a file, or
     /// quit the program.
     /// @param title The title of the QFileDialog.
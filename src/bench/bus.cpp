@@ -0,0 +1,107 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <memory>
+#include <benchmark/benchmark.h>
+#include "../libpsemu/include/bus.h"
+
+using namespace PlayStation;
+
+/// @brief Reads from the same address repeatedly.
+/// @tparam T The width of the access.
+template<typename T>
+static void BM_Bus_Read(benchmark::State& state)
+{
+    auto bus{ std::make_unique<SystemBus>() };
+    const auto vaddr{ static_cast<Word>(state.range(0)) };
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(bus->memory_access<T>(vaddr));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief Writes to the same address repeatedly.
+/// @tparam T The width of the access.
+template<typename T>
+static void BM_Bus_Write(benchmark::State& state)
+{
+    auto bus{ std::make_unique<SystemBus>() };
+    const auto vaddr{ static_cast<Word>(state.range(0)) };
+
+    for (auto _ : state)
+    {
+        bus->memory_access<T>(vaddr, 0);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief Resets the bus after writing to a number of main RAM pages, as a
+/// fuzzer or test runner does between runs.
+static void BM_Bus_Reset(benchmark::State& state)
+{
+    auto bus{ std::make_unique<SystemBus>() };
+    const auto pages{ static_cast<Word>(state.range(0)) };
+
+    bus->reset();
+
+    for (auto _ : state)
+    {
+        for (Word page{ 0 }; page < pages; ++page)
+        {
+            bus->memory_access<Word>(0x80000000 + (page * DIRTY_PAGE_SIZE), 1);
+        }
+        bus->reset();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Main RAM, scratchpad, BIOS and GPUSTAT respectively
+BENCHMARK_TEMPLATE(BM_Bus_Read, Byte)->ArgName("vaddr")
+                                     ->Arg(0x80010000)
+                                     ->Arg(0x1F800000)
+                                     ->Arg(0xBFC00000);
+
+BENCHMARK_TEMPLATE(BM_Bus_Read, Halfword)->ArgName("vaddr")
+                                         ->Arg(0x80010000)
+                                         ->Arg(0x1F800000)
+                                         ->Arg(0xBFC00000);
+
+BENCHMARK_TEMPLATE(BM_Bus_Read, Word)->ArgName("vaddr")
+                                     ->Arg(0x80010000)
+                                     ->Arg(0x1F800000)
+                                     ->Arg(0xBFC00000)
+                                     ->Arg(0x1F801814);
+
+// Main RAM and scratchpad respectively
+BENCHMARK_TEMPLATE(BM_Bus_Write, Byte)->ArgName("vaddr")
+                                      ->Arg(0x80010000)
+                                      ->Arg(0x1F800000);
+
+BENCHMARK_TEMPLATE(BM_Bus_Write, Halfword)->ArgName("vaddr")
+                                          ->Arg(0x80010000)
+                                          ->Arg(0x1F800000);
+
+BENCHMARK_TEMPLATE(BM_Bus_Write, Word)->ArgName("vaddr")
+                                      ->Arg(0x80010000)
+                                      ->Arg(0x1F800000);
+
+// No pages written, a few, and all of main RAM respectively
+BENCHMARK(BM_Bus_Reset)->ArgName("pages")
+                       ->Arg(0)
+                       ->Arg(16)
+                       ->Arg(SystemBus::RAM_PAGES);
@@ -0,0 +1,142 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "../libpsemu/include/bus.h"
+#include "../libpsemu/include/cpu.h"
+
+using namespace PlayStation;
+
+/// @brief Address the programs are loaded to
+constexpr Word PROGRAM_ADDRESS{ 0x80010000 };
+
+/// @brief Defines a CPU running a synthetic program in a loop.
+struct Machine
+{
+    /// @brief Loads a program and points the CPU to it. A jump back to the
+    /// beginning is appended to the program.
+    /// @param program The instructions of the program.
+    explicit Machine(const std::vector<Word>& program) noexcept : cpu(bus)
+    {
+        auto vaddr{ PROGRAM_ADDRESS };
+
+        for (const auto instruction : program)
+        {
+            bus.memory_access<Word>(vaddr, instruction);
+            vaddr += 4;
+        }
+
+        bus.memory_access<Word>(vaddr,
+                                0x08000000 | ((PROGRAM_ADDRESS & 0x0FFFFFFF)
+                                              >> 2));
+        bus.memory_access<Word>(vaddr + 4, 0x00000000);
+
+        cpu.reset();
+        cpu.set_pc(PROGRAM_ADDRESS);
+    }
+
+    SystemBus bus;
+    CPU cpu;
+};
+
+/// @brief Executes a program one instruction at a time.
+/// @param state The benchmark state.
+/// @param program The instructions of the program.
+/// @param setup Registers to initialize, as pairs of register and value.
+static auto run(benchmark::State& state,
+                const std::vector<Word>& program,
+                const std::vector<std::pair<unsigned int, Word>>& setup = { })
+noexcept -> void
+{
+    // SystemBus is too large for the stack.
+    auto machine{ std::make_unique<Machine>(program) };
+
+    for (const auto& [reg, value] : setup)
+    {
+        machine->cpu.gpr[reg] = value;
+    }
+
+    for (auto _ : state)
+    {
+        machine->cpu.step();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief Arithmetic, logical and shift instructions.
+static void BM_CPU_ALU(benchmark::State& state)
+{
+    run(state,
+    {
+        0x24080001, // addiu $t0, $zero, 1
+        0x24090002, // addiu $t1, $zero, 2
+        0x01095021, // addu  $t2, $t0, $t1
+        0x01495825, // or    $t3, $t2, $t1
+        0x000B6080, // sll   $t4, $t3, 2
+        0x018B6826, // xor   $t5, $t4, $t3
+        0x01A87023, // subu  $t6, $t5, $t0
+        0x01C9782A, // slt   $t7, $t6, $t1
+        0x3C181234, // lui   $t8, 0x1234
+        0x37185678, // ori   $t8, $t8, 0x5678
+        0x0018C843, // sra   $t9, $t8, 1
+        0x03284024, // and   $t0, $t9, $t0
+        0x01094827, // nor   $t1, $t0, $t1
+        0x2D2A0010  // sltiu $t2, $t1, 16
+    });
+}
+BENCHMARK(BM_CPU_ALU);
+
+/// @brief A tight countdown loop, where every other instruction is a taken
+/// branch.
+static void BM_CPU_Branch(benchmark::State& state)
+{
+    run(state,
+    {
+        0x24080010, // addiu $t0, $zero, 16
+        0x2508FFFF, // addiu $t0, $t0, -1      <-+
+        0x1500FFFE, // bne   $t0, $zero, -2   ---+
+        0x00000000, // nop
+        0x10000001, // b     +1
+        0x00000000, // nop
+        0x1D000000, // bgtz  $t0, +0
+        0x00000000  // nop
+    });
+}
+BENCHMARK(BM_CPU_Branch);
+
+/// @brief Loads and stores of every width, relative to a base address given
+/// as the argument.
+static void BM_CPU_LoadStore(benchmark::State& state)
+{
+    run(state,
+    {
+        0xAD090000, // sw  $t1, 0($t0)
+        0x8D0A0000, // lw  $t2, 0($t0)
+        0xA5090004, // sh  $t1, 4($t0)
+        0x950B0004, // lhu $t3, 4($t0)
+        0xA1090008, // sb  $t1, 8($t0)
+        0x810C0008, // lb  $t4, 8($t0)
+        0x8D0D0000, // lw  $t5, 0($t0)
+        0x00000000  // nop
+    },
+    {
+        { 8, static_cast<Word>(state.range(0)) }, // $t0
+        { 9, 0x12345678 }                         // $t1
+    });
+}
+BENCHMARK(BM_CPU_LoadStore)->ArgName("base")
+                           ->Arg(0x80100000)  // Main RAM
+                           ->Arg(0x1F800000); // Scratchpad
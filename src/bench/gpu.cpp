@@ -0,0 +1,88 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <memory>
+#include <benchmark/benchmark.h>
+#include "../libpsemu/include/gpu.h"
+
+using namespace PlayStation;
+
+/// @brief GP0(0x68) - Monochrome Rectangle (1x1), one packet per iteration.
+static void BM_GPU_Dot(benchmark::State& state)
+{
+    auto gpu{ std::make_unique<GPU>() };
+    gpu->reset();
+
+    Word position{ 0 };
+
+    for (auto _ : state)
+    {
+        gpu->gp0(0x68FF8040);
+        gpu->gp0(position++ & 0x00FF03FF);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GPU_Dot);
+
+/// @brief GP0(0xA0) - Copy Rectangle (CPU to VRAM) of a square with sides of
+/// the argument, one rectangle per iteration.
+static void BM_GPU_VRAMWrite(benchmark::State& state)
+{
+    auto gpu{ std::make_unique<GPU>() };
+    gpu->reset();
+
+    const auto size{ static_cast<Word>(state.range(0)) };
+    const auto words{ (size * size) / 2 };
+
+    for (auto _ : state)
+    {
+        gpu->gp0(0xA0000000);
+        gpu->gp0(0x00000000);
+        gpu->gp0((size << 16) | size);
+
+        for (Word word{ 0 }; word < words; ++word)
+        {
+            gpu->gp0(word);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * words * sizeof(Word));
+}
+BENCHMARK(BM_GPU_VRAMWrite)->ArgName("size")->Arg(16)->Arg(64)->Arg(256);
+
+/// @brief GP0(0xC0) - Copy Rectangle (VRAM to CPU) of a square with sides of
+/// the argument, one rectangle per iteration.
+static void BM_GPU_VRAMRead(benchmark::State& state)
+{
+    auto gpu{ std::make_unique<GPU>() };
+    gpu->reset();
+
+    const auto size{ static_cast<Word>(state.range(0)) };
+    const auto words{ (size * size) / 2 };
+
+    for (auto _ : state)
+    {
+        gpu->gp0(0xC0000000);
+        gpu->gp0(0x00000000);
+        gpu->gp0((size << 16) | size);
+
+        // The GPU produces a word in GPUREAD for every word written.
+        for (Word word{ 0 }; word < words; ++word)
+        {
+            gpu->gp0(0);
+            benchmark::DoNotOptimize(gpu->gpuread);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * words * sizeof(Word));
+}
+BENCHMARK(BM_GPU_VRAMRead)->ArgName("size")->Arg(16)->Arg(64)->Arg(256);
@@ -0,0 +1,43 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <memory>
+#include <benchmark/benchmark.h>
+#include "../libpsemu/include/memory_search.h"
+
+using namespace PlayStation;
+
+/// @brief A pass of a search for unchanged values over all of main RAM. Main
+/// RAM never changes, so every value stays a candidate and each pass is as
+/// slow as it gets.
+/// @tparam W The width of the values.
+template<MemorySearch::Width W>
+static void BM_Search_Unchanged(benchmark::State& state)
+{
+    auto bus{ std::make_unique<SystemBus>() };
+    bus->reset();
+
+    MemorySearch search;
+    search.start(*bus, W);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+        search.compare_previous(*bus, MemorySearch::Comparison::Equal));
+    }
+    state.SetBytesProcessed(state.iterations() * RAM_SIZE);
+}
+BENCHMARK_TEMPLATE(BM_Search_Unchanged, MemorySearch::Width::Byte);
+BENCHMARK_TEMPLATE(BM_Search_Unchanged, MemorySearch::Width::Halfword);
+BENCHMARK_TEMPLATE(BM_Search_Unchanged, MemorySearch::Width::Word);
@@ -0,0 +1,261 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef PSEMU_H
+#define PSEMU_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @file
+/// @brief C interface to the emulator, for embedding it in programs that
+/// aren't written in C++.
+///
+/// Every function taking a `psemu*` must be given one returned by
+/// `psemu_create()`. Instances are independent of one another and may be used
+/// from different threads, but a single instance must not be used by more
+/// than one thread at a time, except for the `psemu_read_mirrored_*()`
+/// functions. Apart from `psemu_create()`, `psemu_load_exe()`,
+/// `psemu_enable_mirror()` and `psemu_add_cheats()`, and
+/// `psemu_save_state()` and `psemu_load_state()` the first time they're
+/// called, no function allocates memory: data is always copied into and out
+/// of buffers provided by the caller.
+
+#if defined(_WIN32)
+#define PSEMU_API __declspec(dllexport)
+#else
+#define PSEMU_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Version of this interface, incremented whenever it changes
+/// incompatibly
+#define PSEMU_API_VERSION 1
+
+/// @brief Size of a BIOS image, in bytes
+#define PSEMU_BIOS_SIZE 524288
+
+/// @brief Size of main RAM, in bytes
+#define PSEMU_RAM_SIZE 2097152
+
+/// @brief Width of the frame buffer, in pixels
+#define PSEMU_FRAMEBUFFER_WIDTH 1024
+
+/// @brief Height of the frame buffer, in pixels
+#define PSEMU_FRAMEBUFFER_HEIGHT 512
+
+/// @brief Results returned by the functions below.
+typedef enum psemu_result
+{
+    /// @brief The function succeeded.
+    PSEMU_OK = 0,
+
+    /// @brief The EXE has exited, see `psemu_exit_code()`.
+    PSEMU_EXITED = 1,
+
+    /// @brief An argument is out of range, or a buffer is too small.
+    PSEMU_ERROR_ARGUMENT = -1,
+
+    /// @brief The data given is not of the expected format.
+    PSEMU_ERROR_FORMAT = -2,
+
+    /// @brief No EXE has been loaded.
+    PSEMU_ERROR_NO_EXE = -3,
+
+    /// @brief `psemu_enable_mirror()` hasn't been called.
+    PSEMU_ERROR_NO_MIRROR = -4,
+
+    /// @brief There isn't enough memory.
+    PSEMU_ERROR_MEMORY = -5
+} psemu_result;
+
+/// @brief An emulated system.
+typedef struct psemu psemu;
+
+/// @brief Called with the TTY output of the guest, one line at a time.
+/// @param user The pointer given to `psemu_set_tty_callback()`.
+/// @param data The characters. This is not NUL-terminated.
+/// @param size The number of characters.
+typedef void (*psemu_tty_callback)(void* user, const char* data, size_t size);
+
+/// @brief Returns `PSEMU_API_VERSION` as the library was built with it.
+PSEMU_API uint32_t psemu_api_version(void);
+
+/// @brief Creates a system.
+/// @return The system, or NULL if there isn't enough memory.
+PSEMU_API psemu* psemu_create(void);
+
+/// @brief Destroys a system.
+/// @param ps The system to destroy, or NULL.
+PSEMU_API void psemu_destroy(psemu* ps);
+
+/// @brief Sets the BIOS to boot EXEs loaded afterwards through. Without a
+/// BIOS, EXEs are started directly.
+/// @param ps The system.
+/// @param data The BIOS image.
+/// @param size The size of the image, which must be `PSEMU_BIOS_SIZE`.
+PSEMU_API psemu_result psemu_load_bios(psemu* ps,
+                                       const uint8_t* data,
+                                       size_t size);
+
+/// @brief Loads a PS-X EXE and boots the system into it.
+/// @param ps The system.
+/// @param data The EXE.
+/// @param size The size of the EXE, in bytes.
+/// @return `PSEMU_ERROR_FORMAT` if the data is not a PS-X EXE, or if the BIOS
+/// never reaches the point where the EXE is started. No EXE is loaded then.
+PSEMU_API psemu_result psemu_load_exe(psemu* ps,
+                                      const uint8_t* data,
+                                      size_t size);
+
+/// @brief Boots the system into the loaded EXE again.
+/// @param ps The system.
+/// @return `PSEMU_ERROR_FORMAT` if the BIOS never reaches the point where the
+/// EXE is started, after which no EXE is loaded.
+PSEMU_API psemu_result psemu_reset(psemu* ps);
+
+/// @brief Runs the system for one frame.
+/// @param ps The system.
+/// @return `PSEMU_EXITED` once the EXE has exited, after which the system no
+/// longer runs until it is reset.
+PSEMU_API psemu_result psemu_run_frame(psemu* ps);
+
+/// @brief Returns the exit code of the EXE, if it has exited.
+/// @param ps The system.
+PSEMU_API uint32_t psemu_exit_code(const psemu* ps);
+
+/// @brief Sets the buttons held on a controller port.
+/// @param ps The system.
+/// @param port The port, 0 or 1.
+/// @param buttons The buttons, active low as the hardware reports them.
+PSEMU_API psemu_result psemu_set_pad(psemu* ps,
+                                     uint32_t port,
+                                     uint16_t buttons);
+
+/// @brief Sends the TTY output of the guest to a callback. By default, it is
+/// written to stdout.
+/// @param ps The system.
+/// @param callback The function to call, or NULL to discard the output.
+/// @param user Passed to `callback` as is.
+PSEMU_API void psemu_set_tty_callback(psemu* ps,
+                                      psemu_tty_callback callback,
+                                      void* user);
+
+/// @brief Copies the frame buffer, i.e. all of VRAM. Pixels are 15-bit BGR,
+/// red in the lower bits.
+/// @param ps The system.
+/// @param pixels Where to copy the frame buffer.
+/// @param count The number of pixels `pixels` can hold, which must be at
+/// least `PSEMU_FRAMEBUFFER_WIDTH * PSEMU_FRAMEBUFFER_HEIGHT`.
+PSEMU_API psemu_result psemu_get_framebuffer(const psemu* ps,
+                                             uint16_t* pixels,
+                                             size_t count);
+
+/// @brief Copies memory out of main RAM.
+/// @param ps The system.
+/// @param address The offset into main RAM to start at, e.g. 0x10000 for
+/// 0x80010000.
+/// @param data Where to copy the memory.
+/// @param size The number of bytes to copy.
+PSEMU_API psemu_result psemu_read_ram(const psemu* ps,
+                                      uint32_t address,
+                                      uint8_t* data,
+                                      size_t size);
+
+/// @brief Copies memory into main RAM.
+/// @param ps The system.
+/// @param address The offset into main RAM to start at.
+/// @param data The memory to copy.
+/// @param size The number of bytes to copy.
+PSEMU_API psemu_result psemu_write_ram(psemu* ps,
+                                       uint32_t address,
+                                       const uint8_t* data,
+                                       size_t size);
+
+/// @brief Returns the size of a save state, in bytes, which is the same for
+/// every system.
+PSEMU_API size_t psemu_state_size(void);
+
+/// @brief Saves the state of the system.
+/// @param ps The system.
+/// @param data Where to write the state.
+/// @param size The size of `data`, which must be at least
+/// `psemu_state_size()`.
+PSEMU_API psemu_result psemu_save_state(psemu* ps, uint8_t* data, size_t size);
+
+/// @brief Restores a state written by `psemu_save_state()`, which may come
+/// from another system using the same BIOS.
+/// @param ps The system.
+/// @param data The state.
+/// @param size The size of the state.
+PSEMU_API psemu_result psemu_load_state(psemu* ps,
+                                        const uint8_t* data,
+                                        size_t size);
+
+/// @brief Starts publishing main RAM and the frame buffer at the end of
+/// every frame, so that other threads can read them while the system runs.
+/// This must be called before any other thread reads the mirror.
+/// @param ps The system.
+/// @return `PSEMU_ERROR_MEMORY` if there isn't enough memory.
+PSEMU_API psemu_result psemu_enable_mirror(psemu* ps);
+
+/// @brief Same as `psemu_read_ram()`, but reads main RAM as of the end of the
+/// last frame and may be called from any thread, even while another one is
+/// running the system. This never blocks the system.
+/// @param ps The system.
+/// @param address The offset into main RAM to start at.
+/// @param data Where to copy the memory.
+/// @param size The number of bytes to copy.
+/// @param frame Where to store the number of the frame the copy is from, or
+/// NULL. This is 0 until a frame has been run.
+PSEMU_API psemu_result psemu_read_mirrored_ram(const psemu* ps,
+                                               uint32_t address,
+                                               uint8_t* data,
+                                               size_t size,
+                                               uint64_t* frame);
+
+/// @brief Same as `psemu_get_framebuffer()`, but reads the frame buffer as of
+/// the end of the last frame and may be called from any thread, as with
+/// `psemu_read_mirrored_ram()`.
+/// @param ps The system.
+/// @param pixels Where to copy the frame buffer.
+/// @param count The number of pixels `pixels` can hold.
+/// @param frame Where to store the number of the frame the copy is from, or
+/// NULL.
+PSEMU_API psemu_result psemu_read_mirrored_framebuffer(const psemu* ps,
+                                                       uint16_t* pixels,
+                                                       size_t count,
+                                                       uint64_t* frame);
+
+/// @brief Adds GameShark codes, applied to main RAM at the end of every
+/// frame from then on.
+/// @param ps The system.
+/// @param codes The codes, one per line as "AAAAAAAA VVVV" or separated by
+/// '+'.
+/// @return `PSEMU_ERROR_FORMAT` if a code is malformed or of an unsupported
+/// type, in which case none of them are added.
+PSEMU_API psemu_result psemu_add_cheats(psemu* ps, const char* codes);
+
+/// @brief Removes every code added by `psemu_add_cheats()`.
+/// @param ps The system.
+PSEMU_API void psemu_clear_cheats(psemu* ps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PSEMU_H
@@ -0,0 +1,357 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+#include "../libpsemu/include/ps.h"
+#include "../libpsemu/include/snapshot.h"
+#include "include/psemu.h"
+
+// The constants in the C header have to be kept in sync by hand.
+static_assert(PSEMU_BIOS_SIZE == PlayStation::BIOS_SIZE);
+static_assert(PSEMU_RAM_SIZE == PlayStation::RAM_SIZE);
+static_assert(PSEMU_FRAMEBUFFER_WIDTH == PlayStation::VRAM_WIDTH);
+static_assert(PSEMU_FRAMEBUFFER_HEIGHT == PlayStation::VRAM_HEIGHT);
+
+/// @brief An emulated system, along with what is needed to boot it again.
+struct psemu
+{
+    /// @brief The system
+    PlayStation::System system;
+
+    /// @brief The EXE being run
+    PlayStation::EXE exe;
+
+    /// @brief Has an EXE been loaded?
+    bool has_exe{ false };
+
+    /// @brief Has a BIOS been loaded?
+    bool has_bios{ false };
+
+    /// @brief State being saved or loaded, kept around so that its buffers
+    /// are only allocated once
+    PlayStation::Snapshot state;
+
+    /// @brief Copy of memory for other threads, once enabled
+    std::unique_ptr<PlayStation::MemoryMirror> mirror;
+
+    /// @brief Cheat codes applied at the end of every frame
+    PlayStation::Cheats cheats;
+};
+
+/// @brief Boots a system and starts its EXE.
+/// @param ps The system to boot.
+/// @return `false` if the BIOS didn't reach the shell.
+static auto boot(psemu& ps) noexcept -> bool
+{
+    if (ps.has_bios)
+    {
+        return ps.system.boot_exe(ps.exe);
+    }
+
+    ps.system.fast_boot(ps.exe);
+    return true;
+}
+
+/// @brief Determines if a range is entirely within main RAM.
+/// @param address The offset into main RAM the range starts at.
+/// @param size The size of the range, in bytes.
+static auto in_ram(const std::uint32_t address, const std::size_t size)
+noexcept -> bool
+{
+    return address <= PlayStation::RAM_SIZE &&
+           size <= PlayStation::RAM_SIZE - address;
+}
+
+PSEMU_API uint32_t psemu_api_version(void)
+{
+    return PSEMU_API_VERSION;
+}
+
+PSEMU_API psemu* psemu_create(void)
+{
+    return new (std::nothrow) psemu;
+}
+
+PSEMU_API void psemu_destroy(psemu* ps)
+{
+    delete ps;
+}
+
+PSEMU_API psemu_result psemu_load_bios(psemu* ps,
+                                       const uint8_t* data,
+                                       size_t size)
+{
+    if (!data || size != PlayStation::BIOS_SIZE)
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    PlayStation::BIOS bios;
+    std::memcpy(bios.data(), data, bios.size());
+
+    ps->system.set_bios_data(bios);
+    ps->has_bios = true;
+
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_load_exe(psemu* ps,
+                                      const uint8_t* data,
+                                      size_t size)
+{
+    if (!data)
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    if (!ps->exe.load({ data, data + size }))
+    {
+        return PSEMU_ERROR_FORMAT;
+    }
+
+    // Without the shell, there is nothing to run.
+    ps->has_exe = boot(*ps);
+    return ps->has_exe ? PSEMU_OK : PSEMU_ERROR_FORMAT;
+}
+
+PSEMU_API psemu_result psemu_reset(psemu* ps)
+{
+    if (!ps->has_exe)
+    {
+        return PSEMU_ERROR_NO_EXE;
+    }
+
+    ps->has_exe = boot(*ps);
+    return ps->has_exe ? PSEMU_OK : PSEMU_ERROR_FORMAT;
+}
+
+PSEMU_API psemu_result psemu_run_frame(psemu* ps)
+{
+    if (!ps->has_exe)
+    {
+        return PSEMU_ERROR_NO_EXE;
+    }
+
+    if (!ps->system.hle.exited())
+    {
+        ps->system.run_frame();
+    }
+    return ps->system.hle.exited() ? PSEMU_EXITED : PSEMU_OK;
+}
+
+PSEMU_API uint32_t psemu_exit_code(const psemu* ps)
+{
+    return ps->system.hle.exit_code();
+}
+
+PSEMU_API psemu_result psemu_set_pad(psemu* ps,
+                                     uint32_t port,
+                                     uint16_t buttons)
+{
+    if (port >= ps->system.pads.size())
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    ps->system.pads[port] = buttons;
+    return PSEMU_OK;
+}
+
+PSEMU_API void psemu_set_tty_callback(psemu* ps,
+                                      psemu_tty_callback callback,
+                                      void* user)
+{
+    if (!callback)
+    {
+        ps->system.tty.discard();
+        return;
+    }
+
+    ps->system.tty.to_callback([callback, user](const char* data,
+                                                const std::size_t length)
+    {
+        callback(user, data, length);
+    });
+}
+
+PSEMU_API psemu_result psemu_get_framebuffer(const psemu* ps,
+                                             uint16_t* pixels,
+                                             size_t count)
+{
+    const auto& vram{ ps->system.bus.gpu.vram };
+
+    if (!pixels || count < vram.size())
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    std::copy(vram.begin(), vram.end(), pixels);
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_read_ram(const psemu* ps,
+                                      uint32_t address,
+                                      uint8_t* data,
+                                      size_t size)
+{
+    if (!data || !in_ram(address, size))
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    std::copy_n(&ps->system.bus.ram[address], size, data);
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_write_ram(psemu* ps,
+                                       uint32_t address,
+                                       const uint8_t* data,
+                                       size_t size)
+{
+    if (!data || !in_ram(address, size))
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    std::copy_n(data, size, &ps->system.bus.ram[address]);
+    ps->system.bus.mark_dirty(address, size);
+
+    return PSEMU_OK;
+}
+
+PSEMU_API size_t psemu_state_size(void)
+{
+    return PlayStation::Snapshot::serialized_size();
+}
+
+PSEMU_API psemu_result psemu_save_state(psemu* ps, uint8_t* data, size_t size)
+{
+    if (!data || size < PlayStation::Snapshot::serialized_size())
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    ps->state.serialize(ps->system, data);
+
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_load_state(psemu* ps,
+                                        const uint8_t* data,
+                                        size_t size)
+{
+    if (!data)
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    if (!ps->state.unserialize(data, size))
+    {
+        return PSEMU_ERROR_FORMAT;
+    }
+
+    ps->state.load(ps->system);
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_enable_mirror(psemu* ps)
+{
+    if (!ps->mirror)
+    {
+        ps->mirror.reset(new (std::nothrow) PlayStation::MemoryMirror);
+
+        if (!ps->mirror)
+        {
+            return PSEMU_ERROR_MEMORY;
+        }
+    }
+
+    ps->system.mirror = ps->mirror.get();
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_read_mirrored_ram(const psemu* ps,
+                                               uint32_t address,
+                                               uint8_t* data,
+                                               size_t size,
+                                               uint64_t* frame)
+{
+    if (!ps->mirror)
+    {
+        return PSEMU_ERROR_NO_MIRROR;
+    }
+
+    if (!data || !in_ram(address, size))
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    const auto published{ ps->mirror->read_ram(address, data, size) };
+
+    if (frame)
+    {
+        *frame = published;
+    }
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_read_mirrored_framebuffer(const psemu* ps,
+                                                       uint16_t* pixels,
+                                                       size_t count,
+                                                       uint64_t* frame)
+{
+    if (!ps->mirror)
+    {
+        return PSEMU_ERROR_NO_MIRROR;
+    }
+
+    if (!pixels || count < PlayStation::VRAM_WIDTH * PlayStation::VRAM_HEIGHT)
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    const auto published{ ps->mirror->read_vram(pixels) };
+
+    if (frame)
+    {
+        *frame = published;
+    }
+    return PSEMU_OK;
+}
+
+PSEMU_API psemu_result psemu_add_cheats(psemu* ps, const char* codes)
+{
+    if (!codes)
+    {
+        return PSEMU_ERROR_ARGUMENT;
+    }
+
+    if (!ps->cheats.add(codes))
+    {
+        return PSEMU_ERROR_FORMAT;
+    }
+
+    ps->system.cheats = &ps->cheats;
+    return PSEMU_OK;
+}
+
+PSEMU_API void psemu_clear_cheats(psemu* ps)
+{
+    ps->cheats.clear();
+    ps->system.cheats = nullptr;
+}
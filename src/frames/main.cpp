@@ -0,0 +1,160 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+#include "../libpsemu/include/frame_export.h"
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s [--frames N] [--timeout MS] NAME\n"
+                 "\n"
+                 "Reads the frames published through the shared memory frame "
+                 "ring NAME, e.g. by\n"
+                 "psemu_headless --export NAME, printing the number, latency "
+                 "and hash of every\n"
+                 "frame as it arrives.\n"
+                 "\n"
+                 "  --frames N    Stop after N frames (default: until the "
+                 "producer stops)\n"
+                 "  --timeout MS  Give up once no frame has been published for "
+                 "MS milliseconds\n"
+                 "                (default: 1000)\n",
+                 program);
+}
+
+/// @brief Hashes the pixels of a frame.
+/// @param ring The header of the frame ring.
+/// @param slot The slot holding the frame.
+/// @return The FNV-1a hash of the frame.
+static auto hash_frame(const PlayStation::FrameRing& ring,
+                       const PlayStation::FrameSlot& slot) noexcept
+-> std::uint64_t
+{
+    const auto pixels{ reinterpret_cast<const std::uint8_t*>(slot.pixels()) };
+    std::uint64_t hash{ 0xCBF29CE484222325 };
+
+    for (std::uint32_t y{ 0 }; y < ring.height; ++y)
+    {
+        const auto line{ pixels + (std::size_t{ y } * ring.stride) };
+
+        for (std::size_t x{ 0 }; x < ring.width * sizeof(std::uint16_t); ++x)
+        {
+            hash = (hash ^ line[x]) * 0x100000001B3;
+        }
+    }
+    return hash;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* name{ nullptr };
+    unsigned long frames{ 0 };
+    int timeout_ms{ 1000 };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frames = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--timeout") == 0 &&
+                 index + 1 < argc)
+        {
+            timeout_ms = std::atoi(argv[++index]);
+        }
+        else if (argv[index][0] != '-' && !name)
+        {
+            name = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!name || timeout_ms <= 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::FrameReader reader;
+
+    if (!reader.open(name))
+    {
+        std::fprintf(stderr, "There is no frame ring named %s\n", name);
+        return EXIT_FAILURE;
+    }
+
+    const auto& ring{ reader.header() };
+
+    auto seen{ ring.published.load(std::memory_order_acquire) };
+    unsigned long received{ 0 };
+    unsigned long missed{ 0 };
+
+    while (frames == 0 || received < frames)
+    {
+        const auto published{ reader.wait(seen, timeout_ms) };
+
+        if (published == seen)
+        {
+            break;
+        }
+
+        // Only the latest frame is read, the ones in between are missed.
+        missed += static_cast<std::uint32_t>(published - seen - 1);
+        seen = published;
+
+        const auto& slot{ reader.slot(published) };
+
+        // The slot is read in place, so the producer may be overwriting it
+        // with a later frame meanwhile.
+        const auto sequence{ slot.sequence.load(std::memory_order_acquire) };
+        const auto frame{ slot.frame };
+        const auto published_ns{ slot.monotonic_ns };
+        const auto hash{ hash_frame(ring, slot) };
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if ((sequence & 1) != 0 ||
+            slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            missed++;
+            continue;
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        const auto now_ns{ (std::int64_t{ now.tv_sec } * 1000000000) +
+                           now.tv_nsec };
+
+        std::printf("frame %" PRIu64 " latency %.3f ms hash %016" PRIx64 "\n",
+                    frame,
+                    static_cast<double>(now_ns - published_ns) / 1e6,
+                    hash);
+        received++;
+    }
+
+    std::fprintf(stderr, "%lu frames read, %lu missed\n", received, missed);
+    return received != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
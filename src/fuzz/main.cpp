@@ -0,0 +1,680 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../libpsemu/include/file.h"
+#include "../libpsemu/include/ps.h"
+#include "../libpsemu/include/snapshot.h"
+
+/// @brief Address of the general exception vector
+constexpr PlayStation::Word EXCEPTION_VECTOR{ 0x80000080 };
+
+/// @brief Register numbers of $a0, $a1 and $ra respectively
+constexpr auto A0{ 4 };
+constexpr auto A1{ 5 };
+constexpr auto RA{ 31 };
+
+/// @brief Names of the exception codes
+static constexpr const char* exception_names[32]
+{
+    "Int",  "Mod",  "TLBL", "TLBS", "AdEL", "AdES", "IBE",  "DBE",
+    "Sys",  "Bp",   "RI",   "CpU",  "Ov",   "Exc13", "Exc14", "Exc15",
+    "Exc16", "Exc17", "Exc18", "Exc19", "Exc20", "Exc21", "Exc22", "Exc23",
+    "Exc24", "Exc25", "Exc26", "Exc27", "Exc28", "Exc29", "Exc30", "Exc31"
+};
+
+/// @brief Interesting values to try, as AFL does.
+static constexpr std::int32_t interesting[]
+{
+    -128, -1, 0, 1, 16, 32, 64, 100, 127,
+    -32768, -129, 128, 255, 256, 512, 1000, 1024, 4096, 32767,
+    -2147483647 - 1, -100663046, -32769, 32768, 65535, 65536, 100663045,
+    2147483647
+};
+
+/// @brief Writes data to a file, replacing it.
+/// @param path The path of the file to write.
+/// @param data The data to write.
+/// @return `false` if the file couldn't be written.
+static auto write_file(const std::string& path,
+                       const std::vector<PlayStation::Byte>& data) noexcept
+-> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "wb") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    const auto written{ std::fwrite(data.data(), 1, data.size(), file) };
+    return std::fclose(file) == 0 && written == data.size();
+}
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s --start ADDR --input ADDR [--bios FILE] "
+                 "[--stop ADDR] [--args]\n"
+                 "       [--max-size N] [--limit N] [--start-frames N] [--runs N] "
+                 "[--seed N]\n"
+                 "       [--output DIR] [--corpus DIR] EXE [INPUT]...\n"
+                 "\n"
+                 "Fuzzes a PS-X EXE. The EXE is run until it reaches the "
+                 "start address, where\n"
+                 "the state of the system is captured. Each run then restores "
+                 "that state, writes\n"
+                 "a mutated input to guest RAM and executes until the stop "
+                 "address is reached,\n"
+                 "an exception other than a system call occurs or the "
+                 "instruction limit is hit.\n"
+                 "Inputs reaching new edges are kept for further mutation, "
+                 "starting from the\n"
+                 "INPUT files given (default: a single zero byte).\n"
+                 "\n"
+                 "  --start ADDR  Address at which to capture the system "
+                 "state\n"
+                 "  --input ADDR  Address of the buffer to write inputs to\n"
+                 "  --bios FILE   Boot the EXE through a BIOS image instead of "
+                 "starting it\n"
+                 "                directly\n"
+                 "  --stop ADDR   Address at which a run ends (default: the "
+                 "value of $ra at\n"
+                 "                the start address)\n"
+                 "  --args        Pass the address and size of the input in "
+                 "$a0 and $a1\n"
+                 "  --max-size N  Maximum size of an input (default: 4096)\n"
+                 "  --limit N     Instructions after which a run is "
+                 "considered hung\n"
+                 "                (default: 1000000)\n"
+                 "  --start-frames N\n"
+                 "                Frames after which the start address is "
+                 "considered never\n"
+                 "                reached (default: 3600)\n"
+                 "  --runs N      Stop after N runs (default: run until "
+                 "interrupted)\n"
+                 "  --seed N      Seed of the mutator (default: random)\n"
+                 "  --output DIR  Where to save inputs that crash or hang "
+                 "(default: .)\n"
+                 "  --corpus DIR  Also save every input reaching new edges "
+                 "to DIR\n",
+                 program);
+}
+
+/// @brief Converts a hit count to the bucket AFL would put it in, so that
+/// loops running a few more times don't count as new coverage.
+/// @param count The hit count.
+static auto bucket(const PlayStation::Byte count) noexcept
+-> PlayStation::Byte
+{
+    if (count < 4)
+    {
+        return count == 3 ? 4 : count;
+    }
+
+    if (count < 8)   return 8;
+    if (count < 16)  return 16;
+    if (count < 32)  return 32;
+    if (count < 128) return 64;
+
+    return 128;
+}
+
+/// @brief Applies a random number of random mutations to an input.
+/// @param data The input to mutate.
+/// @param corpus Inputs to splice chunks from.
+/// @param max_size The maximum size of the input.
+/// @param rng The random number generator to use.
+static auto mutate(std::vector<PlayStation::Byte>& data,
+                   const std::vector<std::vector<PlayStation::Byte>>& corpus,
+                   const std::size_t max_size,
+                   std::mt19937& rng) noexcept -> void
+{
+    const auto random = [&](const std::size_t limit) -> std::size_t
+    {
+        return std::uniform_int_distribution<std::size_t>{ 0, limit - 1 }(rng);
+    };
+
+    const auto mutations{ std::size_t{ 1 } << random(5) };
+
+    for (std::size_t n{ 0 }; n < mutations; ++n)
+    {
+        // Inputs that have become empty can only grow.
+        const auto kind{ data.empty() ? 6 : random(8) };
+
+        switch (kind)
+        {
+            // Flip a bit.
+            case 0:
+                data[random(data.size())] ^= 1 << random(8);
+                break;
+
+            // Set a byte to a random value.
+            case 1:
+                data[random(data.size())] = random(256);
+                break;
+
+            // Add to or subtract from a byte.
+            case 2:
+                data[random(data.size())] += random(71) - 35;
+                break;
+
+            // Overwrite one, two or four bytes with an interesting value, in
+            // either byte order.
+            case 3:
+            {
+                const auto size{ std::size_t{ 1 } << random(3) };
+
+                if (data.size() < size)
+                {
+                    break;
+                }
+
+                auto value{ static_cast<std::uint32_t>(
+                    interesting[random(std::size(interesting))]) };
+
+                const auto offset{ random(data.size() - size + 1) };
+                const bool big_endian{ random(2) == 1 };
+
+                for (std::size_t b{ 0 }; b < size; ++b)
+                {
+                    data[offset + (big_endian ? size - 1 - b : b)] = value;
+                    value >>= 8;
+                }
+                break;
+            }
+
+            // Copy a chunk of the input over another part of it.
+            case 4:
+            {
+                const auto length{ 1 + random(data.size()) };
+                const auto from{ random(data.size() - length + 1) };
+                const auto to{ random(data.size() - length + 1) };
+
+                std::copy_n(data.begin() + from, length, data.begin() + to);
+                break;
+            }
+
+            // Erase a chunk.
+            case 5:
+            {
+                const auto length{ 1 + random(std::min<std::size_t>(
+                    data.size(), 32)) };
+                const auto offset{ random(data.size() - length + 1) };
+
+                data.erase(data.begin() + offset,
+                           data.begin() + offset + length);
+                break;
+            }
+
+            // Insert random bytes, or a chunk of another input.
+            case 6:
+            case 7:
+            {
+                if (data.size() >= max_size)
+                {
+                    break;
+                }
+
+                const auto& other{ corpus[random(corpus.size())] };
+                const auto offset{ random(data.size() + 1) };
+
+                if (kind == 7 && !other.empty())
+                {
+                    const auto length{ std::min(1 + random(other.size()),
+                                                max_size - data.size()) };
+                    const auto from{ random(other.size() - length + 1) };
+
+                    data.insert(data.begin() + offset,
+                                other.begin() + from,
+                                other.begin() + from + length);
+                    break;
+                }
+
+                const auto length{ std::min<std::size_t>(1 + random(16),
+                                                         max_size -
+                                                         data.size()) };
+
+                data.insert(data.begin() + offset, length, 0);
+
+                for (std::size_t b{ 0 }; b < length; ++b)
+                {
+                    data[offset + b] = random(256);
+                }
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using PlayStation::Byte;
+    using PlayStation::Word;
+
+    const char* bios_path{ nullptr };
+    const char* exe_path{ nullptr };
+    const char* output_path{ "." };
+    const char* corpus_path{ nullptr };
+    std::vector<const char*> input_paths;
+
+    Word start{ 0 };
+    Word input_address{ 0 };
+    Word stop{ 0 };
+    bool have_start{ false };
+    bool have_input{ false };
+    bool have_stop{ false };
+    bool args{ false };
+    std::size_t max_size{ 4096 };
+    unsigned long long limit{ 1000000 };
+    unsigned long start_frames{ 3600 };
+    unsigned long long runs{ 0 };
+    unsigned long seed{ std::random_device{ }() };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--start") == 0 && index + 1 < argc)
+        {
+            start      = std::strtoul(argv[++index], nullptr, 0);
+            have_start = true;
+        }
+        else if (std::strcmp(argv[index], "--input") == 0 && index + 1 < argc)
+        {
+            input_address = std::strtoul(argv[++index], nullptr, 0);
+            have_input    = true;
+        }
+        else if (std::strcmp(argv[index], "--stop") == 0 && index + 1 < argc)
+        {
+            stop      = std::strtoul(argv[++index], nullptr, 0);
+            have_stop = true;
+        }
+        else if (std::strcmp(argv[index], "--bios") == 0 && index + 1 < argc)
+        {
+            bios_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--args") == 0)
+        {
+            args = true;
+        }
+        else if (std::strcmp(argv[index], "--max-size") == 0 &&
+                 index + 1 < argc)
+        {
+            max_size = std::strtoul(argv[++index], nullptr, 0);
+        }
+        else if (std::strcmp(argv[index], "--limit") == 0 && index + 1 < argc)
+        {
+            limit = std::strtoull(argv[++index], nullptr, 0);
+        }
+        else if (std::strcmp(argv[index], "--start-frames") == 0 &&
+                 index + 1 < argc)
+        {
+            start_frames = std::strtoul(argv[++index], nullptr, 0);
+        }
+        else if (std::strcmp(argv[index], "--runs") == 0 && index + 1 < argc)
+        {
+            runs = std::strtoull(argv[++index], nullptr, 0);
+        }
+        else if (std::strcmp(argv[index], "--seed") == 0 && index + 1 < argc)
+        {
+            seed = std::strtoul(argv[++index], nullptr, 0);
+        }
+        else if (std::strcmp(argv[index], "--output") == 0 && index + 1 < argc)
+        {
+            output_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--corpus") == 0 && index + 1 < argc)
+        {
+            corpus_path = argv[++index];
+        }
+        else if (argv[index][0] != '-')
+        {
+            if (!exe_path)
+            {
+                exe_path = argv[index];
+            }
+            else
+            {
+                input_paths.push_back(argv[index]);
+            }
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!exe_path || !have_start || !have_input || max_size == 0 ||
+        limit == 0 || start_frames == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const Word input_paddr{ input_address & 0x1FFFFFFF };
+
+    if (input_paddr >= PlayStation::RAM_SIZE ||
+        max_size > PlayStation::RAM_SIZE - input_paddr)
+    {
+        std::fprintf(stderr, "The input buffer must be within main RAM\n");
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::EXE exe;
+
+    if (!exe.load_file(exe_path))
+    {
+        std::fprintf(stderr, "%s is not a readable PS-X EXE\n", exe_path);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Byte> data;
+    std::vector<std::vector<Byte>> corpus;
+
+    for (const auto path : input_paths)
+    {
+        if (!PlayStation::read_file(path, data))
+        {
+            std::fprintf(stderr, "Unable to read %s\n", path);
+            return EXIT_FAILURE;
+        }
+
+        data.resize(std::min(data.size(), max_size));
+        corpus.push_back(data);
+    }
+
+    if (corpus.empty())
+    {
+        corpus.push_back({ 0x00 });
+    }
+
+    // The system is rather large, keep it off of the stack.
+    auto system{ std::make_unique<PlayStation::System>() };
+    system->tty.discard();
+
+    if (bios_path)
+    {
+        PlayStation::BIOS bios;
+
+        if (!PlayStation::read_bios(bios_path, bios))
+        {
+            std::fprintf(stderr, "Unable to read BIOS %s\n", bios_path);
+            return EXIT_FAILURE;
+        }
+
+        system->set_bios_data(bios);
+
+        if (!system->boot_exe(exe))
+        {
+            std::fprintf(stderr,
+                         "%s didn't reach the shell within %u frames\n",
+                         bios_path,
+                         PlayStation::System::BOOT_FRAME_LIMIT);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        system->fast_boot(exe);
+    }
+
+    // Run up to the start address, and take the snapshot there.
+    const auto breakpoint = [](const Word)
+    {
+        return PlayStation::HookAction::Break;
+    };
+
+    const auto start_hook{ system->bus.hooks.add_breakpoint(start,
+                                                            breakpoint) };
+
+    unsigned long frames{ 0 };
+    bool reached{ false };
+
+    while (!system->hle.exited() && frames < start_frames)
+    {
+        if (system->run_frame())
+        {
+            frames++;
+        }
+        else if ((system->cpu.pc & 0x1FFFFFFF) == (start & 0x1FFFFFFF))
+        {
+            reached = true;
+            break;
+        }
+    }
+
+    system->bus.hooks.remove(start_hook);
+
+    if (system->hle.exited())
+    {
+        std::fprintf(stderr, "%s exited before reaching 0x%08X\n",
+                     exe_path,
+                     start);
+        return EXIT_FAILURE;
+    }
+
+    if (!reached)
+    {
+        std::fprintf(stderr, "%s didn't reach 0x%08X within %lu frames\n",
+                     exe_path,
+                     start,
+                     start_frames);
+        return EXIT_FAILURE;
+    }
+
+    if (!have_stop)
+    {
+        stop = system->cpu.gpr[RA];
+    }
+
+    PlayStation::Snapshot snapshot;
+    snapshot.capture(*system);
+
+    PlayStation::Coverage coverage{ PlayStation::Coverage::Mode::Edges };
+    system->coverage = &coverage;
+
+    bool crashed{ false };
+
+    system->bus.hooks.add_breakpoint(stop, breakpoint);
+    system->bus.hooks.add_breakpoint(EXCEPTION_VECTOR,
+    [&](const Word)
+    {
+        using PlayStation::CPU;
+
+        // System calls are how the guest talks to the kernel; interrupts
+        // aren't its fault either.
+        const auto code{ (system->cpu.cop0.Cause.word >> 2) & 0x1F };
+
+        if (code == 0 || code == CPU::Exception::Sys)
+        {
+            return PlayStation::HookAction::Continue;
+        }
+
+        crashed = true;
+        return PlayStation::HookAction::Break;
+    });
+
+    std::mt19937 rng{ static_cast<std::mt19937::result_type>(seed) };
+    std::vector<Byte> virgin(PlayStation::Coverage::EDGE_MAP_SIZE, 0);
+    std::set<std::pair<Word, Word>> crash_sites;
+    std::set<Word> hang_sites;
+
+    unsigned long long run{ 0 };
+    unsigned long long crashes{ 0 };
+    unsigned long long hangs{ 0 };
+    unsigned long long pages{ 0 };
+    std::size_t edges{ 0 };
+    std::size_t next_seed{ 0 };
+    std::vector<Byte> input;
+
+    using Clock = std::chrono::steady_clock;
+
+    const auto began{ Clock::now() };
+    auto last_report{ began };
+
+    const auto report = [&]()
+    {
+        const std::chrono::duration<double> elapsed{ Clock::now() - began };
+
+        std::fprintf(stderr,
+                     "%llu runs (%.0f/s), %zu inputs, %zu edges, %llu crashes, "
+                     "%llu hangs, %.1f pages restored per run\n",
+                     run,
+                     run / elapsed.count(),
+                     corpus.size(),
+                     edges,
+                     crashes,
+                     hangs,
+                     run ? static_cast<double>(pages) / run : 0.0);
+    };
+
+    for (; runs == 0 || run < runs; ++run)
+    {
+        // Run the initial inputs as they are first.
+        if (next_seed < input_paths.size() ||
+            (next_seed == 0 && input_paths.empty()))
+        {
+            input = corpus[next_seed++];
+        }
+        else
+        {
+            input = corpus[std::uniform_int_distribution<std::size_t>{
+                0, corpus.size() - 1 }(rng)];
+
+            mutate(input, corpus, max_size, rng);
+        }
+
+        pages += snapshot.restore(*system);
+        coverage.reset();
+
+        std::copy(input.begin(), input.end(), &system->bus.ram[input_paddr]);
+        system->bus.mark_dirty(input_paddr, input.size());
+
+        if (args)
+        {
+            system->cpu.gpr[A0] = input_address;
+            system->cpu.gpr[A1] = input.size();
+        }
+
+        crashed = false;
+        unsigned long long executed{ 0 };
+
+        while (executed < limit && system->step())
+        {
+            executed++;
+        }
+
+        const auto& map{ coverage.map() };
+        bool new_edges{ false };
+
+        // Few entries of the map are hit by any one run, so it is scanned a
+        // word at a time to skip over the rest quickly.
+        for (std::size_t chunk{ 0 }; chunk < map.size(); chunk += 8)
+        {
+            std::uint64_t hits;
+            std::memcpy(&hits, &map[chunk], sizeof(hits));
+
+            if (hits == 0)
+            {
+                continue;
+            }
+
+            for (auto i{ chunk }; i < chunk + 8; ++i)
+            {
+                const auto hit{ bucket(map[i]) };
+
+                if (hit & ~virgin[i])
+                {
+                    edges     += virgin[i] == 0;
+                    virgin[i] |= hit;
+
+                    new_edges = true;
+                }
+            }
+        }
+
+        const auto& cpu{ system->cpu };
+
+        if (crashed)
+        {
+            const Word code{ (cpu.cop0.Cause.word >> 2) & 0x1F };
+            crashes++;
+
+            if (crash_sites.insert({ code, cpu.cop0.EPC }).second)
+            {
+                char name[64];
+                std::snprintf(name,
+                              sizeof(name),
+                              "/crash-%s-%08X",
+                              exception_names[code],
+                              cpu.cop0.EPC);
+
+                std::fprintf(stderr,
+                             "Crash: %s at 0x%08X (BadA=0x%08X)\n",
+                             exception_names[code],
+                             cpu.cop0.EPC,
+                             cpu.cop0.BadA);
+
+                write_file(output_path + std::string{ name }, input);
+            }
+        }
+        else if (executed == limit)
+        {
+            hangs++;
+
+            if (hang_sites.insert(cpu.pc).second)
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "/hang-%08X", cpu.pc);
+
+                std::fprintf(stderr, "Hang: still running at 0x%08X\n", cpu.pc);
+                write_file(output_path + std::string{ name }, input);
+            }
+        }
+        else if (new_edges && run >= input_paths.size())
+        {
+            if (corpus_path)
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "/id-%06zu", corpus.size());
+
+                write_file(corpus_path + std::string{ name }, input);
+            }
+            corpus.push_back(input);
+        }
+
+        if (Clock::now() - last_report >= std::chrono::seconds{ 1 })
+        {
+            last_report = Clock::now();
+            report();
+        }
+    }
+
+    report();
+    return crashes == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,557 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../libpsemu/include/analyzer.h"
+#include "../libpsemu/include/file.h"
+#include "../libpsemu/include/movie.h"
+#include "../libpsemu/include/ps.h"
+#include "../libpsemu/include/trace.h"
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s [--bios FILE] [--frames N] [--profile FILE] "
+                 "[--coverage FILE]\n"
+                 "       [--symbols FILE] [--stats FILE] [--perf] "
+                 "[--benchmark N] [--trace FILE]\n"
+                 "       [--export NAME [--export-slots N]] [--record FILE]\n"
+                 "       [--record-movie FILE | --play-movie FILE] "
+                 "[--cheats FILE] EXE\n"
+                 "\n"
+                 "Runs a PS-X EXE without a user interface, writing its TTY "
+                 "output to stdout.\n"
+                 "\n"
+                 "  --bios FILE  Boot the EXE through a BIOS image instead of "
+                 "starting it\n"
+                 "               directly\n"
+                 "  --frames N   Stop after N frames (default: run until the "
+                 "EXE exits)\n"
+                 "  --profile FILE\n"
+                 "               Profile the EXE, writing a call graph in "
+                 "callgrind format\n"
+                 "  --coverage FILE\n"
+                 "               Write the basic blocks of the EXE executed, "
+                 "and those never\n"
+                 "               executed, in lcov format\n"
+                 "  --symbols FILE\n"
+                 "               Read function names for the profile and "
+                 "coverage from FILE\n"
+                 "               (nm format)\n"
+                 "  --stats FILE Write instruction and memory access counts "
+                 "as JSON (requires\n"
+                 "               a build with PSEMU_ENABLE_STATS)\n"
+                 "  --perf       Print performance counters to stderr as they "
+                 "are updated\n"
+                 "  --benchmark N\n"
+                 "               Run N frames with TTY output discarded, then "
+                 "print the wall\n"
+                 "               time, FPS, MIPS and peak RSS\n"
+                 "  --trace FILE Write a binary trace of every instruction "
+                 "executed by the EXE\n"
+                 "  --export NAME\n"
+                 "               Publish every frame to other processes "
+                 "through a shared memory\n"
+                 "               ring named NAME, e.g. /psemu (see "
+                 "frame_export.h)\n"
+                 "  --export-slots N\n"
+                 "               Number of frames in the ring (default: 4)\n"
+                 "  --record FILE\n"
+                 "               Record every frame to FILE: YUV4MPEG2 if it "
+                 "ends in .y4m,\n"
+                 "               FFV1 through ffmpeg otherwise. Frames are "
+                 "dropped rather than\n"
+                 "               slowing down emulation if the disk can't "
+                 "keep up.\n"
+                 "  --record-movie FILE\n"
+                 "               Record the input of every frame, and a hash of "
+                 "the state it\n"
+                 "               ends in, to FILE\n"
+                 "  --play-movie FILE\n"
+                 "               Play back a movie recorded with the same BIOS "
+                 "and EXE, stopping\n"
+                 "               at the first frame that doesn't end in the "
+                 "recorded state\n"
+                 "  --cheats FILE\n"
+                 "               Apply the GameShark codes in FILE, one per "
+                 "line, at the end of\n"
+                 "               every frame\n",
+                 program);
+}
+
+/// @brief Prints performance counters.
+/// @param counters The counters to print.
+static auto print_perf(const PlayStation::Perf::Counters& counters) noexcept
+-> void
+{
+    using PlayStation::Perf;
+
+    std::fprintf(stderr,
+                 "%.2f MIPS, %.1f FPS (%.0f%%), per frame: CPU %.2f ms, "
+                 "GPU %.2f ms, frontend %.2f ms\n",
+                 counters.instructions_per_second / 1000000.0,
+                 counters.frames_per_second,
+                 counters.speed,
+                 counters.frame_time[Perf::CPU],
+                 counters.frame_time[Perf::GPU],
+                 counters.frame_time[Perf::Frontend]);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* bios_path{ nullptr };
+    const char* exe_path{ nullptr };
+    const char* profile_path{ nullptr };
+    const char* coverage_path{ nullptr };
+    const char* symbols_path{ nullptr };
+    const char* stats_path{ nullptr };
+    const char* trace_path{ nullptr };
+    const char* export_name{ nullptr };
+    const char* record_path{ nullptr };
+    const char* record_movie_path{ nullptr };
+    const char* play_movie_path{ nullptr };
+    const char* cheats_path{ nullptr };
+    std::uint32_t export_slots{ PlayStation::FrameExport::DEFAULT_SLOTS };
+    bool perf{ false };
+    bool benchmark{ false };
+    unsigned long frames{ 0 };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--bios") == 0 && index + 1 < argc)
+        {
+            bios_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frames = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--profile") == 0 &&
+                 index + 1 < argc)
+        {
+            profile_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--coverage") == 0 &&
+                 index + 1 < argc)
+        {
+            coverage_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--symbols") == 0 &&
+                 index + 1 < argc)
+        {
+            symbols_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--stats") == 0 && index + 1 < argc)
+        {
+            stats_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--benchmark") == 0 &&
+                 index + 1 < argc)
+        {
+            frames    = std::strtoul(argv[++index], nullptr, 10);
+            benchmark = frames != 0;
+        }
+        else if (std::strcmp(argv[index], "--trace") == 0 && index + 1 < argc)
+        {
+            trace_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--export") == 0 && index + 1 < argc)
+        {
+            export_name = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--export-slots") == 0 &&
+                 index + 1 < argc)
+        {
+            export_slots = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--record") == 0 && index + 1 < argc)
+        {
+            record_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--record-movie") == 0 &&
+                 index + 1 < argc)
+        {
+            record_movie_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--play-movie") == 0 &&
+                 index + 1 < argc)
+        {
+            play_movie_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--cheats") == 0 && index + 1 < argc)
+        {
+            cheats_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--perf") == 0)
+        {
+            perf = true;
+        }
+        else if (argv[index][0] != '-' && !exe_path)
+        {
+            exe_path = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!exe_path || (record_movie_path && play_movie_path))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (stats_path && !PlayStation::STATS_ENABLED)
+    {
+        std::fprintf(stderr, "--stats requires a build with "
+                             "PSEMU_ENABLE_STATS\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<PlayStation::Byte> data;
+    PlayStation::EXE exe;
+
+    if (!PlayStation::read_file(exe_path, data))
+    {
+        std::fprintf(stderr, "Unable to read %s\n", exe_path);
+        return EXIT_FAILURE;
+    }
+
+    if (!exe.load(data))
+    {
+        std::fprintf(stderr, "%s is not a PS-X EXE\n", exe_path);
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::Movie movie;
+    movie.exe_hash = PlayStation::Movie::hash(data.data(), data.size());
+
+    // The system is rather large, keep it off of the stack.
+    auto system{ std::make_unique<PlayStation::System>() };
+
+    if (bios_path)
+    {
+        PlayStation::BIOS bios;
+
+        if (!PlayStation::read_bios(bios_path, bios))
+        {
+            std::fprintf(stderr, "Unable to read BIOS %s\n", bios_path);
+            return EXIT_FAILURE;
+        }
+
+        system->set_bios_data(bios);
+        movie.bios_hash = PlayStation::Movie::hash(bios.data(), bios.size());
+    }
+
+    // Cheats are read before a movie is, which must have been recorded with
+    // the same ones.
+    PlayStation::Cheats cheats;
+
+    if (cheats_path && !cheats.load(cheats_path))
+    {
+        std::fprintf(stderr, "Unable to read cheats %s\n", cheats_path);
+        return EXIT_FAILURE;
+    }
+
+    if (play_movie_path)
+    {
+        const auto exe_hash{ movie.exe_hash };
+        const auto bios_hash{ movie.bios_hash };
+
+        if (!movie.load(play_movie_path))
+        {
+            std::fprintf(stderr, "Unable to read movie %s\n", play_movie_path);
+            return EXIT_FAILURE;
+        }
+
+        if (movie.exe_hash != exe_hash)
+        {
+            std::fprintf(stderr, "%s was not recorded with %s\n",
+                         play_movie_path, exe_path);
+            return EXIT_FAILURE;
+        }
+
+        if (movie.bios_hash != bios_hash ||
+            ((movie.options & PlayStation::Movie::FastBoot) != 0) != !bios_path)
+        {
+            std::fprintf(stderr, "%s was recorded %s\n",
+                         play_movie_path,
+                         movie.bios_hash ? "with a different BIOS" :
+                                           "without a BIOS");
+            return EXIT_FAILURE;
+        }
+
+        if (movie.cheats_hash != cheats.hash())
+        {
+            std::fprintf(stderr, "%s was recorded %s\n",
+                         play_movie_path,
+                         movie.cheats_hash ? "with different cheats" :
+                                             "without cheats");
+            return EXIT_FAILURE;
+        }
+        movie.apply_options(*system);
+    }
+
+    // Boots the system as it was at startup, which a movie may ask for again.
+    const auto boot = [&]()
+    {
+        if (!bios_path)
+        {
+            system->fast_boot(exe);
+            return true;
+        }
+
+        if (!system->boot_exe(exe))
+        {
+            std::fprintf(stderr,
+                         "%s didn't reach the shell within %u frames\n",
+                         bios_path,
+                         PlayStation::System::BOOT_FRAME_LIMIT);
+            return false;
+        }
+        return true;
+    };
+
+    if (!boot())
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (cheats_path)
+    {
+        system->cheats = &cheats;
+    }
+
+    if (record_movie_path)
+    {
+        movie.record_options(*system, !bios_path);
+    }
+
+    std::unique_ptr<PlayStation::Profiler> profiler;
+
+    if (profile_path)
+    {
+        profiler = std::make_unique<PlayStation::Profiler>(system->cpu,
+                                                           system->bus);
+
+        if (symbols_path && !profiler->load_symbols(symbols_path))
+        {
+            std::fprintf(stderr, "Unable to read symbols %s\n", symbols_path);
+            return EXIT_FAILURE;
+        }
+        system->profiler = profiler.get();
+    }
+
+    std::unique_ptr<PlayStation::Coverage> coverage;
+
+    if (coverage_path)
+    {
+        coverage = std::make_unique<PlayStation::Coverage>();
+
+        if (symbols_path && !coverage->load_symbols(symbols_path))
+        {
+            std::fprintf(stderr, "Unable to read symbols %s\n", symbols_path);
+            return EXIT_FAILURE;
+        }
+
+        // Find the blocks of the EXE up front, so that the ones never
+        // executed are reported too.
+        PlayStation::Analyzer analyzer{ exe.text, exe.dest };
+
+        analyzer.add_entry(exe.pc);
+        analyzer.run();
+
+        for (const auto& [address, block] : analyzer.blocks)
+        {
+            coverage->add_block(address);
+        }
+        system->coverage = coverage.get();
+    }
+
+    PlayStation::TraceWriter trace;
+
+    if (trace_path)
+    {
+        if (!trace.open(trace_path))
+        {
+            std::fprintf(stderr, "Unable to write trace %s\n", trace_path);
+            return EXIT_FAILURE;
+        }
+        system->on_instruction = [&](const PlayStation::Word pc)
+        {
+            trace.write(pc, system->cpu);
+        };
+    }
+
+    PlayStation::FrameExport frame_export;
+
+    if (export_name)
+    {
+        if (!frame_export.open(export_name, export_slots))
+        {
+            std::fprintf(stderr, "Unable to create frame ring %s\n",
+                         export_name);
+            return EXIT_FAILURE;
+        }
+        system->frame_export = &frame_export;
+    }
+
+    PlayStation::Recorder recorder;
+
+    if (record_path)
+    {
+        if (!recorder.open(record_path))
+        {
+            std::fprintf(stderr, "Unable to record to %s\n", record_path);
+            return EXIT_FAILURE;
+        }
+        system->recorder = &recorder;
+    }
+
+    if (benchmark)
+    {
+        system->tty.discard();
+    }
+
+    if (perf)
+    {
+        system->bus.perf = &system->perf;
+    }
+
+    if (play_movie_path &&
+        (frames == 0 || frames > movie.frames.size()))
+    {
+        frames = movie.frames.size();
+    }
+
+    std::uint64_t perf_updates{ 0 };
+    unsigned long frame{ 0 };
+    bool desync{ false };
+
+    const auto start{ PlayStation::Perf::Clock::now() };
+
+    for (; (frames == 0 && !play_movie_path) || frame < frames; ++frame)
+    {
+        if (play_movie_path)
+        {
+            const auto& input{ movie.frames[frame] };
+
+            if ((input.flags & PlayStation::MovieFrame::Reset) && !boot())
+            {
+                system->tty.flush();
+                return EXIT_FAILURE;
+            }
+            system->pads = input.pads;
+        }
+
+        const bool running{ system->run_frame() || !system->hle.exited() };
+
+        // The frame the EXE exits in is recorded too, so that playback
+        // exits in the same one.
+        if (record_movie_path)
+        {
+            movie.record_frame(*system);
+        }
+        else if (play_movie_path && !movie.check_frame(*system, frame))
+        {
+            desync = true;
+            break;
+        }
+
+        if (!running)
+        {
+            desync = play_movie_path && frame + 1 != frames;
+            break;
+        }
+
+        const auto& counters{ system->perf.counters() };
+
+        if (perf && counters.updates != perf_updates)
+        {
+            perf_updates = counters.updates;
+            print_perf(counters);
+        }
+    }
+
+    system->tty.flush();
+
+    if (desync)
+    {
+        std::fprintf(stderr, "Desync at frame %lu of %s\n",
+                     frame, play_movie_path);
+        return EXIT_FAILURE;
+    }
+
+    if (record_movie_path && !movie.save(record_movie_path))
+    {
+        std::fprintf(stderr, "Unable to write movie %s\n", record_movie_path);
+        return EXIT_FAILURE;
+    }
+
+    if (benchmark)
+    {
+        using PlayStation::System;
+
+        PlayStation::Perf::print_benchmark(stdout,
+                                           frame,
+                                           frame * System::CYCLES_PER_FRAME,
+                                           PlayStation::Perf::Clock::now() -
+                                           start);
+    }
+
+    if (stats_path && !PlayStation::Stats::this_thread.write_json(stats_path))
+    {
+        std::fprintf(stderr, "Unable to write statistics %s\n", stats_path);
+        return EXIT_FAILURE;
+    }
+
+    if (profiler && !profiler->write_callgrind(profile_path))
+    {
+        std::fprintf(stderr, "Unable to write profile %s\n", profile_path);
+        return EXIT_FAILURE;
+    }
+
+    if (coverage && !coverage->write_lcov(coverage_path, exe_path))
+    {
+        std::fprintf(stderr, "Unable to write coverage %s\n", coverage_path);
+        return EXIT_FAILURE;
+    }
+
+    if (record_path)
+    {
+        if (!recorder.close())
+        {
+            std::fprintf(stderr, "Unable to write %s\n", record_path);
+            return EXIT_FAILURE;
+        }
+
+        std::fprintf(stderr,
+                     "%llu frames recorded, %llu dropped\n",
+                     static_cast<unsigned long long>(recorder.recorded()),
+                     static_cast<unsigned long long>(recorder.dropped()));
+    }
+
+    // Mirror the exit code of the EXE, if it exited.
+    return system->hle.exited() ? static_cast<int>(system->hle.exit_code()) :
+                                  EXIT_SUCCESS;
+}
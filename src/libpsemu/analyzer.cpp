@@ -0,0 +1,560 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include "analyzer.h"
+
+using namespace PlayStation;
+
+/// @brief Determines if an instruction is a jump or branch, i.e. has a delay
+/// slot and may not continue sequentially.
+/// @param instr The instruction to check.
+static auto is_jump(const DecodedInstruction& instr) noexcept -> bool
+{
+    switch (instr.operands)
+    {
+        case Operands::Jump:
+        case Operands::Branch:
+        case Operands::BranchCompare:
+        case Operands::JumpRegister:
+        case Operands::JumpAndLinkRegister:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/// @brief Determines if a branch is always taken, e.g. `beq $zero, $zero`,
+/// which is how assemblers write `b`.
+/// @param instr The branch to check.
+static auto is_unconditional(const DecodedInstruction& instr) noexcept -> bool
+{
+    return (instr.mnemonic == Mnemonic::BEQ  && instr.rs == instr.rt) ||
+           (instr.mnemonic == Mnemonic::BGEZ && instr.rs == 0);
+}
+
+/// @brief Determines if an instruction is a call to a fixed address.
+/// @param instr The instruction to check.
+static auto is_call(const DecodedInstruction& instr) noexcept -> bool
+{
+    return instr.mnemonic == Mnemonic::JAL    ||
+           instr.mnemonic == Mnemonic::BLTZAL ||
+           instr.mnemonic == Mnemonic::BGEZAL;
+}
+
+/// @brief Initializes the analyzer.
+/// @param data The memory image to analyze.
+/// @param address The address the image begins at.
+Analyzer::Analyzer(const std::vector<Byte>& data, const Word address) noexcept :
+image(data), base(address), flags(data.size() / sizeof(Word))
+{ }
+
+/// @brief Adds a function entry point.
+/// @param address The address of the function.
+/// @return `false` if the address is outside of the image.
+auto Analyzer::add_entry(const Word address) noexcept -> bool
+{
+    if (!contains(address))
+    {
+        return false;
+    }
+
+    entries.insert(address);
+    add_leader(address);
+
+    return true;
+}
+
+/// @brief Adds the target of every `jal` instruction found in the image as an
+/// entry point, for when the real entry points aren't known, e.g. with a RAM
+/// dump.
+auto Analyzer::scan_calls() noexcept -> void
+{
+    for (std::size_t index{ 0 }; index < flags.size(); ++index)
+    {
+        const auto instr{ decode(base + (index * sizeof(Word))) };
+
+        if (instr.mnemonic == Mnemonic::JAL)
+        {
+            add_entry(instr.address);
+        }
+    }
+}
+
+/// @brief Analyzes the image, filling in `blocks`, `functions`, `calls` and
+/// `jump_tables`.
+auto Analyzer::run() noexcept -> void
+{
+    explore();
+    build_blocks();
+    build_functions();
+
+    std::sort(calls.begin(), calls.end(), [](const Call& a, const Call& b)
+    {
+        return a.site < b.site;
+    });
+
+    std::sort(jump_tables.begin(),
+              jump_tables.end(),
+              [](const JumpTable& a, const JumpTable& b)
+    {
+        return a.jump < b.jump;
+    });
+
+    tables_by_jump.clear();
+
+    for (std::size_t index{ 0 }; index < jump_tables.size(); ++index)
+    {
+        tables_by_jump[jump_tables[index].jump] = index;
+    }
+}
+
+/// @brief Writes the results as text, one item per line:
+///
+///     function START END BLOCKS
+///     block START END [SUCCESSOR...]
+///     call SITE TARGET
+///     jumptable JUMP ADDRESS TARGET...
+///
+/// with every number in hexadecimal. Ranges exclude their end.
+/// @param file The stream to write to.
+auto Analyzer::write_index(FILE* file) const noexcept -> void
+{
+    std::fprintf(file,
+                 "# %zu functions, %zu blocks, %zu calls, %zu jump tables\n",
+                 functions.size(),
+                 blocks.size(),
+                 calls.size(),
+                 jump_tables.size());
+
+    for (const auto& [address, function] : functions)
+    {
+        std::fprintf(file,
+                     "function %08X %08X %zX\n",
+                     function.start,
+                     function.end,
+                     function.blocks.size());
+    }
+
+    for (const auto& [address, block] : blocks)
+    {
+        std::fprintf(file, "block %08X %08X", block.start, block.end);
+
+        for (const auto successor : block.successors)
+        {
+            std::fprintf(file, " %08X", successor);
+        }
+        std::fputc('\n', file);
+    }
+
+    for (const auto& call : calls)
+    {
+        std::fprintf(file, "call %08X %08X\n", call.site, call.target);
+    }
+
+    for (const auto& table : jump_tables)
+    {
+        std::fprintf(file, "jumptable %08X %08X", table.jump, table.address);
+
+        for (const auto target : table.targets)
+        {
+            std::fprintf(file, " %08X", target);
+        }
+        std::fputc('\n', file);
+    }
+}
+
+/// @brief Writes a name for every function, in the format printed by `nm`, as
+/// read by `Profiler::load_symbols()`.
+/// @param file The stream to write to.
+auto Analyzer::write_symbols(FILE* file) const noexcept -> void
+{
+    for (const auto& [address, function] : functions)
+    {
+        std::fprintf(file, "%08X T sub_%08X\n", address, address);
+    }
+}
+
+/// @brief Determines if an address is that of a word within the image.
+auto Analyzer::contains(const Word address) const noexcept -> bool
+{
+    return (address & 3) == 0 &&
+           address >= base &&
+           (address - base) / sizeof(Word) < flags.size();
+}
+
+/// @brief Returns the word at an address in the image.
+auto Analyzer::word_at(const Word address) const noexcept -> Word
+{
+    Word word;
+    std::memcpy(&word, &image[address - base], sizeof(word));
+
+    return word;
+}
+
+/// @brief Returns the flags of the word at an address in the image.
+auto Analyzer::flags_at(const Word address) noexcept -> Byte&
+{
+    return flags[(address - base) / sizeof(Word)];
+}
+
+/// @brief Decodes the instruction at an address in the image.
+auto Analyzer::decode(const Word address) const noexcept -> DecodedInstruction
+{
+    return decode_instruction(address, word_at(address));
+}
+
+/// @brief Marks an address as the start of a block, queueing it to be
+/// explored if it hasn't been yet.
+auto Analyzer::add_leader(const Word address) noexcept -> void
+{
+    if (!contains(address))
+    {
+        return;
+    }
+
+    auto& f{ flags_at(address) };
+
+    if (!(f & Flag::Code))
+    {
+        pending.push_back(address);
+    }
+    f |= Flag::Leader;
+}
+
+/// @brief Follows the flow of the program from every queued address.
+auto Analyzer::explore() noexcept -> void
+{
+    while (!pending.empty())
+    {
+        Word pc{ pending.back() };
+        pending.pop_back();
+
+        for (; contains(pc) && !(flags_at(pc) & Flag::Code); pc += 4)
+        {
+            const auto instr{ decode(pc) };
+
+            // Execution can't continue past this, so neither can we.
+            if (instr.mnemonic == Mnemonic::ILLEGAL)
+            {
+                break;
+            }
+
+            flags_at(pc) |= Flag::Code;
+
+            if (!is_jump(instr))
+            {
+                continue;
+            }
+
+            // The delay slot is executed whether or not the jump is taken.
+            if (contains(pc + 4))
+            {
+                flags_at(pc + 4) |= Flag::Code | Flag::End;
+            }
+
+            if (is_call(instr))
+            {
+                calls.push_back({ pc, instr.address });
+                add_entry(instr.address);
+                add_leader(pc + 8);
+            }
+            else if (instr.mnemonic == Mnemonic::JALR)
+            {
+                add_leader(pc + 8);
+            }
+            else if (instr.mnemonic == Mnemonic::JR)
+            {
+                if (instr.rs != 31)
+                {
+                    find_jump_table(instr);
+                }
+            }
+            else
+            {
+                add_leader(instr.address);
+
+                if (instr.operands != Operands::Jump &&
+                    !is_unconditional(instr))
+                {
+                    add_leader(pc + 8);
+                }
+            }
+            break;
+        }
+    }
+}
+
+/// @brief Searches backwards from an indirect jump for the jump table it reads
+/// its target from.
+/// @param jump The decoded `jr` instruction.
+/// @return `false` if no jump table was found.
+auto Analyzer::find_jump_table(const DecodedInstruction& jump) noexcept -> bool
+{
+    // Compilers emit some variation of:
+    //
+    //     sltiu $v0, $a0, COUNT       ; bounds check
+    //     beqz  $v0, default
+    //     sll   $v0, $a0, 2
+    //     lui   $at, %hi(table)
+    //     addu  $at, $at, $v0
+    //     lw    $v0, %lo(table)($at)
+    //     jr    $v0
+    //
+    // so find the load of the target first, then follow the register holding
+    // its base back to the `lui`, adding up the offsets on the way.
+    bool loaded{ false };
+    bool found{ false };
+    std::array<Byte, 2> bases{ };
+    Word address{ 0 };
+    Word count{ 0 };
+
+    const auto is_base = [&](const Byte reg)
+    {
+        return reg == bases[0] || reg == bases[1];
+    };
+
+    for (auto distance{ 1 }; distance <= JUMP_TABLE_WINDOW; ++distance)
+    {
+        const Word pc{ jump.pc - (distance * 4) };
+
+        if (!contains(pc))
+        {
+            break;
+        }
+
+        const auto instr{ decode(pc) };
+
+        // Nothing before an unconditional jump flows into this one.
+        if (instr.operands == Operands::Jump ||
+            instr.operands == Operands::JumpRegister)
+        {
+            break;
+        }
+
+        if (instr.mnemonic == Mnemonic::SLTIU && count == 0)
+        {
+            count = instr.immediate;
+        }
+
+        if (found)
+        {
+            continue;
+        }
+
+        if (!loaded)
+        {
+            if (instr.destination == Destination::GPR &&
+                instr.written     == jump.rs)
+            {
+                if (instr.mnemonic != Mnemonic::LW)
+                {
+                    return false;
+                }
+
+                address = sign_extend_halfword(instr.immediate);
+                bases   = { instr.rs, instr.rs };
+                loaded  = true;
+            }
+        }
+        else if (instr.mnemonic == Mnemonic::LUI && is_base(instr.rt))
+        {
+            address += instr.immediate << 16;
+            found    = true;
+        }
+        else if (instr.mnemonic == Mnemonic::ADDU && is_base(instr.rd))
+        {
+            bases = { instr.rs, instr.rt };
+        }
+        else if (instr.mnemonic == Mnemonic::ADDIU && is_base(instr.rt))
+        {
+            address += sign_extend_halfword(instr.immediate);
+            bases    = { instr.rs, instr.rs };
+        }
+    }
+
+    if (!found || !contains(address))
+    {
+        return false;
+    }
+
+    JumpTable table{ jump.pc, address, { } };
+
+    const auto size
+    {
+        count != 0 ? std::min<std::size_t>(count, MAX_JUMP_TABLE_SIZE) :
+                     MAX_JUMP_TABLE_SIZE
+    };
+
+    // Without a bounds check, the table ends at the first entry which can't
+    // be the address of an instruction.
+    for (std::size_t index{ 0 }; index < size; ++index)
+    {
+        const Word entry{ address + static_cast<Word>(index * sizeof(Word)) };
+
+        if (!contains(entry))
+        {
+            break;
+        }
+
+        const Word target{ word_at(entry) };
+
+        if (!contains(target) || decode(target).mnemonic == Mnemonic::ILLEGAL)
+        {
+            break;
+        }
+        table.targets.push_back(target);
+    }
+
+    if (table.targets.empty())
+    {
+        return false;
+    }
+
+    for (const auto target : table.targets)
+    {
+        add_leader(target);
+    }
+
+    tables_by_jump[jump.pc] = jump_tables.size();
+    jump_tables.push_back(std::move(table));
+
+    return true;
+}
+
+/// @brief Computes the successors of a block ending with a jump or branch.
+/// @param jump The address of the jump or branch.
+auto Analyzer::successors(const Word jump) const noexcept -> std::vector<Word>
+{
+    const auto instr{ decode(jump) };
+    std::vector<Word> result;
+
+    if (is_call(instr) || instr.mnemonic == Mnemonic::JALR)
+    {
+        result.push_back(jump + 8);
+    }
+    else if (instr.mnemonic == Mnemonic::JR)
+    {
+        const auto table{ tables_by_jump.find(jump) };
+
+        if (table != tables_by_jump.end())
+        {
+            result = jump_tables[table->second].targets;
+
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()),
+                         result.end());
+        }
+    }
+    else
+    {
+        result.push_back(instr.address);
+
+        if (instr.operands != Operands::Jump && !is_unconditional(instr))
+        {
+            result.push_back(jump + 8);
+        }
+    }
+
+    result.erase(std::remove_if(result.begin(), result.end(),
+    [&](const Word address)
+    {
+        return !contains(address) ||
+               !(flags[(address - base) / sizeof(Word)] & Flag::Code);
+    }), result.end());
+
+    return result;
+}
+
+/// @brief Splits the instructions found into blocks.
+auto Analyzer::build_blocks() noexcept -> void
+{
+    Block* current{ nullptr };
+
+    for (std::size_t index{ 0 }; index < flags.size(); ++index)
+    {
+        const Word address{ base + static_cast<Word>(index * sizeof(Word)) };
+        const auto f{ flags[index] };
+
+        if (!(f & Flag::Code))
+        {
+            current = nullptr;
+            continue;
+        }
+
+        if (!current || (f & Flag::Leader))
+        {
+            // Falling through into another block.
+            if (current)
+            {
+                current->successors.push_back(address);
+            }
+
+            current        = &blocks[address];
+            current->start = address;
+        }
+        current->end = address + 4;
+
+        if (f & Flag::End)
+        {
+            current->successors = successors(address - 4);
+            current             = nullptr;
+        }
+    }
+}
+
+/// @brief Groups the blocks into functions.
+auto Analyzer::build_functions() noexcept -> void
+{
+    for (const auto entry : entries)
+    {
+        if (blocks.find(entry) == blocks.end())
+        {
+            continue;
+        }
+
+        Function function{ entry, entry, { } };
+        std::set<Word> seen{ entry };
+        std::vector<Word> queue{ entry };
+
+        while (!queue.empty())
+        {
+            const auto& block{ blocks.at(queue.back()) };
+            queue.pop_back();
+
+            function.blocks.push_back(block.start);
+            function.end = std::max(function.end, block.end);
+
+            for (const auto successor : block.successors)
+            {
+                // A jump to another function is a tail call.
+                if (entries.count(successor) != 0)
+                {
+                    continue;
+                }
+
+                if (seen.insert(successor).second &&
+                    blocks.find(successor) != blocks.end())
+                {
+                    queue.push_back(successor);
+                }
+            }
+        }
+
+        std::sort(function.blocks.begin(), function.blocks.end());
+        functions[entry] = std::move(function);
+    }
+}
@@ -12,6 +12,7 @@
 // OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
 // CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
+#include <algorithm>
 #include "bus.h"
 
 using namespace PlayStation;
@@ -20,12 +21,23 @@ using namespace PlayStation;
 SystemBus::SystemBus() noexcept
 {
     ram.resize(RAM_SIZE);
+    ram_dirty.fill(DIRTY_ALL);
 }
 
 /// @brief Resets the system bus to the startup state.
 auto SystemBus::reset() noexcept -> void
 {
-    ram.clear();
+    // The pages not written since the last reset are still zeroed, which
+    // makes resetting a system that has barely run cheap.
+    for (std::size_t page{ 0 }; page < RAM_PAGES; ++page)
+    {
+        if (ram_dirty[page] & DIRTY_RESET)
+        {
+            std::fill_n(&ram[page * DIRTY_PAGE_SIZE], DIRTY_PAGE_SIZE, 0x00);
+            ram_dirty[page] = DIRTY_ALL & ~DIRTY_RESET;
+        }
+    }
+
     scratchpad.fill(0x00000000);
 
     gpu.reset();
@@ -38,3 +50,20 @@ auto SystemBus::set_bios_data(const BIOS& data) noexcept -> void
 {
     bios = data;
 }
+
+/// @brief Marks main RAM written to other than through the bus as dirty.
+/// @param paddr The physical address of the first byte written.
+/// @param size The number of bytes written.
+auto SystemBus::mark_dirty(const Word paddr, const Word size) noexcept -> void
+{
+    if (size == 0 || paddr >= RAM_SIZE)
+    {
+        return;
+    }
+
+    const Word last{ std::min<Word>(paddr + size, RAM_SIZE) - 1 };
+
+    std::fill(ram_dirty.begin() + (paddr / DIRTY_PAGE_SIZE),
+              ram_dirty.begin() + (last / DIRTY_PAGE_SIZE) + 1,
+              DIRTY_ALL);
+}
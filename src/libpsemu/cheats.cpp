@@ -0,0 +1,429 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include "cheats.h"
+
+using namespace PlayStation;
+
+/// @brief Removes the whitespace around a string.
+/// @param text The string to trim.
+static auto trim(const std::string& text) noexcept -> std::string
+{
+    const auto first{ text.find_first_not_of(" \t\r") };
+
+    if (first == std::string::npos)
+    {
+        return { };
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+/// @brief Parses a hexadecimal number of a fixed number of digits.
+/// @param text The text to parse.
+/// @param start The index of the first digit.
+/// @param digits The number of digits.
+/// @param value Where to store the number.
+/// @return `false` if the text isn't made of that many digits there.
+static auto parse_hex(const std::string& text,
+                      const std::size_t start,
+                      const std::size_t digits,
+                      Word& value) noexcept -> bool
+{
+    if (start + digits > text.size())
+    {
+        return false;
+    }
+
+    value = 0;
+
+    for (auto index{ start }; index < start + digits; ++index)
+    {
+        const auto c{ static_cast<unsigned char>(text[index]) };
+
+        if (!std::isxdigit(c))
+        {
+            return false;
+        }
+
+        value = (value << 4) |
+                (std::isdigit(c) ? c - '0' : std::tolower(c) - 'a' + 10);
+    }
+    return true;
+}
+
+/// @brief Parses a code of the form "AAAAAAAA VVVV".
+/// @param line The code, without surrounding whitespace.
+/// @param address Where to store the address part.
+/// @param value Where to store the value part.
+/// @return `false` if the code is malformed.
+static auto parse_code(const std::string& line,
+                       Word& address,
+                       Halfword& value) noexcept -> bool
+{
+    constexpr std::size_t ADDRESS_DIGITS{ 8 };
+    constexpr std::size_t VALUE_DIGITS{ 4 };
+
+    const auto value_start{ line.find_first_not_of(" \t", ADDRESS_DIGITS) };
+    Word word;
+
+    if (value_start == ADDRESS_DIGITS ||
+        value_start == std::string::npos ||
+        value_start + VALUE_DIGITS != line.size() ||
+        !parse_hex(line, 0, ADDRESS_DIGITS, address) ||
+        !parse_hex(line, value_start, VALUE_DIGITS, word))
+    {
+        return false;
+    }
+
+    value = static_cast<Halfword>(word);
+    return true;
+}
+
+/// @brief Converts the address of a code to a physical address of main RAM,
+/// aligned to the size of the value.
+/// @param address The address.
+/// @param width The size of the value, in bytes.
+static auto ram_address(const Word address, const Byte width) noexcept -> Word
+{
+    return address & (RAM_SIZE - 1) & ~static_cast<Word>(width - 1);
+}
+
+/// @brief Adds codes, one per line as "AAAAAAAA VVVV". Lines may also be
+/// separated by '+'. Blank lines and lines starting with '#' are ignored.
+/// @param codes The codes to add.
+/// @return `false` if a code is malformed or of an unsupported type, in which
+/// case none of them are added.
+auto Cheats::add(const std::string& codes) noexcept -> bool
+{
+    const auto old_conditions{ conditions.size() };
+    const auto old_operations{ operations.size() };
+    const auto old_requirements{ requirements.size() };
+
+    const auto fail = [&]()
+    {
+        conditions.resize(old_conditions);
+        operations.resize(old_operations);
+        requirements.resize(old_requirements);
+
+        return false;
+    };
+
+    // Conditions waiting for the code they apply to
+    std::vector<std::uint32_t> pending;
+
+    // Parameters of a slide waiting for the write to repeat
+    bool sliding{ false };
+    Word slide_count{ 0 };
+    Word slide_step{ 0 };
+    Halfword slide_increment{ 0 };
+
+    std::size_t start{ 0 };
+
+    while (start <= codes.size())
+    {
+        auto end{ codes.find_first_of("\n+", start) };
+
+        if (end == std::string::npos)
+        {
+            end = codes.size();
+        }
+
+        const auto line{ trim(codes.substr(start, end - start)) };
+        start = end + 1;
+
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        Word address;
+        Halfword value;
+
+        if (!parse_code(line, address, value))
+        {
+            return fail();
+        }
+
+        const auto type{ address >> 24 };
+
+        // Conditions: D0 to D3 test halfwords, E0 to E3 test bytes.
+        if ((type & 0xF0) == 0xD0 || (type & 0xF0) == 0xE0)
+        {
+            if ((type & 0x0F) > 3 || sliding)
+            {
+                return fail();
+            }
+
+            const Byte width{ (type & 0xF0) == 0xD0 ? Byte{ 2 } : Byte{ 1 } };
+
+            pending.push_back(static_cast<std::uint32_t>(conditions.size()));
+            conditions.push_back({ ram_address(address, width),
+                                   static_cast<Halfword>(width == 1 ?
+                                                         value & 0xFF : value),
+                                   width,
+                                   static_cast<Test>(type & 0x0F) });
+            continue;
+        }
+
+        if (type == 0x50)
+        {
+            if (sliding)
+            {
+                return fail();
+            }
+
+            sliding         = true;
+            slide_count     = (address >> 8) & 0xFF;
+            slide_step      = address & 0xFF;
+            slide_increment = value;
+
+            continue;
+        }
+
+        Byte width;
+        Action action;
+
+        switch (type)
+        {
+            case 0x30: width = 1; action = Action::Write;     break;
+            case 0x80: width = 2; action = Action::Write;     break;
+            case 0x10: width = 2; action = Action::Increment; break;
+            case 0x11: width = 2; action = Action::Decrement; break;
+            case 0x20: width = 1; action = Action::Increment; break;
+            case 0x21: width = 1; action = Action::Decrement; break;
+
+            default:
+                return fail();
+        }
+
+        // Only constant writes can be repeated by a slide.
+        if (sliding && action != Action::Write)
+        {
+            return fail();
+        }
+
+        const auto first{ static_cast<std::uint32_t>(requirements.size()) };
+        requirements.insert(requirements.end(), pending.begin(), pending.end());
+
+        const auto last{ static_cast<std::uint32_t>(requirements.size()) };
+        pending.clear();
+
+        const auto count{ sliding ? slide_count : 1 };
+
+        for (Word index{ 0 }; index < count; ++index)
+        {
+            const Word repeated{ value +
+                                 (index * (sliding ? slide_increment : 0)) };
+
+            operations.push_back({
+                ram_address((address & 0x00FFFFFF) +
+                            (index * (sliding ? slide_step : 0)),
+                            width),
+                static_cast<Halfword>(width == 1 ? repeated & 0xFF :
+                                                   repeated),
+                width,
+                action,
+                first,
+                last });
+        }
+        sliding = false;
+    }
+
+    // A condition or slide with nothing to apply to is as good as malformed.
+    if (!pending.empty() || sliding)
+    {
+        return fail();
+    }
+
+    sort_conditions();
+    return true;
+}
+
+/// @brief Adds codes from a file, in the same format as `add()`.
+/// @param path The path of the file to read.
+/// @return `false` if the file couldn't be read or a code is invalid.
+auto Cheats::load(const std::string& path) noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "r") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    std::string codes;
+    char buffer[512];
+
+    while (std::fgets(buffer, sizeof(buffer), file))
+    {
+        codes += buffer;
+    }
+
+    std::fclose(file);
+    return add(codes);
+}
+
+/// @brief Removes all codes.
+auto Cheats::clear() noexcept -> void
+{
+    conditions.clear();
+    operations.clear();
+    requirements.clear();
+    results.clear();
+}
+
+/// @brief Applies the codes to main RAM.
+/// @param bus The system bus whose main RAM to change.
+auto Cheats::apply(SystemBus& bus) noexcept -> void
+{
+    Byte* ram{ bus.ram.data() };
+
+    for (std::size_t index{ 0 }; index < conditions.size(); ++index)
+    {
+        const auto& condition{ conditions[index] };
+        Halfword value{ 0 };
+
+        std::memcpy(&value, &ram[condition.paddr], condition.width);
+
+        switch (condition.test)
+        {
+            case Test::Equal:    results[index] = value == condition.value; break;
+            case Test::NotEqual: results[index] = value != condition.value; break;
+            case Test::Less:     results[index] = value < condition.value;  break;
+            case Test::Greater:  results[index] = value > condition.value;  break;
+        }
+    }
+
+    for (const auto& operation : operations)
+    {
+        const auto met{ std::all_of(requirements.data() +
+                                    operation.first_requirement,
+                                    requirements.data() +
+                                    operation.last_requirement,
+                                    [&](const std::uint32_t condition)
+                                    {
+                                        return results[condition] != 0;
+                                    }) };
+
+        if (!met)
+        {
+            continue;
+        }
+
+        Halfword value{ 0 };
+        std::memcpy(&value, &ram[operation.paddr], operation.width);
+
+        switch (operation.action)
+        {
+            case Action::Write:     value  = operation.value; break;
+            case Action::Increment: value += operation.value; break;
+            case Action::Decrement: value -= operation.value; break;
+        }
+
+        std::memcpy(&ram[operation.paddr], &value, operation.width);
+        bus.mark_dirty(operation.paddr, operation.width);
+    }
+}
+
+/// @brief Returns the number of writes the codes were compiled to.
+auto Cheats::size() const noexcept -> std::size_t
+{
+    return operations.size();
+}
+
+/// @brief Returns a hash of the codes as compiled, e.g. to tell if a movie
+/// was recorded with the same codes.
+/// @return The hash, or 0 if there are no codes.
+auto Cheats::hash() const noexcept -> std::uint64_t
+{
+    if (operations.empty())
+    {
+        return 0;
+    }
+
+    // FNV-1a, field by field.
+    std::uint64_t result{ 0xCBF29CE484222325 };
+
+    const auto mix = [&](const std::uint64_t value)
+    {
+        result = (result ^ value) * 0x100000001B3;
+    };
+
+    mix(conditions.size());
+
+    for (const auto& condition : conditions)
+    {
+        mix(condition.paddr);
+        mix(condition.value);
+        mix(condition.width);
+        mix(static_cast<Byte>(condition.test));
+    }
+
+    mix(operations.size());
+
+    for (const auto& operation : operations)
+    {
+        mix(operation.paddr);
+        mix(operation.value);
+        mix(operation.width);
+        mix(static_cast<Byte>(operation.action));
+        mix(operation.first_requirement);
+        mix(operation.last_requirement);
+    }
+
+    for (const auto requirement : requirements)
+    {
+        mix(requirement);
+    }
+    return result;
+}
+
+/// @brief Sorts the conditions by address, keeping the requirements pointing
+/// at the right ones.
+auto Cheats::sort_conditions() noexcept -> void
+{
+    std::vector<std::uint32_t> order(conditions.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    std::stable_sort(order.begin(), order.end(),
+    [&](const std::uint32_t a, const std::uint32_t b)
+    {
+        return conditions[a].paddr < conditions[b].paddr;
+    });
+
+    std::vector<std::uint32_t> position(order.size());
+    std::vector<Condition> sorted;
+
+    sorted.reserve(conditions.size());
+
+    for (std::size_t index{ 0 }; index < order.size(); ++index)
+    {
+        position[order[index]] = static_cast<std::uint32_t>(index);
+        sorted.push_back(conditions[order[index]]);
+    }
+
+    conditions = std::move(sorted);
+
+    for (auto& requirement : requirements)
+    {
+        requirement = position[requirement];
+    }
+
+    results.assign(conditions.size(), 0);
+}
@@ -0,0 +1,220 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <map>
+#include "coverage.h"
+
+using namespace PlayStation;
+
+/// @brief Number of words of main RAM
+constexpr Word RAM_WORDS{ RAM_SIZE / sizeof(Word) };
+
+/// @brief Number of words of the BIOS
+constexpr Word BIOS_WORDS{ BIOS_SIZE / sizeof(Word) };
+
+/// @brief Physical address of the BIOS
+constexpr Word BIOS_BASE{ 0x1FC00000 };
+
+/// @brief Converts the index of a bit in the block bitmap back to an address,
+/// in KSEG0 for main RAM and KSEG1 for the BIOS as the hardware uses.
+/// @param index The index to convert.
+static auto word_address(const Word index) noexcept -> Word
+{
+    if (index < RAM_WORDS)
+    {
+        return 0x80000000 | (index * sizeof(Word));
+    }
+    return 0xA0000000 | (BIOS_BASE + ((index - RAM_WORDS) * sizeof(Word)));
+}
+
+/// @brief Initializes the collector.
+/// @param m What to record.
+Coverage::Coverage(const Mode m) noexcept : mode(m)
+{
+    reset();
+}
+
+/// @brief Discards all data collected so far.
+auto Coverage::reset() noexcept -> void
+{
+    bits.assign(mode == Mode::Blocks ? (RAM_WORDS + BIOS_WORDS) / 8 :
+                                       EDGE_MAP_SIZE, 0);
+
+    last_pc          = 0xFFFFFFFF;
+    in_delay_slot    = false;
+    after_delay_slot = false;
+    previous         = 0;
+}
+
+/// @brief Records the transition to a block in `Edges` mode.
+auto Coverage::mark_edge(const Word pc) noexcept -> void
+{
+    const Word location
+    {
+        static_cast<Word>(((pc >> 2) ^ (pc >> 18)) % EDGE_MAP_SIZE)
+    };
+
+    bits[location ^ previous]++;
+
+    // Shifted so that A -> B and B -> A, as well as A -> A and B -> B, end up
+    // in different entries.
+    previous = location >> 1;
+}
+
+/// @brief Determines if a block beginning at an address was executed. Always
+/// `false` in `Edges` mode.
+auto Coverage::executed(const Word address) const noexcept -> bool
+{
+    const Word index{ word_index(address) };
+
+    return mode == Mode::Blocks &&
+           index != NO_INDEX &&
+           (bits[index / 8] & (1 << (index % 8))) != 0;
+}
+
+/// @brief Returns the number of blocks executed or, in `Edges` mode, the
+/// number of entries of the edge map which were hit.
+auto Coverage::count() const noexcept -> std::size_t
+{
+    std::size_t total{ 0 };
+
+    for (const auto byte : bits)
+    {
+        total += mode == Mode::Blocks ? __builtin_popcount(byte) : byte != 0;
+    }
+    return total;
+}
+
+/// @brief Returns the bitmap of blocks or the map of edges.
+auto Coverage::map() const noexcept -> const std::vector<Byte>&
+{
+    return bits;
+}
+
+/// @brief Names a function in the output.
+/// @param address The address of the function.
+/// @param name The name of the function.
+auto Coverage::add_symbol(const Word address, const std::string& name) noexcept
+-> void
+{
+    symbols[address] = name;
+}
+
+/// @brief Loads function names from a file, see `read_symbols()`.
+/// @param path The path of the file to read.
+/// @return `false` if the file couldn't be opened.
+auto Coverage::load_symbols(const std::string& path) noexcept -> bool
+{
+    return read_symbols(path, symbols);
+}
+
+/// @brief Adds a block known to exist, e.g. found by `Analyzer`, so that it is
+/// reported even if it wasn't executed.
+/// @param address The address of the block.
+auto Coverage::add_block(const Word address) noexcept -> void
+{
+    known_blocks.insert(address);
+}
+
+/// @brief Writes the blocks in lcov tracefile format. As there are no source
+/// files, the addresses of the blocks and functions are written in place of
+/// line numbers, in decimal.
+/// @param file The stream to write to.
+/// @param name The name to give to the "source file", e.g. the path of the
+/// EXE.
+auto Coverage::write_lcov(FILE* file, const std::string& name) const noexcept
+-> void
+{
+    std::map<Word, bool> lines;
+    std::map<Word, Word> known_by_index;
+
+    for (const auto address : known_blocks)
+    {
+        lines[address] = executed(address);
+        known_by_index[word_index(address)] = address;
+    }
+
+    // The edge map says nothing about addresses.
+    const Word words{ mode == Mode::Blocks ? RAM_WORDS + BIOS_WORDS : 0 };
+
+    for (Word index{ 0 }; index < words; ++index)
+    {
+        if (!(bits[index / 8] & (1 << (index % 8))))
+        {
+            continue;
+        }
+
+        // Use the address the block is known under, which may be in another
+        // segment than the one we'd pick.
+        const auto known{ known_by_index.find(index) };
+
+        lines[known != known_by_index.end() ? known->second :
+                                              word_address(index)] = true;
+    }
+
+    std::fprintf(file, "TN:\nSF:%s\n", name.c_str());
+
+    auto functions_hit{ 0 };
+
+    for (const auto& [address, function] : symbols)
+    {
+        std::fprintf(file, "FN:%u,%s\n", address, function.c_str());
+    }
+
+    for (const auto& [address, function] : symbols)
+    {
+        const auto hit{ executed(address) };
+
+        std::fprintf(file, "FNDA:%d,%s\n", hit, function.c_str());
+        functions_hit += hit;
+    }
+
+    std::fprintf(file,
+                 "FNF:%zu\nFNH:%d\n",
+                 symbols.size(),
+                 functions_hit);
+
+    auto lines_hit{ 0 };
+
+    for (const auto& [address, hit] : lines)
+    {
+        std::fprintf(file, "DA:%u,%d\n", address, hit);
+        lines_hit += hit;
+    }
+
+    std::fprintf(file,
+                 "LF:%zu\nLH:%d\nend_of_record\n",
+                 lines.size(),
+                 lines_hit);
+}
+
+/// @brief Writes the blocks in lcov tracefile format to a file.
+/// @param path The path of the file to write to.
+/// @param name The name to give to the "source file".
+/// @return `false` if the file couldn't be opened.
+auto Coverage::write_lcov(const std::string& path,
+                          const std::string& name) const noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "w") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    write_lcov(file, name);
+    std::fclose(file);
+
+    return true;
+}
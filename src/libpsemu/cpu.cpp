@@ -38,7 +38,24 @@ auto CPU::reset() noexcept -> void
 
     // We load the next instruction here to give debuggers a chance to access
     // it.
-    instruction.word = bus.memory_access<Word>(pc);
+    instruction.word = bus.fetch(pc);
+}
+
+/// @brief Transfers control to an address immediately, without a branch delay
+/// slot. Any pending load is completed first.
+/// @param address The address to continue execution from.
+auto CPU::set_pc(const Word address) noexcept -> void
+{
+    if (delay_slot.pending)
+    {
+        *delay_slot.reg = delay_slot.value;
+        delay_slot = { };
+    }
+
+    pc      = address;
+    next_pc = pc + 4;
+
+    instruction.word = bus.fetch(pc);
 }
 
 /// @brief Returns the 26-bit target address.
@@ -97,6 +114,11 @@ auto CPU::jump() noexcept -> void
 /// @param bad_vaddr The bad virtual address, if any.
 auto CPU::trap(const Exception exc, const Word bad_vaddr) noexcept -> void
 {
+    if constexpr (STATS_ENABLED)
+    {
+        Stats::this_thread.exception(exc);
+    }
+
     // So on an exception, the CPU:
 
     // 1) sets up EPC to point to the restart location.
@@ -154,7 +176,12 @@ auto CPU::step() noexcept -> void
         trap(Exception::AdEL);
     }
 
-    instruction.word = bus.memory_access<Word>(pc);
+    instruction.word = bus.fetch(pc);
+
+    if constexpr (STATS_ENABLED)
+    {
+        Stats::this_thread.instruction(instruction.word);
+    }
 
     pc = next_pc;
     next_pc += 4;
@@ -629,6 +656,6 @@ auto CPU::step() noexcept -> void
             break;
     }
 
-    instruction.word = bus.memory_access<Word>(pc);
+    instruction.word = bus.fetch(pc);
     gpr[0] = 0x00000000;
 }
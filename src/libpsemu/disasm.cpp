@@ -0,0 +1,689 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include "cpu.h"
+#include "disasm.h"
+
+using namespace PlayStation;
+
+/// @brief Defines the entry of an opcode table.
+struct Opcode
+{
+    Mnemonic mnemonic;
+    Operands operands;
+};
+
+/// @brief Names of the instructions, indexed by `Mnemonic`
+static constexpr std::array<const char*,
+                            static_cast<std::size_t>(Mnemonic::Count)> mnemonics
+{
+    "illegal",
+    "sll",    "srl",    "sra",    "sllv",   "srlv",   "srav",
+    "jr",     "jalr",   "syscall", "break",
+    "mfhi",   "mthi",   "mflo",   "mtlo",   "mult",   "multu",  "div", "divu",
+    "add",    "addu",   "sub",    "subu",   "and",    "or",     "xor", "nor",
+    "slt",    "sltu",
+    "bltz",   "bgez",   "bltzal", "bgezal",
+    "j",      "jal",    "beq",    "bne",    "blez",   "bgtz",
+    "addi",   "addiu",  "slti",   "sltiu",  "andi",   "ori",    "xori", "lui",
+    "mfc0",   "mtc0",   "rfe",
+    "mfc2",   "cfc2",   "mtc2",   "ctc2",   "cop2",
+    "lb",     "lh",     "lwl",    "lw",     "lbu",    "lhu",    "lwr",
+    "sb",     "sh",     "swl",    "sw",     "swr",
+    "lwc2",   "swc2"
+};
+
+static_assert(mnemonics.back() != nullptr, "every mnemonic needs a name");
+
+/// @brief Names of the system control co-processor (COP0) registers
+static constexpr std::array<const char*, 32> cop0_names
+{
+    "UNKNOWN0",  "UNKNOWN1",  "UNKNOWN2",  "BPC",
+    "UNKNOWN4",  "BDA",       "TAR",       "DCIC",
+    "BadA",      "BDAM",      "UNKNOWN10", "BPCM",
+    "SR",        "Cause",     "EPC",       "PRId",
+    "UNKNOWN16", "UNKNOWN17", "UNKNOWN18", "UNKNOWN19",
+    "UNKNOWN20", "UNKNOWN21", "UNKNOWN22", "UNKNOWN23",
+    "UNKNOWN24", "UNKNOWN25", "UNKNOWN26", "UNKNOWN27",
+    "UNKNOWN28", "UNKNOWN29", "UNKNOWN30", "UNKNOWN31"
+};
+
+/// @brief Marks an opcode that doesn't exist.
+constexpr Opcode ILLEGAL{ Mnemonic::ILLEGAL, Operands::None };
+
+/// @brief Instructions referenced by bits [31:26] of an instruction. Groups
+/// are decoded separately and are marked illegal here.
+static constexpr std::array<Opcode, 64> opcodes
+{{
+    ILLEGAL,                                         // 0x00
+    ILLEGAL,                                         // 0x01
+    { Mnemonic::J,     Operands::Jump },             // 0x02
+    { Mnemonic::JAL,   Operands::Jump },             // 0x03
+    { Mnemonic::BEQ,   Operands::BranchCompare },    // 0x04
+    { Mnemonic::BNE,   Operands::BranchCompare },    // 0x05
+    { Mnemonic::BLEZ,  Operands::Branch },           // 0x06
+    { Mnemonic::BGTZ,  Operands::Branch },           // 0x07
+    { Mnemonic::ADDI,  Operands::ALUImmediate },     // 0x08
+    { Mnemonic::ADDIU, Operands::ALUImmediate },     // 0x09
+    { Mnemonic::SLTI,  Operands::ALUImmediate },     // 0x0A
+    { Mnemonic::SLTIU, Operands::ALUImmediate },     // 0x0B
+    { Mnemonic::ANDI,  Operands::ALUImmediate },     // 0x0C
+    { Mnemonic::ORI,   Operands::ALUImmediate },     // 0x0D
+    { Mnemonic::XORI,  Operands::ALUImmediate },     // 0x0E
+    { Mnemonic::LUI,   Operands::LoadUpperImmediate }, // 0x0F
+    ILLEGAL,                                         // 0x10
+    ILLEGAL,                                         // 0x11
+    ILLEGAL,                                         // 0x12
+    ILLEGAL,                                         // 0x13
+    ILLEGAL,                                         // 0x14
+    ILLEGAL,                                         // 0x15
+    ILLEGAL,                                         // 0x16
+    ILLEGAL,                                         // 0x17
+    ILLEGAL,                                         // 0x18
+    ILLEGAL,                                         // 0x19
+    ILLEGAL,                                         // 0x1A
+    ILLEGAL,                                         // 0x1B
+    ILLEGAL,                                         // 0x1C
+    ILLEGAL,                                         // 0x1D
+    ILLEGAL,                                         // 0x1E
+    ILLEGAL,                                         // 0x1F
+    { Mnemonic::LB,    Operands::Memory },           // 0x20
+    { Mnemonic::LH,    Operands::Memory },           // 0x21
+    { Mnemonic::LWL,   Operands::Memory },           // 0x22
+    { Mnemonic::LW,    Operands::Memory },           // 0x23
+    { Mnemonic::LBU,   Operands::Memory },           // 0x24
+    { Mnemonic::LHU,   Operands::Memory },           // 0x25
+    { Mnemonic::LWR,   Operands::Memory },           // 0x26
+    ILLEGAL,                                         // 0x27
+    { Mnemonic::SB,    Operands::Memory },           // 0x28
+    { Mnemonic::SH,    Operands::Memory },           // 0x29
+    { Mnemonic::SWL,   Operands::Memory },           // 0x2A
+    { Mnemonic::SW,    Operands::Memory },           // 0x2B
+    ILLEGAL,                                         // 0x2C
+    ILLEGAL,                                         // 0x2D
+    { Mnemonic::SWR,   Operands::Memory },           // 0x2E
+    ILLEGAL,                                         // 0x2F
+    ILLEGAL,                                         // 0x30
+    ILLEGAL,                                         // 0x31
+    { Mnemonic::LWC2,  Operands::COP2Memory },       // 0x32
+    ILLEGAL,                                         // 0x33
+    ILLEGAL,                                         // 0x34
+    ILLEGAL,                                         // 0x35
+    ILLEGAL,                                         // 0x36
+    ILLEGAL,                                         // 0x37
+    ILLEGAL,                                         // 0x38
+    ILLEGAL,                                         // 0x39
+    { Mnemonic::SWC2,  Operands::COP2Memory },       // 0x3A
+    ILLEGAL,                                         // 0x3B
+    ILLEGAL,                                         // 0x3C
+    ILLEGAL,                                         // 0x3D
+    ILLEGAL,                                         // 0x3E
+    ILLEGAL                                          // 0x3F
+}};
+
+/// @brief Instructions referenced by bits [5:0] of an instruction in the
+/// SPECIAL group.
+static constexpr std::array<Opcode, 64> special_opcodes
+{{
+    { Mnemonic::SLL,     Operands::Shift },               // 0x00
+    ILLEGAL,                                              // 0x01
+    { Mnemonic::SRL,     Operands::Shift },               // 0x02
+    { Mnemonic::SRA,     Operands::Shift },               // 0x03
+    { Mnemonic::SLLV,    Operands::ShiftVariable },       // 0x04
+    ILLEGAL,                                              // 0x05
+    { Mnemonic::SRLV,    Operands::ShiftVariable },       // 0x06
+    { Mnemonic::SRAV,    Operands::ShiftVariable },       // 0x07
+    { Mnemonic::JR,      Operands::JumpRegister },        // 0x08
+    { Mnemonic::JALR,    Operands::JumpAndLinkRegister }, // 0x09
+    ILLEGAL,                                              // 0x0A
+    ILLEGAL,                                              // 0x0B
+    { Mnemonic::SYSCALL, Operands::Code },                // 0x0C
+    { Mnemonic::BREAK,   Operands::Code },                // 0x0D
+    ILLEGAL,                                              // 0x0E
+    ILLEGAL,                                              // 0x0F
+    { Mnemonic::MFHI,    Operands::MoveFrom },            // 0x10
+    { Mnemonic::MTHI,    Operands::MoveTo },              // 0x11
+    { Mnemonic::MFLO,    Operands::MoveFrom },            // 0x12
+    { Mnemonic::MTLO,    Operands::MoveTo },              // 0x13
+    ILLEGAL,                                              // 0x14
+    ILLEGAL,                                              // 0x15
+    ILLEGAL,                                              // 0x16
+    ILLEGAL,                                              // 0x17
+    { Mnemonic::MULT,    Operands::MultiplyDivide },      // 0x18
+    { Mnemonic::MULTU,   Operands::MultiplyDivide },      // 0x19
+    { Mnemonic::DIV,     Operands::MultiplyDivide },      // 0x1A
+    { Mnemonic::DIVU,    Operands::MultiplyDivide },      // 0x1B
+    ILLEGAL,                                              // 0x1C
+    ILLEGAL,                                              // 0x1D
+    ILLEGAL,                                              // 0x1E
+    ILLEGAL,                                              // 0x1F
+    { Mnemonic::ADD,     Operands::ALURegister },         // 0x20
+    { Mnemonic::ADDU,    Operands::ALURegister },         // 0x21
+    { Mnemonic::SUB,     Operands::ALURegister },         // 0x22
+    { Mnemonic::SUBU,    Operands::ALURegister },         // 0x23
+    { Mnemonic::AND,     Operands::ALURegister },         // 0x24
+    { Mnemonic::OR,      Operands::ALURegister },         // 0x25
+    { Mnemonic::XOR,     Operands::ALURegister },         // 0x26
+    { Mnemonic::NOR,     Operands::ALURegister },         // 0x27
+    ILLEGAL,                                              // 0x28
+    ILLEGAL,                                              // 0x29
+    { Mnemonic::SLT,     Operands::ALURegister },         // 0x2A
+    { Mnemonic::SLTU,    Operands::ALURegister },         // 0x2B
+    ILLEGAL,                                              // 0x2C
+    ILLEGAL,                                              // 0x2D
+    ILLEGAL,                                              // 0x2E
+    ILLEGAL,                                              // 0x2F
+    ILLEGAL,                                              // 0x30
+    ILLEGAL,                                              // 0x31
+    ILLEGAL,                                              // 0x32
+    ILLEGAL,                                              // 0x33
+    ILLEGAL,                                              // 0x34
+    ILLEGAL,                                              // 0x35
+    ILLEGAL,                                              // 0x36
+    ILLEGAL,                                              // 0x37
+    ILLEGAL,                                              // 0x38
+    ILLEGAL,                                              // 0x39
+    ILLEGAL,                                              // 0x3A
+    ILLEGAL,                                              // 0x3B
+    ILLEGAL,                                              // 0x3C
+    ILLEGAL,                                              // 0x3D
+    ILLEGAL,                                              // 0x3E
+    ILLEGAL                                               // 0x3F
+}};
+
+/// @brief Decodes the instructions of the COP0 and COP2 groups.
+/// @param instr The instruction to complete.
+/// @param cop2 `true` for COP2, `false` for COP0.
+static auto decode_coprocessor(DecodedInstruction& instr,
+                               const bool cop2) noexcept -> void
+{
+    const auto operands{ cop2 ? Operands::COP2Register :
+                                Operands::COP0Register };
+
+    // Bit 25 set means the rest of the instruction is a command for the
+    // co-processor.
+    if (instr.rs & 0x10)
+    {
+        if (cop2)
+        {
+            instr.mnemonic = Mnemonic::COP2;
+            instr.operands = Operands::Command;
+            instr.address  = instr.word & 0x01FFFFFF;
+        }
+        else if ((instr.word & 0x3F) == CPU::COP0Instruction::RFE)
+        {
+            instr.mnemonic = Mnemonic::RFE;
+        }
+        return;
+    }
+
+    switch (instr.rs)
+    {
+        case CPU::CoprocessorInstruction::MF:
+            instr.mnemonic = cop2 ? Mnemonic::MFC2 : Mnemonic::MFC0;
+            instr.operands = operands;
+            break;
+
+        case CPU::CoprocessorInstruction::MT:
+            instr.mnemonic = cop2 ? Mnemonic::MTC2 : Mnemonic::MTC0;
+            instr.operands = operands;
+            break;
+
+        // Control registers only exist on the GTE.
+        case 0x02:
+            if (cop2)
+            {
+                instr.mnemonic = Mnemonic::CFC2;
+                instr.operands = operands;
+            }
+            break;
+
+        case 0x06:
+            if (cop2)
+            {
+                instr.mnemonic = Mnemonic::CTC2;
+                instr.operands = operands;
+            }
+            break;
+    }
+}
+
+/// @brief Works out where an instruction leaves its result.
+/// @param instr The instruction to complete.
+static auto decode_destination(DecodedInstruction& instr) noexcept -> void
+{
+    switch (instr.operands)
+    {
+        case Operands::Shift:
+        case Operands::ShiftVariable:
+        case Operands::JumpAndLinkRegister:
+        case Operands::MoveFrom:
+        case Operands::ALURegister:
+            instr.destination = Destination::GPR;
+            instr.written     = instr.rd;
+            break;
+
+        case Operands::ALUImmediate:
+        case Operands::LoadUpperImmediate:
+            instr.destination = Destination::GPR;
+            instr.written     = instr.rt;
+            break;
+
+        case Operands::MoveTo:
+        case Operands::MultiplyDivide:
+            instr.destination = Destination::HiLo;
+            break;
+
+        case Operands::Memory:
+            if (instr.mnemonic <= Mnemonic::LWR)
+            {
+                instr.destination = Destination::GPR;
+                instr.written     = instr.rt;
+            }
+            break;
+
+        case Operands::COP0Register:
+        case Operands::COP2Register:
+            if (instr.mnemonic == Mnemonic::MTC0)
+            {
+                instr.destination = Destination::COP0;
+                instr.written     = instr.rd;
+            }
+            else if (instr.mnemonic != Mnemonic::MTC2 &&
+                     instr.mnemonic != Mnemonic::CTC2)
+            {
+                instr.destination = Destination::GPR;
+                instr.written     = instr.rt;
+            }
+            break;
+
+        case Operands::Jump:
+        case Operands::Branch:
+            if (instr.mnemonic == Mnemonic::JAL    ||
+                instr.mnemonic == Mnemonic::BLTZAL ||
+                instr.mnemonic == Mnemonic::BGEZAL)
+            {
+                instr.destination = Destination::GPR;
+                instr.written     = 31;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/// @brief Splits an instruction into its fields.
+/// @param pc The address of the instruction, used to resolve branches.
+/// @param word The instruction.
+/// @return The decoded instruction.
+auto PlayStation::decode_instruction(const Word pc,
+                                     const Word word) noexcept
+-> DecodedInstruction
+{
+    DecodedInstruction instr{ };
+
+    instr.pc        = pc;
+    instr.word      = word;
+    instr.rs        = (word >> 21) & 0x1F;
+    instr.rt        = (word >> 16) & 0x1F;
+    instr.rd        = (word >> 11) & 0x1F;
+    instr.shamt     = (word >>  6) & 0x1F;
+    instr.immediate = word & 0xFFFF;
+
+    const auto op{ word >> 26 };
+
+    switch (op)
+    {
+        case 0x00:
+        {
+            const auto& opcode{ special_opcodes[word & 0x3F] };
+
+            instr.mnemonic = opcode.mnemonic;
+            instr.operands = opcode.operands;
+
+            if (instr.operands == Operands::Code)
+            {
+                instr.address = (word >> 6) & 0x000FFFFF;
+            }
+            break;
+        }
+
+        case 0x01:
+            // Decoded the same way the CPU does: bit 0 of rt selects the
+            // condition, bit 4 whether to link.
+            instr.mnemonic = instr.rt & 0x10 ?
+                             (instr.rt & 1 ? Mnemonic::BGEZAL :
+                                             Mnemonic::BLTZAL) :
+                             (instr.rt & 1 ? Mnemonic::BGEZ :
+                                             Mnemonic::BLTZ);
+            instr.operands = Operands::Branch;
+            break;
+
+        case 0x10:
+        case 0x12:
+            decode_coprocessor(instr, op == 0x12);
+            break;
+
+        default:
+            instr.mnemonic = opcodes[op].mnemonic;
+            instr.operands = opcodes[op].operands;
+            break;
+    }
+
+    switch (instr.operands)
+    {
+        case Operands::Jump:
+            instr.address = (pc & 0xF0000000) | ((word & 0x03FFFFFF) << 2);
+            break;
+
+        case Operands::Branch:
+        case Operands::BranchCompare:
+            instr.address = pc + 4 + (sign_extend_halfword(instr.immediate)
+                                      << 2);
+            break;
+
+        default:
+            break;
+    }
+
+    decode_destination(instr);
+    return instr;
+}
+
+namespace
+{
+    /// @brief Appends text to a caller-provided buffer, truncating it to
+    /// fit.
+    class Writer final
+    {
+    public:
+        Writer(char* const buffer, const std::size_t size) noexcept :
+        begin(buffer), current(buffer), end(buffer + size - 1)
+        { }
+
+        auto put(const char c) noexcept -> void
+        {
+            if (current != end)
+            {
+                *current++ = c;
+            }
+        }
+
+        auto put(const char* s) noexcept -> void
+        {
+            while (*s && current != end)
+            {
+                *current++ = *s++;
+            }
+        }
+
+        /// @brief Writes `0x` followed by a fixed number of uppercase hex
+        /// digits.
+        auto hex(const Word value, const int digits) noexcept -> void
+        {
+            put("0x");
+
+            for (auto shift{ (digits - 1) * 4 }; shift >= 0; shift -= 4)
+            {
+                put("0123456789ABCDEF"[(value >> shift) & 0xF]);
+            }
+        }
+
+        /// @brief Writes a number from 0 to 99 in decimal.
+        auto decimal(const unsigned int value) noexcept -> void
+        {
+            if (value >= 10)
+            {
+                put(static_cast<char>('0' + value / 10));
+            }
+            put(static_cast<char>('0' + value % 10));
+        }
+
+        auto separator() noexcept -> void
+        {
+            put(", ");
+        }
+
+        auto gpr(const unsigned int index) noexcept -> void
+        {
+            put(GPR_NAMES[index]);
+        }
+
+        /// @brief Terminates the text.
+        /// @return The number of characters written.
+        auto finish() noexcept -> std::size_t
+        {
+            *current = '\0';
+            return current - begin;
+        }
+
+    private:
+        char* const begin;
+        char* current;
+        char* const end;
+    };
+}
+
+/// @brief Writes an instruction as assembly, e.g. `addiu $sp, $sp, 0xFFE8`.
+/// Nothing is allocated; 64 bytes are always enough.
+/// @param instr The decoded instruction.
+/// @param buffer Where to write the text. It is always terminated.
+/// @param size The size of `buffer`. The text is truncated to fit.
+/// @return The number of characters written, excluding the terminator.
+auto PlayStation::format_instruction(const DecodedInstruction& instr,
+                                     char* const buffer,
+                                     const std::size_t size) noexcept
+-> std::size_t
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    Writer out{ buffer, size };
+
+    out.put(mnemonics[static_cast<std::size_t>(instr.mnemonic)]);
+
+    if (instr.operands != Operands::None &&
+        (instr.operands != Operands::Code || instr.address != 0))
+    {
+        out.put(' ');
+    }
+
+    const auto memory = [&]()
+    {
+        const auto offset{ static_cast<SignedHalfword>(instr.immediate) };
+
+        if (offset < 0)
+        {
+            out.put('-');
+        }
+
+        out.hex(offset < 0 ? -offset : offset, 4);
+        out.put('(');
+        out.gpr(instr.rs);
+        out.put(')');
+    };
+
+    switch (instr.operands)
+    {
+        case Operands::None:
+            break;
+
+        case Operands::Shift:
+            out.gpr(instr.rd);
+            out.separator();
+            out.gpr(instr.rt);
+            out.separator();
+            out.decimal(instr.shamt);
+            break;
+
+        case Operands::ShiftVariable:
+            out.gpr(instr.rd);
+            out.separator();
+            out.gpr(instr.rt);
+            out.separator();
+            out.gpr(instr.rs);
+            break;
+
+        case Operands::JumpRegister:
+        case Operands::MoveTo:
+            out.gpr(instr.rs);
+            break;
+
+        case Operands::JumpAndLinkRegister:
+            out.gpr(instr.rd);
+            out.separator();
+            out.gpr(instr.rs);
+            break;
+
+        case Operands::MoveFrom:
+            out.gpr(instr.rd);
+            break;
+
+        case Operands::MultiplyDivide:
+            out.gpr(instr.rs);
+            out.separator();
+            out.gpr(instr.rt);
+            break;
+
+        case Operands::ALURegister:
+            out.gpr(instr.rd);
+            out.separator();
+            out.gpr(instr.rs);
+            out.separator();
+            out.gpr(instr.rt);
+            break;
+
+        case Operands::Jump:
+            out.hex(instr.address, 8);
+            break;
+
+        case Operands::BranchCompare:
+            out.gpr(instr.rs);
+            out.separator();
+            out.gpr(instr.rt);
+            out.separator();
+            out.hex(instr.address, 8);
+            break;
+
+        case Operands::Branch:
+            out.gpr(instr.rs);
+            out.separator();
+            out.hex(instr.address, 8);
+            break;
+
+        case Operands::ALUImmediate:
+            out.gpr(instr.rt);
+            out.separator();
+            out.gpr(instr.rs);
+            out.separator();
+            out.hex(instr.immediate, 4);
+            break;
+
+        case Operands::LoadUpperImmediate:
+            out.gpr(instr.rt);
+            out.separator();
+            out.hex(instr.immediate, 4);
+            break;
+
+        case Operands::COP0Register:
+            out.gpr(instr.rt);
+            out.separator();
+            out.put(cop0_names[instr.rd]);
+            break;
+
+        case Operands::COP2Register:
+            out.gpr(instr.rt);
+            out.separator();
+            out.put('$');
+            out.decimal(instr.rd);
+            break;
+
+        case Operands::Memory:
+            out.gpr(instr.rt);
+            out.separator();
+            memory();
+            break;
+
+        case Operands::COP2Memory:
+            out.put('$');
+            out.decimal(instr.rt);
+            out.separator();
+            memory();
+            break;
+
+        case Operands::Command:
+            out.hex(instr.address, 7);
+            break;
+
+        case Operands::Code:
+            if (instr.address != 0)
+            {
+                out.hex(instr.address, 5);
+            }
+            break;
+    }
+    return out.finish();
+}
+
+/// @brief Writes the value of the register(s) an instruction wrote, e.g.
+/// `$sp=0x801FFEE8`. Meant to be called after the instruction executed.
+/// @param instr The decoded instruction.
+/// @param cpu The CPU to read the values from.
+/// @param buffer Where to write the text. It is always terminated.
+/// @param size The size of `buffer`. The text is truncated to fit.
+/// @return The number of characters written, excluding the terminator.
+/// This is 0 if the instruction doesn't write a register.
+auto PlayStation::format_result(const DecodedInstruction& instr,
+                                CPU& cpu,
+                                char* const buffer,
+                                const std::size_t size) noexcept
+-> std::size_t
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    Writer out{ buffer, size };
+
+    switch (instr.destination)
+    {
+        case Destination::None:
+            break;
+
+        case Destination::GPR:
+            out.gpr(instr.written);
+            out.put('=');
+            out.hex(cpu.gpr[instr.written], 8);
+            break;
+
+        case Destination::COP0:
+            out.put(cop0_names[instr.written]);
+            out.put('=');
+            out.hex(cpu.cop0[instr.written], 8);
+            break;
+
+        case Destination::HiLo:
+            out.put("HI=");
+            out.hex(cpu.hi, 8);
+            out.separator();
+            out.put("LO=");
+            out.hex(cpu.lo, 8);
+            break;
+    }
+    return out.finish();
+}
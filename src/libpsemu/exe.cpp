@@ -0,0 +1,70 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include "exe.h"
+#include "file.h"
+
+using namespace PlayStation;
+
+/// @brief Size of the header preceding the text.
+constexpr auto HEADER_SIZE{ 0x800 };
+
+/// @brief Parses a PS-X EXE.
+/// @param data The contents of the EXE file.
+/// @return `false` if the data is not a PS-X EXE.
+auto EXE::load(const std::vector<Byte>& data) noexcept -> bool
+{
+    if (data.size() < HEADER_SIZE ||
+        std::memcmp(data.data(), "PS-X EXE", 8) != 0)
+    {
+        return false;
+    }
+
+    const auto header_word = [&](const std::size_t offset) -> Word
+    {
+        Word word;
+        std::memcpy(&word, &data[offset], sizeof(Word));
+
+        return word;
+    };
+
+    pc        = header_word(0x10);
+    gp        = header_word(0x14);
+    dest      = header_word(0x18);
+    bss_start = header_word(0x28);
+    bss_size  = header_word(0x2C);
+
+    const Word sp_base{ header_word(0x30) };
+    sp = sp_base != 0 ? sp_base + header_word(0x34) : 0;
+
+    // The size in the header excludes the header itself. Some tools don't
+    // pad the file out to it, so never read past the end of the data.
+    const auto size{ std::min<std::size_t>(header_word(0x1C),
+                                           data.size() - HEADER_SIZE) };
+
+    text.assign(data.begin() + HEADER_SIZE,
+                data.begin() + HEADER_SIZE + size);
+    return true;
+}
+
+/// @brief Reads and parses a PS-X EXE file.
+/// @param path The path of the file.
+/// @return `false` if the file couldn't be read or is not a PS-X EXE.
+auto EXE::load_file(const std::string& path) noexcept -> bool
+{
+    std::vector<Byte> data;
+    return read_file(path, data) && load(data);
+}
@@ -0,0 +1,64 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstdio>
+#include "file.h"
+
+using namespace PlayStation;
+
+/// @brief Reads an entire file into memory.
+/// @param path The path of the file to read.
+/// @param data Where to store the contents of the file.
+/// @return `false` if the file couldn't be read.
+auto PlayStation::read_file(const std::string& path, std::vector<Byte>& data)
+noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "rb") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    const auto size{ std::ftell(file) };
+    std::fseek(file, 0, SEEK_SET);
+
+    data.resize(size < 0 ? 0 : size);
+
+    const auto read{ std::fread(data.data(), 1, data.size(), file) };
+    std::fclose(file);
+
+    return size >= 0 && read == data.size();
+}
+
+/// @brief Reads a BIOS image.
+/// @param path The path of the file to read.
+/// @param bios Where to store the BIOS data.
+/// @return `false` if the file couldn't be read or is not the size of a BIOS
+/// image.
+auto PlayStation::read_bios(const std::string& path, BIOS& bios) noexcept
+-> bool
+{
+    std::vector<Byte> data;
+
+    if (!read_file(path, data) || data.size() != bios.size())
+    {
+        return false;
+    }
+
+    std::copy(data.begin(), data.end(), bios.begin());
+    return true;
+}
@@ -0,0 +1,343 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <climits>
+#include <cstring>
+#include "frame_export.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+using namespace PlayStation;
+
+/// @brief Identifies a shared memory object as a frame ring
+static constexpr char MAGIC[8]{ 'P', 'S', 'E', 'M', 'U', 'F', 'R', 'M' };
+
+#ifdef __linux__
+/// @brief Reads a host clock.
+/// @param clock The clock to read.
+/// @return The time, in nanoseconds.
+static auto now(const clockid_t clock) noexcept -> std::int64_t
+{
+    struct timespec time;
+    clock_gettime(clock, &time);
+
+    return (std::int64_t{ time.tv_sec } * 1000000000) + time.tv_nsec;
+}
+
+/// @brief Performs a futex operation on a word of the frame ring. The ring is
+/// shared between processes, so the operations mustn't be private.
+/// @param word The futex word.
+/// @param op `FUTEX_WAIT` or `FUTEX_WAKE`.
+/// @param value The expected value for `FUTEX_WAIT`, the number of waiters to
+/// wake up for `FUTEX_WAKE`.
+/// @param timeout How long to wait for, if at all.
+static auto futex(const std::atomic<std::uint32_t>& word,
+                  const int op,
+                  const std::uint32_t value,
+                  const struct timespec* timeout = nullptr) noexcept -> void
+{
+    syscall(SYS_futex, &word, op, value, timeout, nullptr, 0);
+}
+#endif
+
+/// @brief Unmaps and removes the frame ring, if any.
+FrameExport::~FrameExport() noexcept
+{
+    close();
+}
+
+/// @brief Creates the frame ring, replacing any existing one with the same
+/// name.
+/// @param name The name of the shared memory object, e.g. "/psemu".
+/// @param slot_count The number of slots.
+/// @return `false` if the ring couldn't be created.
+auto FrameExport::open(const std::string& name,
+                       const std::uint32_t slot_count) noexcept -> bool
+{
+    close();
+
+#ifdef __linux__
+    if (slot_count == 0)
+    {
+        return false;
+    }
+
+    constexpr std::size_t PAGE{ 4096 };
+    constexpr std::size_t PIXEL_BYTES{ sizeof(VRAM) };
+
+    // Slots are page aligned, so that the pixels of a slot never share a
+    // cache line with the header of the next.
+    const std::size_t slot_size{ ((FrameSlot::PIXEL_OFFSET + PIXEL_BYTES +
+                                   PAGE - 1) / PAGE) * PAGE };
+
+    size = PAGE + (slot_size * slot_count);
+
+    shm_unlink(name.c_str());
+
+    const int fd{ shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) };
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    if (ftruncate(fd, size) != 0)
+    {
+        ::close(fd);
+        shm_unlink(name.c_str());
+
+        return false;
+    }
+
+    void* data{ mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // The object is zero filled, so only the header needs filling in.
+    ring = static_cast<FrameRing*>(data);
+
+    ring->version     = 1;
+    ring->slot_count  = slot_count;
+    ring->width       = VRAM_WIDTH;
+    ring->height      = VRAM_HEIGHT;
+    ring->stride      = VRAM_WIDTH * sizeof(Halfword);
+    ring->format      = 0;
+    ring->slot_offset = PAGE;
+    ring->slot_size   = slot_size;
+
+    // Consumers check the magic last, so it is written last.
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(ring->magic, MAGIC, sizeof(MAGIC));
+
+    path   = name;
+    frames = 0;
+
+    return true;
+#else
+    static_cast<void>(name);
+    static_cast<void>(slot_count);
+
+    return false;
+#endif
+}
+
+/// @brief Unmaps and removes the frame ring.
+auto FrameExport::close() noexcept -> void
+{
+#ifdef __linux__
+    if (ring)
+    {
+        munmap(ring, size);
+        shm_unlink(path.c_str());
+    }
+#endif
+    ring = nullptr;
+    size = 0;
+}
+
+/// @brief Publishes a frame and wakes up waiting consumers.
+/// @param vram The contents of VRAM at the end of the frame.
+auto FrameExport::publish(const VRAM& vram) noexcept -> void
+{
+#ifdef __linux__
+    if (!ring)
+    {
+        return;
+    }
+
+    frames++;
+
+    const auto base{ reinterpret_cast<Byte*>(ring) + ring->slot_offset };
+    const auto slot{ reinterpret_cast<FrameSlot*>(
+        base + (((frames - 1) % ring->slot_count) * ring->slot_size)) };
+
+    slot->sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->frame        = frames;
+    slot->monotonic_ns = now(CLOCK_MONOTONIC);
+    slot->realtime_ns  = now(CLOCK_REALTIME);
+
+    std::memcpy(reinterpret_cast<Byte*>(slot) + FrameSlot::PIXEL_OFFSET,
+                vram.data(),
+                sizeof(VRAM));
+
+    slot->sequence.fetch_add(1, std::memory_order_release);
+
+    // Pairs with the registration in `FrameReader::wait()`: either the
+    // consumer sees the new frame, or we see the consumer.
+    ring->published.store(static_cast<std::uint32_t>(frames),
+                          std::memory_order_seq_cst);
+
+    if (ring->waiters.load(std::memory_order_seq_cst) != 0)
+    {
+        futex(ring->published, FUTEX_WAKE, INT_MAX);
+    }
+#else
+    static_cast<void>(vram);
+#endif
+}
+
+/// @brief Unmaps the frame ring, if any.
+FrameReader::~FrameReader() noexcept
+{
+    close();
+}
+
+/// @brief Maps an existing frame ring, unmapping the previous one if any.
+/// @param name The name of the shared memory object.
+/// @return `false` if there is no valid frame ring with that name.
+auto FrameReader::open(const std::string& name) noexcept -> bool
+{
+    close();
+
+#ifdef __linux__
+    // Waiting takes registering as a waiter, so the mapping is writable.
+    const int fd{ shm_open(name.c_str(), O_RDWR, 0) };
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    const auto length{ lseek(fd, 0, SEEK_END) };
+
+    if (length < static_cast<off_t>(sizeof(FrameRing)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* data{ mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                     0) };
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const auto header{ static_cast<const FrameRing*>(data) };
+    const std::uint64_t available{ static_cast<std::uint64_t>(length) };
+
+    // The slots must hold a frame each and fit in the object. The fields
+    // come from another process, so the checks mustn't overflow either.
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != 1 ||
+        header->slot_count == 0 ||
+        header->slot_size < FrameSlot::PIXEL_OFFSET + sizeof(VRAM) ||
+        header->slot_offset > available ||
+        (available - header->slot_offset) / header->slot_count <
+        header->slot_size)
+    {
+        munmap(data, length);
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    ring = header;
+    size = length;
+
+    return true;
+#else
+    static_cast<void>(name);
+    return false;
+#endif
+}
+
+/// @brief Unmaps the frame ring, if any.
+auto FrameReader::close() noexcept -> void
+{
+#ifdef __linux__
+    if (ring)
+    {
+        munmap(const_cast<FrameRing*>(ring), size);
+    }
+#endif
+    ring = nullptr;
+    size = 0;
+}
+
+/// @brief Waits until a frame other than `seen` has been published.
+/// @param seen The value of `FrameRing::published` last seen.
+/// @param timeout_ms How long to wait for, in milliseconds, or a negative
+/// value to wait forever.
+/// @return The new value of `FrameRing::published`, which is `seen` if the
+/// wait timed out.
+auto FrameReader::wait(const std::uint32_t seen, const int timeout_ms) noexcept
+-> std::uint32_t
+{
+#ifdef __linux__
+    auto& published{ const_cast<FrameRing*>(ring)->published };
+    auto& waiters{ const_cast<FrameRing*>(ring)->waiters };
+
+    auto current{ published.load(std::memory_order_acquire) };
+
+    if (current != seen || timeout_ms == 0)
+    {
+        return current;
+    }
+
+    struct timespec timeout
+    {
+        timeout_ms / 1000,
+        (timeout_ms % 1000) * 1000000L
+    };
+
+    // The producer checks for waiters after publishing, so registering first
+    // and then checking again can't miss a wake up.
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+
+    if (published.load(std::memory_order_seq_cst) == seen)
+    {
+        futex(published, FUTEX_WAIT, seen, timeout_ms < 0 ? nullptr : &timeout);
+    }
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+
+    return published.load(std::memory_order_acquire);
+#else
+    static_cast<void>(timeout_ms);
+    return seen;
+#endif
+}
+
+/// @brief Returns the header of the frame ring.
+auto FrameReader::header() const noexcept -> const FrameRing&
+{
+    return *ring;
+}
+
+/// @brief Returns the slot a frame is published into.
+/// @param frame The number of the frame.
+auto FrameReader::slot(const std::uint64_t frame) const noexcept
+-> const FrameSlot&
+{
+    const auto base{ reinterpret_cast<const Byte*>(ring) + ring->slot_offset };
+
+    return *reinterpret_cast<const FrameSlot*>(
+        base + (((frame - 1) % ring->slot_count) * ring->slot_size));
+}
@@ -12,22 +12,84 @@
 // OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
 // CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
+#include <algorithm>
 #include "gpu.h"
 
 using namespace PlayStation;
 
+/// @brief Initializes the GPU.
+GPU::GPU() noexcept
+{
+    // Nothing has zeroed VRAM yet.
+    vram_dirty.fill(DIRTY_ALL);
+
+    // No command takes more than two parameters, so commands never allocate.
+    cmd.params.reserve(2);
+}
+
 /// @brief Resets the GPU to the startup state.
 auto GPU::reset() noexcept -> void
 {
+    constexpr auto PIXELS_PER_PAGE{ DIRTY_PAGE_SIZE / sizeof(Halfword) };
+
     reset_gp0();
-    vram.fill(0x0000);
+
+    // As with main RAM, only the pages written since the last reset need to
+    // be zeroed.
+    for (std::size_t page{ 0 }; page < VRAM_PAGES; ++page)
+    {
+        if (vram_dirty[page] & DIRTY_RESET)
+        {
+            std::fill_n(&vram[page * PIXELS_PER_PAGE], PIXELS_PER_PAGE, 0x0000);
+            vram_dirty[page] = DIRTY_ALL & ~DIRTY_RESET;
+        }
+    }
 }
 
 /// @brief Resets the GP0 port to accept commands.
 auto GPU::reset_gp0() noexcept -> void
 {
     gp0_state = GP0State::AwaitingCommand;
-    cmd = { };
+
+    // Keep the storage of the parameters for the next command.
+    cmd.params.clear();
+    cmd.command         = Command::None;
+    cmd.remaining_words = 0;
+    cmd.vram_x_pos      = 0;
+    cmd.vram_y_pos      = 0;
+    cmd.vram_x_pos_max  = 0;
+}
+
+/// @brief Returns the index of a pixel in VRAM. Coordinates outside of VRAM
+/// wrap around, as they do on the hardware.
+/// @param x The X coordinate of the pixel.
+/// @param y The Y coordinate of the pixel.
+static auto pixel_index(const int x, const int y) noexcept -> unsigned int
+{
+    return (x & (VRAM_WIDTH - 1)) + (VRAM_WIDTH * (y & (VRAM_HEIGHT - 1)));
+}
+
+/// @brief Reads a pixel from VRAM.
+/// @param x The X coordinate of the pixel, which wraps around.
+/// @param y The Y coordinate of the pixel, which wraps around.
+auto GPU::get_pixel(const int x, const int y) const noexcept -> Halfword
+{
+    return vram[pixel_index(x, y)];
+}
+
+/// @brief Writes a pixel to VRAM, marking its page as dirty.
+/// @param x The X coordinate of the pixel, which wraps around.
+/// @param y The Y coordinate of the pixel, which wraps around.
+/// @param pixel The A1B5G5R5 value to write.
+auto GPU::set_pixel(const int x, const int y, const Halfword pixel) noexcept
+-> void
+{
+    constexpr auto PIXELS_PER_PAGE{ DIRTY_PAGE_SIZE / sizeof(Halfword) };
+
+    const auto index{ pixel_index(x, y) };
+
+    vram[index] = pixel;
+    vram_dirty[index / PIXELS_PER_PAGE] = DIRTY_ALL;
 }
 
 /// @brief Draws a rectangle.
@@ -38,8 +100,7 @@ auto GPU::draw_rect(const Vertex& v0) noexcept -> void
     const unsigned int pixel_g = ((v0.color >> 8) & 0xFF) / 8;
     const unsigned int pixel_b = ((v0.color >> 16) & 0xFF) / 8;
 
-    vram[v0.x + (VRAM_WIDTH * v0.y)] =
-    (pixel_g << 5) | (pixel_b << 10) | pixel_r;
+    set_pixel(v0.x, v0.y, (pixel_g << 5) | (pixel_b << 10) | pixel_r);
 }
 
 /// @brief Converts rectangle command parameters to vertex data, and draws a
@@ -56,6 +117,164 @@ auto GPU::draw_rect_helper() noexcept -> void
     reset_gp0();
 }
 
+/// @brief Runs the current command once all of its parameters have been
+/// received, and again for every data word.
+/// @param data The data word, if any.
+auto GPU::run_command(const Word data) noexcept -> void
+{
+    switch (cmd.command)
+    {
+        case Command::None:
+            break;
+
+        case Command::DrawDot:
+            draw_rect_helper();
+            break;
+
+        case Command::CopyToVRAM:
+            copy_to_vram(data);
+            break;
+
+        case Command::CopyFromVRAM:
+            copy_from_vram(data);
+            break;
+    }
+}
+
+/// @brief Handles GP0(0xA0) - Copy Rectangle (CPU to VRAM).
+/// @param data The data word, if any.
+auto GPU::copy_to_vram(const Word data) noexcept -> void
+{
+    switch (gp0_state)
+    {
+        case GP0State::ReceivingParameters:
+        {
+            const Halfword width =
+            (((cmd.params[1] & 0x0000FFFF) - 1) & 0x000003FF) + 1;
+
+            const Halfword height =
+            (((cmd.params[1] >> 16) - 1) & 0x000001FF) + 1;
+
+            cmd.vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
+            cmd.vram_y_pos = ((cmd.params[0] >> 16) & 0x000001FF);
+
+            cmd.vram_x_pos_max = cmd.vram_x_pos + width;
+
+            cmd.remaining_words = (width * height) / 2;
+
+            // Lock the GP0 state to this command.
+            gp0_state = GP0State::ReceivingData;
+
+            // We don't want to do anything until we receive at least one data
+            // word.
+            return;
+        }
+
+        case GP0State::ReceivingData:
+        {
+            if (cmd.remaining_words != 0)
+            {
+                set_pixel(cmd.vram_x_pos++, cmd.vram_y_pos, data & 0x0000FFFF);
+
+                if (cmd.vram_x_pos >= cmd.vram_x_pos_max)
+                {
+                    cmd.vram_y_pos++;
+                    cmd.vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
+                }
+
+                set_pixel(cmd.vram_x_pos++, cmd.vram_y_pos, data >> 16);
+
+                if (cmd.vram_x_pos >= cmd.vram_x_pos_max)
+                {
+                    cmd.vram_y_pos++;
+                    cmd.vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
+                }
+                cmd.remaining_words--;
+            }
+
+            if (cmd.remaining_words == 0)
+            {
+                // All of the expected data has been sent. Return to normal
+                // operation.
+                reset_gp0();
+            }
+            return;
+        }
+
+        default:
+            return;
+    }
+}
+
+/// @brief Handles GP0(0xC0) - Copy Rectangle (VRAM to CPU).
+/// @param data The data word, if any.
+auto GPU::copy_from_vram(const Word) noexcept -> void
+{
+    switch (gp0_state)
+    {
+        case GP0State::ReceivingParameters:
+        {
+            const Halfword width =
+            (((cmd.params[1] & 0x0000FFFF) - 1) & 0x000003FF) + 1;
+
+            const Halfword height =
+            (((cmd.params[1] >> 16) - 1) & 0x000001FF) + 1;
+
+            cmd.vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
+            cmd.vram_y_pos = ((cmd.params[0] >> 16) & 0x000001FF);
+
+            cmd.vram_x_pos_max = cmd.vram_x_pos + width;
+
+            cmd.remaining_words = (width * height) / 2;
+
+            // Lock the GP0 state to this command.
+            gp0_state = GP0State::TransferringData;
+
+            // We don't want to do anything until we receive at least one data
+            // word.
+            return;
+        }
+
+        case GP0State::TransferringData:
+        {
+            if (cmd.remaining_words != 0)
+            {
+                const Halfword pixel0{ get_pixel(cmd.vram_x_pos++,
+                                                 cmd.vram_y_pos) };
+
+                if (cmd.vram_x_pos >= cmd.vram_x_pos_max)
+                {
+                    cmd.vram_y_pos++;
+                    cmd.vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
+                }
+
+                const Halfword pixel1{ get_pixel(cmd.vram_x_pos++,
+                                                 cmd.vram_y_pos) };
+
+                if (cmd.vram_x_pos >= cmd.vram_x_pos_max)
+                {
+                    cmd.vram_y_pos++;
+                    cmd.vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
+                }
+
+                gpuread = ((pixel1 << 16) | pixel0);
+                cmd.remaining_words--;
+            }
+
+            if (cmd.remaining_words == 0)
+            {
+                // All of the expected data has been sent. Return to normal
+                // operation.
+                reset_gp0();
+            }
+            return;
+        }
+
+        default:
+            return;
+    }
+}
+
 /// @brief Process a GP0 command packet for rendering and VRAM access.
 /// @param packet The GP0 command packet.
 auto GPU::gp0(const Word packet) noexcept -> void
@@ -69,8 +288,7 @@ auto GPU::gp0(const Word packet) noexcept -> void
                 case 0x68:
                     cmd.params.push_back(packet & 0x00FFFFFF);
                     cmd.remaining_words = 1;
-
-                    cmd.func = [this](const Word) { draw_rect_helper(); };
+                    cmd.command = Command::DrawDot;
 
                     gp0_state = GP0State::ReceivingParameters;
                     break;
@@ -78,163 +296,17 @@ auto GPU::gp0(const Word packet) noexcept -> void
                 // GP0(0xA0) - Copy Rectangle (CPU to VRAM)
                 case 0xA0:
                     cmd.remaining_words = 2;
-                    gp0_state = GP0State::ReceivingParameters;
+                    cmd.command = Command::CopyToVRAM;
 
-                    cmd.func = [=](const Word data) noexcept -> void
-                    {
-                        // Current X position
-                        static auto vram_x_pos{ 0 };
-
-                        // Current Y position
-                        static auto vram_y_pos{ 0 };
-
-                        // Maximum length of a line (should be Xxxx+Xsiz)
-                        static auto vram_x_pos_max{ 0 };
-
-                        switch (gp0_state)
-                        {
-                            case GP0State::ReceivingParameters:
-                            {
-                                const Halfword width =
-                                (((cmd.params[1] & 0x0000FFFF) - 1) & 0x000003FF) + 1;
-
-                                const Halfword height =
-                                (((cmd.params[1] >> 16) - 1) & 0x000001FF) + 1;
-
-                                vram_x_pos =
-                                ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
-
-                                vram_y_pos =
-                                ((cmd.params[0] >> 16) & 0x000001FF);
-
-                                vram_x_pos_max = vram_x_pos + width;
-
-                                cmd.remaining_words = (width * height) / 2;
-
-                                // Lock the GP0 state to this function.
-                                gp0_state = GP0State::ReceivingData;
-
-                                // We don't want to do anything until we
-                                // receive at least one data word.
-                                return;
-                            }
-
-                            case GP0State::ReceivingData:
-                            {
-                                if (cmd.remaining_words != 0)
-                                {
-                                    vram[vram_x_pos++ + (VRAM_WIDTH * vram_y_pos)] =
-                                    data & 0x0000FFFF;
-
-                                    if (vram_x_pos >= vram_x_pos_max)
-                                    {
-                                        vram_y_pos++;
-                                        vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
-                                    }
-
-                                    vram[vram_x_pos++ + (VRAM_WIDTH * vram_y_pos)] =
-                                    data >> 16;
-
-                                    if (vram_x_pos >= vram_x_pos_max)
-                                    {
-                                        vram_y_pos++;
-                                        vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
-                                    }
-                                    cmd.remaining_words--;
-                                }
-
-                                if (cmd.remaining_words == 0)
-                                {
-                                    // All of the expected data has been sent. Return to normal
-                                    // operation.
-                                    reset_gp0();
-                                }
-                                return;
-                            }
-                        }
-                    };
+                    gp0_state = GP0State::ReceivingParameters;
                     break;
 
                 // GP0(0xC0) - Copy Rectangle(VRAM to CPU)
                 case 0xC0:
                     cmd.remaining_words = 2;
-                    gp0_state = GP0State::ReceivingParameters;
+                    cmd.command = Command::CopyFromVRAM;
 
-                    cmd.func = [=](const Word data) noexcept -> void
-                    {
-                        // Current X position
-                        static auto vram_x_pos{ 0 };
-
-                        // Current Y position
-                        static auto vram_y_pos{ 0 };
-
-                        // Maximum length of a line (should be Xxxx+Xsiz)
-                        static auto vram_x_pos_max{ 0 };
-
-                        switch (gp0_state)
-                        {
-                            case GP0State::ReceivingParameters:
-                            {
-                                const Halfword width =
-                                (((cmd.params[1] & 0x0000FFFF) - 1) & 0x000003FF) + 1;
-
-                                const Halfword height =
-                                (((cmd.params[1] >> 16) - 1) & 0x000001FF) + 1;
-
-                                vram_x_pos =
-                                ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
-
-                                vram_y_pos =
-                                ((cmd.params[0] >> 16) & 0x000001FF);
-
-                                vram_x_pos_max = vram_x_pos + width;
-
-                                cmd.remaining_words = (width * height) / 2;
-
-                                // Lock the GP0 state to this function.
-                                gp0_state = GP0State::TransferringData;
-
-                                // We don't want to do anything until we
-                                // receive at least one data word.
-                                return;
-                            }
-
-                            case GP0State::TransferringData:
-                            {
-                                if (cmd.remaining_words != 0)
-                                {
-                                    const uint16_t pixel0 =
-                                    vram[vram_x_pos++ + (VRAM_WIDTH * vram_y_pos)];
-
-                                    if (vram_x_pos >= vram_x_pos_max)
-                                    {
-                                        vram_y_pos++;
-                                        vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
-                                    }
-                                         
-                                    const Halfword pixel1 =
-                                    vram[vram_x_pos++ + (VRAM_WIDTH * vram_y_pos)];
-
-                                    if (vram_x_pos >= vram_x_pos_max)
-                                    {
-                                        vram_y_pos++;
-                                        vram_x_pos = ((cmd.params[0] & 0x0000FFFF) & 0x000003FF);
-                                    }
-
-                                    gpuread = ((pixel1 << 16) | pixel0);
-                                    cmd.remaining_words--;
-                                }
-
-                                if (cmd.remaining_words == 0)
-                                {
-                                    // All of the expected data has been sent.
-                                    // Return to normal operation.
-                                    reset_gp0();
-                                }
-                                return;
-                            }
-                        }
-                    };
+                    gp0_state = GP0State::ReceivingParameters;
                     break;
 
                 default:
@@ -248,13 +320,13 @@ auto GPU::gp0(const Word packet) noexcept -> void
 
             if (cmd.remaining_words == 0)
             {
-                cmd.func(0);
+                run_command(0);
             }
             break;
 
         case GP0State::ReceivingData:
         case GP0State::TransferringData:
-            cmd.func(packet);
+            run_command(packet);
             break;
     }
 }
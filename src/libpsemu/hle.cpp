@@ -0,0 +1,982 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "bus.h"
+#include "cpu.h"
+#include "hle.h"
+
+using namespace PlayStation;
+
+/// @brief Conventional register numbers used by the kernel calling convention.
+enum Register
+{
+    V0 = 2,
+    A0 = 4,
+    A1 = 5,
+    A2 = 6,
+    A3 = 7,
+    T1 = 9,
+    SP = 29,
+    FP = 30,
+    RA = 31
+};
+
+/// @brief Initializes the HLE layer and hooks the kernel function vectors.
+/// @param c The CPU instance.
+/// @param b The system bus instance.
+HLE::HLE(CPU& c, SystemBus& b) noexcept : cpu(c), bus(b)
+{
+    for (const Word vector : { 0x000000A0, 0x000000B0, 0x000000C0 })
+    {
+        bus.hooks.add_breakpoint(vector, [=](const Word)
+        {
+            return dispatch(vector);
+        });
+    }
+
+    bus.hooks.add_breakpoint(EXIT_ADDRESS, [this](const Word)
+    {
+        if (!bios_free)
+        {
+            return HookAction::Continue;
+        }
+
+        has_exited      = true;
+        guest_exit_code = cpu.gpr[V0];
+
+        return HookAction::Break;
+    });
+
+    // The string and memory routines are self-contained, so they're safe to
+    // replace by default. rand() and the C0 functions share state with the
+    // rest of the kernel, and are left to the BIOS unless asked for.
+    replaced[Strcmp]  = true;
+    replaced[Strncmp] = true;
+    replaced[Strcpy]  = true;
+    replaced[Strlen]  = true;
+    replaced[Bzero]   = true;
+    replaced[Memcpy]  = true;
+    replaced[Memset]  = true;
+
+    reset();
+}
+
+/// @brief Resets the HLE layer to the startup state.
+auto HLE::reset() noexcept -> void
+{
+    for (const auto& verification : pending)
+    {
+        bus.hooks.remove(verification.hook);
+    }
+
+    pending.clear();
+    failures = 0;
+
+    bios_free       = false;
+    has_exited      = false;
+    guest_exit_code = 0;
+
+    seed = 0x00000000;
+}
+
+/// @brief Installs a minimal kernel into main RAM, for running programs
+/// without the BIOS.
+auto HLE::install_kernel() noexcept -> void
+{
+    const auto code = [&](Word vaddr, std::initializer_list<Word> words)
+    {
+        for (const auto word : words)
+        {
+            write_word(vaddr, word);
+            vaddr += 4;
+        }
+    };
+
+    // Exception handler: return to the instruction after the one that caused
+    // the exception. This makes SYSCALL, and thus the critical section
+    // functions, into no-ops.
+    code(0x80000080,
+    {
+        0x401A7000, // mfc0  $k0, EPC
+        0x00000000, // nop
+        0x275A0004, // addiu $k0, $k0, 4
+        0x03400008, // jr    $k0
+        0x42000010  // rfe
+    });
+
+    // Vectors and dispatchers, these mirror the BIOS: the function number in
+    // $t1 indexes a table of function pointers.
+    struct Vector
+    {
+        Word vector;
+        Word dispatcher;
+        Word table;
+        Word entries;
+    };
+
+    constexpr Word stub{ 0x80000560 };
+
+    for (const auto& v : { Vector{ 0x800000A0, 0x80000500, 0x200, 0xC0 },
+                           Vector{ 0x800000B0, 0x80000520, 0x874, 0x60 },
+                           Vector{ 0x800000C0, 0x80000540, 0x674, 0x20 } })
+    {
+        code(v.vector,
+        {
+            0x08000000 | ((v.dispatcher & 0x0FFFFFFF) >> 2), // j dispatcher
+            0x00000000                                       // nop
+        });
+
+        code(v.dispatcher,
+        {
+            0x24080000 | v.table, // addiu $t0, $zero, table
+            0x00095080,           // sll   $t2, $t1, 2
+            0x010A4021,           // addu  $t0, $t0, $t2
+            0x8D080000,           // lw    $t0, 0($t0)
+            0x00000000,           // nop
+            0x01000008,           // jr    $t0
+            0x00000000            // nop
+        });
+
+        for (Word entry{ 0 }; entry < v.entries; ++entry)
+        {
+            write_word(v.table + (entry * 4), stub);
+        }
+    }
+
+    // Functions we don't know anything about return 0.
+    code(stub,
+    {
+        0x03E00008, // jr   $ra
+        0x00001021  // move $v0, $zero
+    });
+
+    // Programs return here. This is hooked, but spin just in case.
+    code(EXIT_ADDRESS,
+    {
+        0x0800015C, // j   EXIT_ADDRESS
+        0x00000000  // nop
+    });
+
+    bios_free  = true;
+    has_exited = false;
+}
+
+/// @brief Determines if the guest has exited, either by returning to
+/// `EXIT_ADDRESS` or calling exit(). This is only tracked when the minimal
+/// kernel is installed.
+auto HLE::exited() const noexcept -> bool
+{
+    return has_exited;
+}
+
+/// @brief Returns the exit code of the guest, if it has exited.
+auto HLE::exit_code() const noexcept -> Word
+{
+    return guest_exit_code;
+}
+
+/// @brief Enables or disables the native replacement of a function.
+/// @param function The function to toggle.
+/// @param enabled Whether or not to replace it.
+auto HLE::enable(const Function function, const bool enabled) noexcept -> void
+{
+    replaced[function] = enabled;
+}
+
+/// @brief Determines if a function is natively replaced.
+/// @param function The function to check.
+auto HLE::enabled(const Function function) const noexcept -> bool
+{
+    return replaced[function];
+}
+
+/// @brief Enables or disables verification mode.
+/// @param enabled Whether or not to verify.
+auto HLE::set_verify(const bool enabled) noexcept -> void
+{
+    verify = enabled;
+}
+
+/// @brief Returns the number of mismatches found in verification mode.
+auto HLE::verify_failures() const noexcept -> unsigned int
+{
+    return failures;
+}
+
+/// @brief Returns the name of a replaceable function.
+/// @param function The function to name.
+auto HLE::name(const Function function) noexcept -> const char*
+{
+    switch (function)
+    {
+        case Strcmp:      return "strcmp";
+        case Strncmp:     return "strncmp";
+        case Strcpy:      return "strcpy";
+        case Strlen:      return "strlen";
+        case Bzero:       return "bzero";
+        case Memcpy:      return "memcpy";
+        case Memset:      return "memset";
+        case Rand:        return "rand";
+        case SysEnqIntRP: return "SysEnqIntRP";
+        case SysDeqIntRP: return "SysDeqIntRP";
+        default:          return "unknown";
+    }
+}
+
+/// @brief Dispatches a call to one of the kernel function vectors.
+/// @param vector The vector that was called (0xA0, 0xB0 or 0xC0).
+auto HLE::dispatch(const Word vector) noexcept -> HookAction
+{
+    const Word number{ cpu.gpr[T1] };
+
+    if (bios_free)
+    {
+        if (kernel_call(vector, number))
+        {
+            cpu.set_pc(cpu.gpr[RA]);
+            return HookAction::Skip;
+        }
+    }
+    else if ((vector == 0xA0 && number == 0x3C) ||
+             (vector == 0xB0 && number == 0x3D))
+    {
+        if (on_putchar)
+        {
+            on_putchar(static_cast<char>(cpu.gpr[A0]));
+        }
+        return HookAction::Continue;
+    }
+
+    const auto function{ lookup(vector, number) };
+
+    // There's no BIOS to fall back to without it, so everything we know is
+    // replaced in that case.
+    if (function == FunctionCount || (!bios_free && !replaced[function]))
+    {
+        return HookAction::Continue;
+    }
+
+    if (verify && !bios_free)
+    {
+        start_verification(function);
+        return HookAction::Continue;
+    }
+
+    Word v0{ cpu.gpr[V0] };
+
+    if (!call(function, v0))
+    {
+        return HookAction::Continue;
+    }
+
+    cpu.gpr[V0] = v0;
+    cpu.set_pc(cpu.gpr[RA]);
+
+    return HookAction::Skip;
+}
+
+/// @brief Determines which function a vector and $t1 refer to.
+/// @param vector The vector that was called (0xA0, 0xB0 or 0xC0).
+/// @param number The function number passed in $t1.
+/// @return The function, or `FunctionCount` if none.
+auto HLE::lookup(const Word vector, const Word number) noexcept -> Function
+{
+    switch (vector)
+    {
+        case 0xA0:
+            switch (number)
+            {
+                case 0x17: return Strcmp;
+                case 0x18: return Strncmp;
+                case 0x19: return Strcpy;
+                case 0x1B: return Strlen;
+                case 0x28: return Bzero;
+                case 0x2A: return Memcpy;
+                case 0x2B: return Memset;
+                case 0x2F: return Rand;
+                case 0x30: return Rand;
+                default:   return FunctionCount;
+            }
+
+        case 0xC0:
+            switch (number)
+            {
+                case 0x02: return SysEnqIntRP;
+                case 0x03: return SysDeqIntRP;
+                default:   return FunctionCount;
+            }
+
+        default:
+            return FunctionCount;
+    }
+}
+
+/// @brief Handles the kernel functions that only need to be emulated when the
+/// minimal kernel is installed.
+/// @param vector The vector that was called (0xA0, 0xB0 or 0xC0).
+/// @param number The function number passed in $t1.
+/// @return `true` if the call was handled.
+auto HLE::kernel_call(const Word vector, const Word number) noexcept -> bool
+{
+    const auto print = [&](const Word vaddr)
+    {
+        Word length;
+
+        if (on_putchar && string_length(vaddr, length))
+        {
+            const auto str{ ram_ptr(vaddr, length) };
+
+            for (Word index{ 0 }; index < length; ++index)
+            {
+                on_putchar(static_cast<char>(str[index]));
+            }
+        }
+    };
+
+    switch ((vector << 8) | number)
+    {
+        // A(06h) or B(38h) - exit(exitcode)
+        case 0xA006:
+        case 0xB038:
+            // We return to the exit address, which will stop execution.
+            cpu.gpr[V0] = cpu.gpr[A0];
+            cpu.gpr[RA] = EXIT_ADDRESS;
+
+            return true;
+
+        // A(3Ch) or B(3Dh) - putchar(char)
+        case 0xA03C:
+        case 0xB03D:
+            if (on_putchar)
+            {
+                on_putchar(static_cast<char>(cpu.gpr[A0]));
+            }
+
+            cpu.gpr[V0] = cpu.gpr[A0];
+            return true;
+
+        // A(3Eh) or B(3Fh) - puts(src)
+        case 0xA03E:
+        case 0xB03F:
+            print(cpu.gpr[A0]);
+
+            if (on_putchar)
+            {
+                on_putchar('\n');
+            }
+            return true;
+
+        // A(3Fh) - printf(txt, param1, param2, etc.)
+        case 0xA03F:
+            print_formatted();
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/// @brief Formats and prints a string as printf() would, taking the format
+/// string from $a0 and the arguments following it.
+auto HLE::print_formatted() noexcept -> void
+{
+    Word length;
+
+    if (!on_putchar || !string_length(cpu.gpr[A0], length))
+    {
+        return;
+    }
+
+    const auto format{ reinterpret_cast<const char*>(ram_ptr(cpu.gpr[A0],
+                                                             length)) };
+    Word arg_index{ 1 };
+
+    // Arguments follow the o32 calling convention: the first four are in
+    // $a0-$a3, the rest are on the stack after the space reserved for those.
+    const auto next_arg = [&]() -> Word
+    {
+        const Word index{ arg_index++ };
+
+        switch (index)
+        {
+            case 1:  return cpu.gpr[A1];
+            case 2:  return cpu.gpr[A2];
+            case 3:  return cpu.gpr[A3];
+            default: return read_word(cpu.gpr[SP] + (index * 4));
+        }
+    };
+
+    const auto emit = [&](const char* str, const int size)
+    {
+        for (auto index{ 0 }; index < size; ++index)
+        {
+            on_putchar(str[index]);
+        }
+    };
+
+    for (Word index{ 0 }; index < length; ++index)
+    {
+        if (format[index] != '%')
+        {
+            on_putchar(format[index]);
+            continue;
+        }
+
+        // Rebuild the conversion specification for the host's snprintf(),
+        // substituting `*` with the argument and dropping length modifiers
+        // since every argument is 32 bits wide anyway. Whatever doesn't fit
+        // is dropped, always leaving room for the conversion and the NUL.
+        char spec[32]{ '%' };
+        std::size_t spec_length{ 1 };
+
+        constexpr auto SPEC_LIMIT{ sizeof(spec) - 2 };
+
+        for (++index; index < length; ++index)
+        {
+            const char c{ format[index] };
+
+            if (c == '*')
+            {
+                // The argument is consumed even if it doesn't fit.
+                char number[16];
+                const auto digits
+                {
+                    static_cast<std::size_t>(
+                    std::snprintf(number,
+                                  sizeof(number),
+                                  "%d",
+                                  static_cast<int>(next_arg())))
+                };
+
+                if (digits <= SPEC_LIMIT - spec_length)
+                {
+                    std::memcpy(&spec[spec_length], number, digits);
+                    spec_length += digits;
+                }
+            }
+            else if (c == 'l' || c == 'h')
+            {
+                continue;
+            }
+            else if (std::strchr("-+ #0123456789.", c) &&
+                     spec_length < SPEC_LIMIT)
+            {
+                spec[spec_length++] = c;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (index >= length)
+        {
+            break;
+        }
+
+        const char conversion{ format[index] };
+
+        if (spec_length > SPEC_LIMIT)
+        {
+            break;
+        }
+
+        spec[spec_length++] = conversion;
+        spec[spec_length]   = '\0';
+
+        char output[512];
+        auto size{ 0 };
+
+        switch (conversion)
+        {
+            case 'd':
+            case 'i':
+                size = std::snprintf(output,
+                                     sizeof(output),
+                                     spec,
+                                     static_cast<SignedWord>(next_arg()));
+                break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                size = std::snprintf(output, sizeof(output), spec, next_arg());
+                break;
+
+            case 'p':
+                spec[spec_length - 1] = 'x';
+                size = std::snprintf(output, sizeof(output), spec, next_arg());
+                break;
+
+            case 's':
+            {
+                const Word vaddr{ next_arg() };
+                Word str_length;
+
+                const char* str
+                {
+                    string_length(vaddr, str_length) ?
+                    reinterpret_cast<const char*>(ram_ptr(vaddr, str_length)) :
+                    "(null)"
+                };
+
+                size = std::snprintf(output, sizeof(output), spec, str);
+                break;
+            }
+
+            case '%':
+                output[0] = '%';
+                size = 1;
+
+                break;
+
+            default:
+                // Unknown conversion, print it as-is.
+                emit(spec, static_cast<int>(spec_length));
+                continue;
+        }
+
+        emit(output, std::min(size, static_cast<int>(sizeof(output)) - 1));
+    }
+}
+
+/// @brief Runs the native replacement of a function.
+/// @param function The function to run.
+/// @param v0 Where to store the return value.
+/// @return `false` if the arguments can't be handled natively, in which case
+/// nothing has been changed and the BIOS routine must run instead.
+auto HLE::call(const Function function, Word& v0) noexcept -> bool
+{
+    const Word a0{ cpu.gpr[A0] };
+    const Word a1{ cpu.gpr[A1] };
+    const Word a2{ cpu.gpr[A2] };
+
+    // The BIOS handles NULL pointers and non-positive lengths in its own
+    // peculiar ways. Those are rare, so we simply let the BIOS deal with
+    // them rather than trying to replicate every quirk.
+    switch (function)
+    {
+        case Strcmp:
+        case Strncmp:
+        {
+            if (a0 == 0 || a1 == 0 ||
+               (function == Strncmp && static_cast<SignedWord>(a2) <= 0))
+            {
+                return false;
+            }
+
+            const auto max_length
+            {
+                function == Strncmp ? a2 : 0xFFFFFFFF
+            };
+
+            Word len1;
+            Word len2;
+
+            if (!string_length(a0, len1) || !string_length(a1, len2))
+            {
+                return false;
+            }
+
+            const auto str1{ ram_ptr(a0, len1 + 1) };
+            const auto str2{ ram_ptr(a1, len2 + 1) };
+
+            v0 = 0;
+
+            for (Word index{ 0 }; index < max_length; ++index)
+            {
+                const auto c1{ static_cast<SignedByte>(str1[index]) };
+                const auto c2{ static_cast<SignedByte>(str2[index]) };
+
+                if (c1 != c2)
+                {
+                    v0 = c1 - c2;
+                    break;
+                }
+
+                if (c1 == 0)
+                {
+                    break;
+                }
+            }
+            return true;
+        }
+
+        case Strcpy:
+        {
+            Word length;
+
+            if (a0 == 0 || a1 == 0 || !string_length(a1, length))
+            {
+                return false;
+            }
+
+            const Word dst_paddr{ a0 & 0x1FFFFFFF };
+            const Word src_paddr{ a1 & 0x1FFFFFFF };
+
+            // Same as memcpy(), overlapping copies are left to the BIOS.
+            if (dst_paddr <= src_paddr + length &&
+                src_paddr <= dst_paddr + length)
+            {
+                return false;
+            }
+
+            const auto dst{ writable(a0, length + 1) };
+
+            if (!dst)
+            {
+                return false;
+            }
+
+            std::memcpy(dst, ram_ptr(a1, length + 1), length + 1);
+            v0 = a0;
+
+            return true;
+        }
+
+        case Strlen:
+            if (a0 == 0 || !string_length(a0, v0))
+            {
+                return false;
+            }
+            return true;
+
+        case Bzero:
+        case Memset:
+        {
+            const auto length{ function == Bzero ? a1 : a2 };
+            const auto fill{ function == Bzero ? 0x00 : (a1 & 0x000000FF) };
+
+            if (a0 == 0 || static_cast<SignedWord>(length) <= 0)
+            {
+                return false;
+            }
+
+            const auto dst{ writable(a0, length) };
+
+            if (!dst)
+            {
+                return false;
+            }
+
+            std::memset(dst, fill, length);
+            v0 = a0;
+
+            return true;
+        }
+
+        case Memcpy:
+        {
+            if (a0 == 0 || a1 == 0 || static_cast<SignedWord>(a2) <= 0)
+            {
+                return false;
+            }
+
+            const auto src{ ram_ptr(a1, a2) };
+
+            // How the BIOS copies overlapping areas is its own business.
+            if (!src || ((a0 & 0x1FFFFFFF) < (a1 & 0x1FFFFFFF) + a2 &&
+                         (a1 & 0x1FFFFFFF) < (a0 & 0x1FFFFFFF) + a2))
+            {
+                return false;
+            }
+
+            const auto dst{ writable(a0, a2) };
+
+            if (!dst)
+            {
+                return false;
+            }
+
+            std::memcpy(dst, src, a2);
+            v0 = a0;
+            return true;
+        }
+
+        case Rand:
+            if (cpu.gpr[T1] == 0x30)
+            {
+                // A(30h) - srand(seed)
+                seed = a0;
+                return true;
+            }
+
+            // A(2Fh) - rand()
+            seed = (seed * 0x41C64E6D) + 0x00003039;
+            v0   = (seed >> 16) & 0x00007FFF;
+
+            return true;
+
+        case SysEnqIntRP:
+        case SysDeqIntRP:
+        {
+            // [0x100] points to the exception control blocks, which contain
+            // the first handler of each priority chain (0..3) every 8 bytes.
+            const Word table{ read_word(0x00000100) };
+
+            if (a0 > 3 || a1 == 0 ||
+                !ram_ptr(table, 32) || !ram_ptr(a1, 4))
+            {
+                return false;
+            }
+
+            const Word head{ table + (a0 * 8) };
+
+            if (function == SysEnqIntRP)
+            {
+                // The new handler is inserted at the beginning of the chain.
+                const Word first{ read_word(head) };
+
+                if (!writable(a1, 4) || !writable(head, 4))
+                {
+                    return false;
+                }
+
+                write_word(a1, first);
+                write_word(head, a1);
+
+                v0 = 0;
+                return true;
+            }
+
+            // Find the link pointing to the handler, and unlink it.
+            Word link{ head };
+
+            for (auto handlers{ 0 }; handlers < 256; ++handlers)
+            {
+                const Word next{ read_word(link) };
+
+                if (next == a1)
+                {
+                    if (!writable(link, 4))
+                    {
+                        return false;
+                    }
+
+                    write_word(link, read_word(a1));
+
+                    v0 = 0;
+                    return true;
+                }
+
+                if (next == 0 || !ram_ptr(next, 4))
+                {
+                    break;
+                }
+                link = next;
+            }
+            return false;
+        }
+
+        default:
+            return false;
+    }
+}
+
+/// @brief Starts verifying a BIOS routine against its native replacement.
+/// @param function The function being called.
+auto HLE::start_verification(const Function function) noexcept -> void
+{
+    const Word saved_seed{ seed };
+    Word v0{ cpu.gpr[V0] };
+
+    journal.clear();
+    journaling = true;
+
+    const bool handled{ call(function, v0) };
+
+    journaling = false;
+    seed = saved_seed;
+
+    if (!handled)
+    {
+        return;
+    }
+
+    Verification verification;
+
+    verification.function = function;
+    verification.returns  = !(function == Rand && cpu.gpr[T1] == 0x30);
+    verification.v0       = v0;
+    verification.ra       = cpu.gpr[RA];
+    verification.sp       = cpu.gpr[SP];
+
+    // Record what the native replacement did, then undo it so that the BIOS
+    // starts from the same state. Areas can overlap, so all of them are
+    // recorded first and then restored in reverse order.
+    for (auto& area : journal)
+    {
+        const auto data{ ram_ptr(area.vaddr, area.before.size()) };
+        area.after.assign(data, data + area.before.size());
+    }
+
+    for (auto area{ journal.rbegin() }; area != journal.rend(); ++area)
+    {
+        std::memcpy(ram_ptr(area->vaddr, area->before.size()),
+                    area->before.data(),
+                    area->before.size());
+    }
+
+    verification.areas = std::move(journal);
+    journal = { };
+
+    verification.hook = bus.hooks.add_breakpoint(verification.ra,
+    [this](const Word paddr)
+    {
+        return check(paddr);
+    });
+
+    pending.push_back(std::move(verification));
+}
+
+/// @brief Checks a BIOS routine that has returned against its pending
+/// verification.
+/// @param paddr The physical address that was returned to.
+auto HLE::check(const Word paddr) noexcept -> HookAction
+{
+    // Search from the most recent call, so nested calls are matched first.
+    for (auto entry{ pending.rbegin() }; entry != pending.rend(); ++entry)
+    {
+        if ((entry->ra & 0x1FFFFFFF) != paddr || entry->sp != cpu.gpr[SP])
+        {
+            continue;
+        }
+
+        bool matches{ !entry->returns || entry->v0 == cpu.gpr[V0] };
+
+        for (const auto& area : entry->areas)
+        {
+            const auto data{ ram_ptr(area.vaddr, area.after.size()) };
+
+            if (std::memcmp(data, area.after.data(), area.after.size()) != 0)
+            {
+                matches = false;
+            }
+        }
+
+        if (!matches)
+        {
+            failures++;
+            printf("HLE: %s mismatch (returned to 0x%08X, BIOS $v0=0x%08X, "
+                   "native $v0=0x%08X)\n",
+                   name(entry->function),
+                   entry->ra,
+                   cpu.gpr[V0],
+                   entry->v0);
+        }
+
+        bus.hooks.remove(entry->hook);
+        pending.erase(std::next(entry).base());
+
+        break;
+    }
+    return HookAction::Continue;
+}
+
+/// @brief Returns a pointer into main RAM for a guest address range.
+/// @param vaddr The first guest address.
+/// @param length The number of bytes that will be accessed.
+/// @return The pointer, or `nullptr` if the range is not entirely within main
+/// RAM.
+auto HLE::ram_ptr(const Word vaddr, const Word length) noexcept -> Byte*
+{
+    const Word paddr{ vaddr & 0x1FFFFFFF };
+
+    if (paddr >= RAM_SIZE || length > RAM_SIZE - paddr)
+    {
+        return nullptr;
+    }
+    return &bus.ram.data()[paddr];
+}
+
+/// @brief Same as `ram_ptr()`, but for areas that the native replacement is
+/// about to write to. In verification mode, the current contents are recorded
+/// so they can be restored afterwards.
+/// @param vaddr The first guest address.
+/// @param length The number of bytes that will be written.
+auto HLE::writable(const Word vaddr, const Word length) noexcept -> Byte*
+{
+    const auto data{ ram_ptr(vaddr, length) };
+
+    if (data)
+    {
+        bus.mark_dirty(vaddr & 0x1FFFFFFF, length);
+
+        if (journaling)
+        {
+            journal.push_back({ vaddr, { data, data + length }, { } });
+        }
+    }
+    return data;
+}
+
+/// @brief Computes the length of a NUL-terminated guest string.
+/// @param vaddr The address of the string.
+/// @param length Where to store the length, excluding the NUL.
+/// @return `false` if the string runs outside of main RAM.
+auto HLE::string_length(const Word vaddr, Word& length) noexcept -> bool
+{
+    const Word paddr{ vaddr & 0x1FFFFFFF };
+
+    if (paddr >= RAM_SIZE)
+    {
+        return false;
+    }
+
+    const auto start{ &bus.ram.data()[paddr] };
+    const auto end{ static_cast<const Byte*>(std::memchr(start,
+                                                         0,
+                                                         RAM_SIZE - paddr)) };
+
+    if (!end)
+    {
+        return false;
+    }
+
+    length = end - start;
+    return true;
+}
+
+/// @brief Reads a word from main RAM.
+/// @param vaddr The guest address to read.
+auto HLE::read_word(const Word vaddr) noexcept -> Word
+{
+    Word data{ 0 };
+    const auto src{ ram_ptr(vaddr, sizeof(Word)) };
+
+    if (src)
+    {
+        std::memcpy(&data, src, sizeof(Word));
+    }
+    return data;
+}
+
+/// @brief Writes a word to main RAM.
+/// @param vaddr The guest address to write.
+/// @param data The word to write.
+auto HLE::write_word(const Word vaddr, const Word data) noexcept -> void
+{
+    const auto dst{ ram_ptr(vaddr, sizeof(Word)) };
+
+    if (dst)
+    {
+        std::memcpy(dst, &data, sizeof(Word));
+        bus.mark_dirty(vaddr & 0x1FFFFFFF, sizeof(Word));
+    }
+}
@@ -0,0 +1,175 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include "hooks.h"
+
+using namespace PlayStation;
+
+/// @brief Registers a PC breakpoint.
+/// @param vaddr The address of the instruction to hook.
+/// @param hook The function to call when the address is reached.
+/// @return A handle that can be passed to `remove()`.
+auto Hooks::add_breakpoint(const Word vaddr, PCHook hook) noexcept -> Handle
+{
+    const Handle handle{ next_handle++ };
+
+    breakpoints.push_back({ handle, vaddr & 0x1FFFFFFF, std::move(hook) });
+    pc_pages[page(vaddr)] = true;
+
+    return handle;
+}
+
+/// @brief Registers a memory watchpoint.
+/// @param vaddr The first address of the area to watch.
+/// @param length The number of bytes to watch.
+/// @param type The accesses to trigger on.
+/// @param hook The function to call when the area is accessed.
+/// @return A handle that can be passed to `remove()`.
+auto Hooks::add_watchpoint(const Word vaddr,
+                           const Word length,
+                           const WatchType type,
+                           WatchHook hook) noexcept -> Handle
+{
+    const Handle handle{ next_handle++ };
+    const Word paddr{ vaddr & 0x1FFFFFFF };
+
+    watchpoints.push_back({ handle, paddr, length, type, std::move(hook) });
+    rebuild_pages();
+
+    return handle;
+}
+
+/// @brief Removes a previously registered hook.
+/// @param handle The handle returned when the hook was registered.
+auto Hooks::remove(const Handle handle) noexcept -> void
+{
+    breakpoints.erase(std::remove_if(breakpoints.begin(),
+                                     breakpoints.end(),
+                                     [=](const Breakpoint& bp)
+                                     {
+                                         return bp.handle == handle;
+                                     }),
+                      breakpoints.end());
+
+    watchpoints.erase(std::remove_if(watchpoints.begin(),
+                                     watchpoints.end(),
+                                     [=](const Watchpoint& wp)
+                                     {
+                                         return wp.handle == handle;
+                                     }),
+                      watchpoints.end());
+    rebuild_pages();
+}
+
+/// @brief Removes all registered hooks.
+auto Hooks::clear() noexcept -> void
+{
+    breakpoints.clear();
+    watchpoints.clear();
+
+    rebuild_pages();
+}
+
+/// @brief Runs the PC hooks registered at an address.
+/// @param vaddr The address of the instruction about to be executed.
+/// @return The most restrictive action requested by the hooks.
+auto Hooks::on_execute(const Word vaddr) noexcept -> HookAction
+{
+    const Word paddr{ vaddr & 0x1FFFFFFF };
+    auto action{ HookAction::Continue };
+
+    // Hooks are allowed to register or remove hooks themselves, so we can't
+    // hold on to iterators here.
+    for (std::size_t index{ 0 }; index < breakpoints.size(); ++index)
+    {
+        if (breakpoints[index].paddr == paddr)
+        {
+            // `Break` takes precedence over `Skip`, which takes precedence
+            // over `Continue`. The callback is copied in case it removes
+            // itself.
+            const auto hook{ breakpoints[index].hook };
+            action = std::max(action, hook(paddr));
+        }
+    }
+    return action;
+}
+
+/// @brief Runs the watchpoints covering a memory access.
+/// @param paddr The physical address of the access.
+/// @param data The data that was read or is about to be written.
+/// @param size The width of the access, in bytes.
+/// @param type Whether this is a read or a write.
+auto Hooks::on_access(const Word paddr,
+                      const Word data,
+                      const unsigned int size,
+                      const WatchType type) noexcept -> void
+{
+    // Like PC hooks, watchpoints are allowed to register or remove hooks
+    // themselves.
+    for (std::size_t index{ 0 }; index < watchpoints.size(); ++index)
+    {
+        const auto& wp{ watchpoints[index] };
+
+        if ((static_cast<int>(wp.type) & static_cast<int>(type)) == 0)
+        {
+            continue;
+        }
+
+        // Does the access overlap the watched area? The callback is copied
+        // in case it removes itself.
+        if (paddr < wp.paddr + wp.length && wp.paddr < paddr + size)
+        {
+            const auto hook{ wp.hook };
+            hook(paddr, data, size, type);
+        }
+    }
+}
+
+/// @brief Recomputes the page bitmaps after the set of hooks has changed.
+auto Hooks::rebuild_pages() noexcept -> void
+{
+    pc_pages.reset();
+    read_pages.reset();
+    write_pages.reset();
+
+    for (const auto& bp : breakpoints)
+    {
+        pc_pages[page(bp.paddr)] = true;
+    }
+
+    for (const auto& wp : watchpoints)
+    {
+        if (wp.length == 0)
+        {
+            continue;
+        }
+
+        const Word last{ std::min<Word>(wp.paddr + wp.length - 1,
+                                        0x1FFFFFFF) };
+
+        for (auto index{ page(wp.paddr) }; index <= page(last); ++index)
+        {
+            if (static_cast<int>(wp.type) & static_cast<int>(WatchType::Read))
+            {
+                read_pages[index] = true;
+            }
+
+            if (static_cast<int>(wp.type) & static_cast<int>(WatchType::Write))
+            {
+                write_pages[index] = true;
+            }
+        }
+    }
+}
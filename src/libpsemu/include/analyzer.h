@@ -0,0 +1,214 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "disasm.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a static analyzer, which recovers the functions, basic
+    /// blocks and calls of a program from an image of its memory.
+    ///
+    /// Code is found by recursive descent: starting from the entry points,
+    /// every branch, jump and call target is followed, so that data mixed in
+    /// with the code is never mistaken for instructions. Calls through `jal`
+    /// make their targets functions of their own. Indirect jumps (`jr` with a
+    /// register other than $ra) are followed when they can be traced back to
+    /// a jump table, as compilers emit for `switch` statements.
+    class Analyzer final
+    {
+    public:
+        /// @brief Defines a sequence of instructions with a single entry and
+        /// a single exit.
+        struct Block
+        {
+            /// @brief Address of the first instruction
+            Word start;
+
+            /// @brief Address past the last instruction, including the delay
+            /// slot of the jump or branch ending the block
+            Word end;
+
+            /// @brief Blocks control may continue with. Calls are not
+            /// included, but the instruction they return to is.
+            std::vector<Word> successors;
+        };
+
+        /// @brief Defines a function, i.e. the target of a call and every
+        /// block reachable from it without making another call.
+        struct Function
+        {
+            /// @brief Entry point
+            Word start;
+
+            /// @brief Address past the last instruction of the highest block
+            Word end;
+
+            /// @brief Addresses of the blocks, in ascending order
+            std::vector<Word> blocks;
+        };
+
+        /// @brief Defines a call made through `jal`.
+        struct Call
+        {
+            /// @brief Address of the `jal` instruction
+            Word site;
+
+            /// @brief Address of the function called
+            Word target;
+        };
+
+        /// @brief Defines a jump table used by a `jr` instruction.
+        struct JumpTable
+        {
+            /// @brief Address of the `jr` instruction
+            Word jump;
+
+            /// @brief Address of the table
+            Word address;
+
+            /// @brief Addresses stored in the table
+            std::vector<Word> targets;
+        };
+
+        /// @brief Maximum number of instructions searched backwards from an
+        /// indirect jump for the load of its target
+        static constexpr int JUMP_TABLE_WINDOW{ 16 };
+
+        /// @brief Maximum number of entries of a jump table
+        static constexpr std::size_t MAX_JUMP_TABLE_SIZE{ 1024 };
+
+        /// @brief Initializes the analyzer.
+        /// @param data The memory image to analyze.
+        /// @param address The address the image begins at.
+        Analyzer(const std::vector<Byte>& data, const Word address) noexcept;
+
+        /// @brief Adds a function entry point.
+        /// @param address The address of the function.
+        /// @return `false` if the address is outside of the image.
+        auto add_entry(const Word address) noexcept -> bool;
+
+        /// @brief Adds the target of every `jal` instruction found in the
+        /// image as an entry point, for when the real entry points aren't
+        /// known, e.g. with a RAM dump.
+        auto scan_calls() noexcept -> void;
+
+        /// @brief Analyzes the image, filling in `blocks`, `functions`,
+        /// `calls` and `jump_tables`.
+        auto run() noexcept -> void;
+
+        /// @brief Writes the results as text, one item per line:
+        ///
+        ///     function START END BLOCKS
+        ///     block START END [SUCCESSOR...]
+        ///     call SITE TARGET
+        ///     jumptable JUMP ADDRESS TARGET...
+        ///
+        /// with every number in hexadecimal. Ranges exclude their end.
+        /// @param file The stream to write to.
+        auto write_index(FILE* file) const noexcept -> void;
+
+        /// @brief Writes a name for every function, in the format printed by
+        /// `nm`, as read by `Profiler::load_symbols()`.
+        /// @param file The stream to write to.
+        auto write_symbols(FILE* file) const noexcept -> void;
+
+        /// @brief Basic blocks, indexed by start address
+        std::map<Word, Block> blocks;
+
+        /// @brief Functions, indexed by start address
+        std::map<Word, Function> functions;
+
+        /// @brief Calls, in the order of their sites
+        std::vector<Call> calls;
+
+        /// @brief Jump tables, in the order of their jumps
+        std::vector<JumpTable> jump_tables;
+
+    private:
+        /// @brief Flags kept for every word of the image
+        enum Flag : Byte
+        {
+            /// @brief The word is an instruction.
+            Code = 1 << 0,
+
+            /// @brief A block begins at the word.
+            Leader = 1 << 1,
+
+            /// @brief A block ends after the word, which is a delay slot.
+            End = 1 << 2
+        };
+
+        /// @brief Determines if an address is that of a word within the
+        /// image.
+        auto contains(const Word address) const noexcept -> bool;
+
+        /// @brief Returns the word at an address in the image.
+        auto word_at(const Word address) const noexcept -> Word;
+
+        /// @brief Returns the flags of the word at an address in the image.
+        auto flags_at(const Word address) noexcept -> Byte&;
+
+        /// @brief Decodes the instruction at an address in the image.
+        auto decode(const Word address) const noexcept -> DecodedInstruction;
+
+        /// @brief Marks an address as the start of a block, queueing it to be
+        /// explored if it hasn't been yet.
+        auto add_leader(const Word address) noexcept -> void;
+
+        /// @brief Follows the flow of the program from every queued address.
+        auto explore() noexcept -> void;
+
+        /// @brief Searches backwards from an indirect jump for the jump table
+        /// it reads its target from.
+        /// @param jump The decoded `jr` instruction.
+        /// @return `false` if no jump table was found.
+        auto find_jump_table(const DecodedInstruction& jump) noexcept -> bool;
+
+        /// @brief Computes the successors of a block ending with a jump or
+        /// branch.
+        /// @param jump The address of the jump or branch.
+        auto successors(const Word jump) const noexcept -> std::vector<Word>;
+
+        /// @brief Splits the instructions found into blocks.
+        auto build_blocks() noexcept -> void;
+
+        /// @brief Groups the blocks into functions.
+        auto build_functions() noexcept -> void;
+
+        /// @brief The memory image
+        std::vector<Byte> image;
+
+        /// @brief The address the image begins at
+        Word base;
+
+        /// @brief Flags of every word of the image
+        std::vector<Byte> flags;
+
+        /// @brief Function entry points
+        std::set<Word> entries;
+
+        /// @brief Addresses waiting to be explored
+        std::vector<Word> pending;
+
+        /// @brief Index into `jump_tables`, by address of the jump
+        std::unordered_map<Word, std::size_t> tables_by_jump;
+    };
+}
@@ -18,6 +18,9 @@
 #include <cstring>
 #include <vector>
 #include "gpu.h"
+#include "hooks.h"
+#include "perf.h"
+#include "stats.h"
 #include "types.h"
 
 namespace PlayStation
@@ -48,7 +51,91 @@ namespace PlayStation
             // XXX: This technically isn't accurate as it clobbers the Cache
             // Control register (0xFFFE0130), but for now it works.
             const Word paddr{ vaddr & 0x1FFFFFFF };
+            const T result{ read<T>(paddr) };
 
+            if constexpr (STATS_ENABLED)
+            {
+                Stats::this_thread.access(paddr, sizeof(T), false);
+            }
+
+            if (hooks.read_hooked(paddr))
+            {
+                hooks.on_access(paddr, result, sizeof(T), WatchType::Read);
+            }
+            return result;
+        }
+
+        /// @brief Writes data into memory.
+        /// @tparam T The data type of the data.
+        /// @param vaddr The address to write to. This is automatically
+        /// converted to a physical address.
+        /// @param data The data to store.
+        template<typename T>
+        auto memory_access(const Word vaddr, const T data) noexcept -> void
+        {
+            // XXX: This technically isn't accurate as it clobbers the Cache
+            // Control register (0xFFFE0130), but for now it works.
+            const Word paddr{ vaddr & 0x1FFFFFFF };
+
+            if constexpr (STATS_ENABLED)
+            {
+                Stats::this_thread.access(paddr, sizeof(T), true);
+            }
+
+            if (hooks.write_hooked(paddr))
+            {
+                hooks.on_access(paddr, data, sizeof(T), WatchType::Write);
+            }
+            write<T>(paddr, data);
+        }
+
+        /// @brief Fetches an instruction from memory. Unlike
+        /// `memory_access()`, this does not trigger memory watchpoints.
+        /// @param vaddr The address of the instruction.
+        /// @return The instruction.
+        auto fetch(const Word vaddr) noexcept -> Word
+        {
+            return read<Word>(vaddr & 0x1FFFFFFF);
+        }
+
+        /// @brief Marks main RAM written to other than through the bus as
+        /// dirty.
+        /// @param paddr The physical address of the first byte written.
+        /// @param size The number of bytes written.
+        auto mark_dirty(const Word paddr, const Word size) noexcept -> void;
+
+        /// @brief Number of main RAM pages tracked by `ram_dirty`
+        static constexpr auto RAM_PAGES{ RAM_SIZE / DIRTY_PAGE_SIZE };
+
+        /// @brief [0x00000000 - 0x001FFFFF]: Main RAM
+        std::vector<Byte> ram;
+
+        /// @brief Pages of main RAM written to since each consumer last
+        /// cleared its flag (`DIRTY_SNAPSHOT`, ...), so that only those need
+        /// to be copied.
+        std::array<Byte, RAM_PAGES> ram_dirty;
+
+        /// @brief [0x1F800000 - 0x1F8003FF]: Scratchpad
+        /// (D-Cache used as Fast RAM)
+        std::array<Byte, SCRATCHPAD_SIZE> scratchpad;
+
+        /// @brief GPU device instance
+        GPU gpu;
+
+        /// @brief Breakpoint and watchpoint registry
+        Hooks hooks;
+
+        /// @brief Performance counters to add device time to, if any
+        Perf* perf{ nullptr };
+
+private:
+        /// @brief Returns data from memory.
+        /// @tparam T The type of data to read.
+        /// @param paddr The physical address to read from.
+        /// @return The data from memory.
+        template<typename T>
+        auto read(const Word paddr) noexcept -> T
+        {
             T result{ 0 };
 
             switch ((paddr & 0xFFFF0000) >> 16)
@@ -105,21 +192,18 @@ namespace PlayStation
 
         /// @brief Writes data into memory.
         /// @tparam T The data type of the data.
-        /// @param vaddr The address to write to. This is automatically
-        /// converted to a physical address.
+        /// @param paddr The physical address to write to.
         /// @param data The data to store.
         template<typename T>
-        auto memory_access(const Word vaddr, const T data) noexcept -> void
+        auto write(const Word paddr, const T data) noexcept -> void
         {
-            // XXX: This technically isn't accurate as it clobbers the Cache
-            // Control register (0xFFFE0130), but for now it works.
-            const Word paddr{ vaddr & 0x1FFFFFFF };
-
             switch ((paddr & 0xFFFF0000) >> 16)
             {
                 // [0x00000000 - 0x001FFFFF]: Main RAM
                 case 0x0000 ... 0x001F:
                     std::memcpy(&ram.data()[paddr], &data, sizeof(T));
+                    ram_dirty[paddr / DIRTY_PAGE_SIZE] = DIRTY_ALL;
+
                     return;
 
                 case 0x1F80:
@@ -137,12 +221,20 @@ namespace PlayStation
                             switch (paddr & 0x00000FFF)
                             {
                                 case GPU::Registers::GP0:
+                                {
+                                    const Perf::Scope scope{ perf, Perf::GPU };
                                     gpu.gp0(data);
+
                                     return;
+                                }
 
                                 case GPU::Registers::GP1:
+                                {
+                                    const Perf::Scope scope{ perf, Perf::GPU };
                                     gpu.gp1(data);
+
                                     return;
+                                }
 
                                 default:
                                     printf("Unknown memory write: 0x%08X <- 0x%x\n", paddr,
@@ -163,17 +255,6 @@ namespace PlayStation
             }
         }
 
-        /// @brief [0x00000000 - 0x001FFFFF]: Main RAM
-        std::vector<Byte> ram;
-
-        /// @brief [0x1F800000 - 0x1F8003FF]: Scratchpad
-        /// (D-Cache used as Fast RAM)
-        std::array<Byte, SCRATCHPAD_SIZE> scratchpad;
-
-        /// @brief GPU device instance
-        GPU gpu;
-
-private:
         /// @brief [0x1FC00000 - 0x1FC7FFFF]: BIOS ROM (512 KB)
         BIOS bios;
     };
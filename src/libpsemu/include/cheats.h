@@ -0,0 +1,138 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bus.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a list of GameShark (Action Replay) cheat codes, applied
+    /// to main RAM at the end of every frame.
+    ///
+    /// Codes are parsed once into a flat list of writes, with slides expanded
+    /// and the conditions each write depends on resolved to indices, so that
+    /// applying them does no parsing or allocation. Conditions are all
+    /// evaluated first, in order of address, against main RAM as the game
+    /// left it; the writes then follow in the order the codes were given.
+    ///
+    /// Supported code types are 30 and 80 (constant writes), 10, 11, 20 and
+    /// 21 (increments and decrements), D0 to D3 and E0 to E3 (conditions on
+    /// the next code, which may be another condition) and 50 (slides).
+    class Cheats final
+    {
+    public:
+        /// @brief Adds codes, one per line as "AAAAAAAA VVVV". Lines may also
+        /// be separated by '+'. Blank lines and lines starting with '#' are
+        /// ignored.
+        /// @param codes The codes to add.
+        /// @return `false` if a code is malformed or of an unsupported type,
+        /// in which case none of them are added.
+        auto add(const std::string& codes) noexcept -> bool;
+
+        /// @brief Adds codes from a file, in the same format as `add()`.
+        /// @param path The path of the file to read.
+        /// @return `false` if the file couldn't be read or a code is invalid.
+        auto load(const std::string& path) noexcept -> bool;
+
+        /// @brief Removes all codes.
+        auto clear() noexcept -> void;
+
+        /// @brief Applies the codes to main RAM.
+        /// @param bus The system bus whose main RAM to change.
+        auto apply(SystemBus& bus) noexcept -> void;
+
+        /// @brief Returns the number of writes the codes were compiled to.
+        auto size() const noexcept -> std::size_t;
+
+        /// @brief Returns a hash of the codes as compiled, e.g. to tell if a
+        /// movie was recorded with the same codes.
+        /// @return The hash, or 0 if there are no codes.
+        auto hash() const noexcept -> std::uint64_t;
+
+    private:
+        /// @brief Tests a condition can make.
+        enum class Test : Byte
+        {
+            Equal,
+            NotEqual,
+            Less,
+            Greater
+        };
+
+        /// @brief Changes a write can make.
+        enum class Action : Byte
+        {
+            Write,
+            Increment,
+            Decrement
+        };
+
+        /// @brief Condition some writes depend on.
+        struct Condition
+        {
+            /// @brief Physical address of the value to test
+            Word paddr;
+
+            /// @brief Value to test against
+            Halfword value;
+
+            /// @brief Size of the value, in bytes
+            Byte width;
+
+            /// @brief Test to make
+            Test test;
+        };
+
+        /// @brief Change to a value of main RAM.
+        struct Operation
+        {
+            /// @brief Physical address of the value to change
+            Word paddr;
+
+            /// @brief Value to write, or to add or subtract
+            Halfword value;
+
+            /// @brief Size of the value, in bytes
+            Byte width;
+
+            /// @brief Change to make
+            Action action;
+
+            /// @brief Range of `requirements` listing the conditions that
+            /// must all hold for the change to be made
+            std::uint32_t first_requirement;
+            std::uint32_t last_requirement;
+        };
+
+        /// @brief Sorts the conditions by address, keeping the requirements
+        /// pointing at the right ones.
+        auto sort_conditions() noexcept -> void;
+
+        /// @brief Conditions, sorted by address
+        std::vector<Condition> conditions;
+
+        /// @brief Changes, in the order of the codes
+        std::vector<Operation> operations;
+
+        /// @brief Indices of the conditions each operation depends on
+        std::vector<std::uint32_t> requirements;
+
+        /// @brief Results of the conditions at the current frame
+        std::vector<Byte> results;
+    };
+}
@@ -0,0 +1,195 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+#include "symbols.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a collector of guest code coverage.
+    ///
+    /// A basic block is taken to begin at any instruction which doesn't
+    /// sequentially follow the previous one (a taken branch, a jump or an
+    /// exception), and at the instruction after the delay slot of any branch,
+    /// taken or not. Only the first instruction of a block is recorded, so
+    /// the cost is a compare per instruction and a store per block.
+    ///
+    /// In `Blocks` mode, one bit is kept for every word of main RAM and the
+    /// BIOS, and set when a block beginning there is executed. In `Edges`
+    /// mode, a 64KiB map of hit counts indexed by a hash of the previous and
+    /// current block is kept instead, like AFL does, for fuzzers which care
+    /// about paths rather than addresses.
+    class Coverage final
+    {
+    public:
+        /// @brief What is recorded.
+        enum class Mode
+        {
+            /// @brief Addresses of the blocks executed
+            Blocks,
+
+            /// @brief Hit counts of the transitions between blocks
+            Edges
+        };
+
+        /// @brief Number of entries of the edge map
+        static constexpr std::size_t EDGE_MAP_SIZE{ 65536 };
+
+        /// @brief Initializes the collector.
+        /// @param m What to record.
+        explicit Coverage(const Mode m = Mode::Blocks) noexcept;
+
+        /// @brief Discards all data collected so far.
+        auto reset() noexcept -> void;
+
+        /// @brief Accounts for the instruction the CPU is about to execute.
+        /// @param pc The address of the instruction.
+        /// @param instruction The instruction.
+        auto step(const Word pc, const Word instruction) noexcept -> void
+        {
+            if (pc != last_pc + 4 || after_delay_slot)
+            {
+                mark(pc);
+            }
+
+            // Opcodes 1 to 7 are BCOND, J, JAL, BEQ, BNE, BLEZ and BGTZ;
+            // SPECIAL 8 and 9 are JR and JALR. This runs for every
+            // instruction, so it is done without branching.
+            after_delay_slot = in_delay_slot;
+            in_delay_slot    = ((std::uint64_t{ 0xFE } >> (instruction >> 26)) &
+                                1) |
+                               ((instruction & 0xFC00003E) == 0x00000008);
+
+            last_pc = pc;
+        }
+
+        /// @brief Determines if a block beginning at an address was executed.
+        /// Always `false` in `Edges` mode.
+        auto executed(const Word address) const noexcept -> bool;
+
+        /// @brief Returns the number of blocks executed or, in `Edges` mode,
+        /// the number of entries of the edge map which were hit.
+        auto count() const noexcept -> std::size_t;
+
+        /// @brief Returns the bitmap of blocks or the map of edges.
+        auto map() const noexcept -> const std::vector<Byte>&;
+
+        /// @brief Names a function in the output.
+        /// @param address The address of the function.
+        /// @param name The name of the function.
+        auto add_symbol(const Word address, const std::string& name) noexcept
+        -> void;
+
+        /// @brief Loads function names from a file, see `read_symbols()`.
+        /// @param path The path of the file to read.
+        /// @return `false` if the file couldn't be opened.
+        auto load_symbols(const std::string& path) noexcept -> bool;
+
+        /// @brief Adds a block known to exist, e.g. found by `Analyzer`, so
+        /// that it is reported even if it wasn't executed.
+        /// @param address The address of the block.
+        auto add_block(const Word address) noexcept -> void;
+
+        /// @brief Writes the blocks in lcov tracefile format. As there are no
+        /// source files, the addresses of the blocks and functions are
+        /// written in place of line numbers, in decimal.
+        /// @param file The stream to write to.
+        /// @param name The name to give to the "source file", e.g. the path
+        /// of the EXE.
+        auto write_lcov(FILE* file, const std::string& name) const noexcept
+        -> void;
+
+        /// @brief Writes the blocks in lcov tracefile format to a file.
+        /// @param path The path of the file to write to.
+        /// @param name The name to give to the "source file".
+        /// @return `false` if the file couldn't be opened.
+        auto write_lcov(const std::string& path,
+                        const std::string& name) const noexcept -> bool;
+
+    private:
+        /// @brief Returned by `word_index()` for addresses code can't be
+        /// executed from
+        static constexpr Word NO_INDEX{ 0xFFFFFFFF };
+
+        /// @brief Converts an address to the index of its bit in the block
+        /// bitmap. Main RAM comes first, followed by the BIOS.
+        /// @param address The address to convert.
+        static auto word_index(const Word address) noexcept -> Word
+        {
+            const Word paddr{ address & 0x1FFFFFFF };
+
+            // Main RAM is mirrored four times.
+            if (paddr < RAM_SIZE * 4)
+            {
+                return (paddr & (RAM_SIZE - 1)) / sizeof(Word);
+            }
+
+            if (paddr - 0x1FC00000 < BIOS_SIZE)
+            {
+                return (RAM_SIZE + (paddr - 0x1FC00000)) / sizeof(Word);
+            }
+            return NO_INDEX;
+        }
+
+        /// @brief Records the beginning of a block.
+        auto mark(const Word pc) noexcept -> void
+        {
+            if (mode == Mode::Edges)
+            {
+                mark_edge(pc);
+                return;
+            }
+
+            const Word index{ word_index(pc) };
+
+            if (index != NO_INDEX)
+            {
+                bits[index / 8] |= 1 << (index % 8);
+            }
+        }
+
+        /// @brief Records the transition to a block in `Edges` mode.
+        auto mark_edge(const Word pc) noexcept -> void;
+
+        /// @brief What is recorded
+        Mode mode;
+
+        /// @brief Block bitmap or edge map
+        std::vector<Byte> bits;
+
+        /// @brief Address of the previous instruction
+        Word last_pc{ 0xFFFFFFFF };
+
+        /// @brief Whether the next instruction is in a delay slot
+        bool in_delay_slot{ false };
+
+        /// @brief Whether the next instruction follows a delay slot
+        bool after_delay_slot{ false };
+
+        /// @brief Hash of the previous block, for `Edges` mode
+        Word previous{ 0 };
+
+        /// @brief Function names, indexed by address
+        Symbols symbols;
+
+        /// @brief Blocks known to exist
+        std::set<Word> known_blocks;
+    };
+}
@@ -37,6 +37,11 @@ namespace PlayStation
         /// @brief Executes the next instruction.
         auto step() noexcept -> void;
 
+        /// @brief Transfers control to an address immediately, without a
+        /// branch delay slot. Any pending load is completed first.
+        /// @param address The address to continue execution from.
+        auto set_pc(const Word address) noexcept -> void;
+
         /// @brief General purpose registers.
         std::array<Word, 32> gpr;
 
@@ -358,6 +363,8 @@ namespace PlayStation
         };
 
 private:
+        friend class Snapshot;
+
         /// @brief Instruction groups
         enum InstructionGroup
         {
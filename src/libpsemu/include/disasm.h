@@ -0,0 +1,188 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "types.h"
+
+namespace PlayStation
+{
+    class CPU;
+
+    /// @brief Instructions known to the disassembler
+    enum class Mnemonic : Byte
+    {
+        ILLEGAL,
+        SLL, SRL, SRA, SLLV, SRLV, SRAV,
+        JR, JALR, SYSCALL, BREAK,
+        MFHI, MTHI, MFLO, MTLO, MULT, MULTU, DIV, DIVU,
+        ADD, ADDU, SUB, SUBU, AND, OR, XOR, NOR, SLT, SLTU,
+        BLTZ, BGEZ, BLTZAL, BGEZAL,
+        J, JAL, BEQ, BNE, BLEZ, BGTZ,
+        ADDI, ADDIU, SLTI, SLTIU, ANDI, ORI, XORI, LUI,
+        MFC0, MTC0, RFE,
+        MFC2, CFC2, MTC2, CTC2, COP2,
+        LB, LH, LWL, LW, LBU, LHU, LWR,
+        SB, SH, SWL, SW, SWR,
+        LWC2, SWC2,
+
+        Count
+    };
+
+    /// @brief How the operands of an instruction are written
+    enum class Operands : Byte
+    {
+        /// @brief No operands, e.g. `rfe`
+        None,
+
+        /// @brief `rd, rt, shamt`
+        Shift,
+
+        /// @brief `rd, rt, rs`
+        ShiftVariable,
+
+        /// @brief `rs`
+        JumpRegister,
+
+        /// @brief `rd, rs`
+        JumpAndLinkRegister,
+
+        /// @brief `rd`
+        MoveFrom,
+
+        /// @brief `rs`
+        MoveTo,
+
+        /// @brief `rs, rt`
+        MultiplyDivide,
+
+        /// @brief `rd, rs, rt`
+        ALURegister,
+
+        /// @brief `address`
+        Jump,
+
+        /// @brief `rs, rt, address`
+        BranchCompare,
+
+        /// @brief `rs, address`
+        Branch,
+
+        /// @brief `rt, rs, immediate`
+        ALUImmediate,
+
+        /// @brief `rt, immediate`
+        LoadUpperImmediate,
+
+        /// @brief `rt, COP0 register rd`
+        COP0Register,
+
+        /// @brief `rt, COP2 register rd`
+        COP2Register,
+
+        /// @brief `rt, offset(base)`
+        Memory,
+
+        /// @brief `COP2 register rt, offset(base)`
+        COP2Memory,
+
+        /// @brief The 25-bit command of a COP2 operation
+        Command,
+
+        /// @brief The 20-bit code of `syscall` and `break`, if not 0
+        Code
+    };
+
+    /// @brief Where an instruction leaves its result
+    enum class Destination : Byte
+    {
+        None,
+        GPR,
+        COP0,
+        HiLo
+    };
+
+    /// @brief Defines an instruction split into its fields, ready to be
+    /// formatted.
+    struct DecodedInstruction
+    {
+        /// @brief Address of the instruction
+        Word pc;
+
+        /// @brief The instruction itself
+        Word word;
+
+        /// @brief What the instruction is
+        Mnemonic mnemonic;
+
+        /// @brief How its operands are written
+        Operands operands;
+
+        /// @brief Register fields
+        Byte rs, rt, rd, shamt;
+
+        /// @brief Lower 16 bits of the instruction
+        Halfword immediate;
+
+        /// @brief Branch or jump target, or the code or command field
+        Word address;
+
+        /// @brief Where the result goes
+        Destination destination;
+
+        /// @brief Register written to, if `destination` is `GPR` or `COP0`
+        Byte written;
+    };
+
+    /// @brief Conventional names of the general purpose registers
+    constexpr std::array<const char*, 32> GPR_NAMES
+    {
+        "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+        "$t0",   "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+        "$s0",   "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+        "$t8",   "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra"
+    };
+
+    /// @brief Splits an instruction into its fields.
+    /// @param pc The address of the instruction, used to resolve branches.
+    /// @param word The instruction.
+    /// @return The decoded instruction.
+    auto decode_instruction(const Word pc,
+                            const Word word) noexcept -> DecodedInstruction;
+
+    /// @brief Writes an instruction as assembly, e.g. `addiu $sp, $sp, 0xFFE8`.
+    /// Nothing is allocated; 64 bytes are always enough.
+    /// @param instr The decoded instruction.
+    /// @param buffer Where to write the text. It is always terminated.
+    /// @param size The size of `buffer`. The text is truncated to fit.
+    /// @return The number of characters written, excluding the terminator.
+    auto format_instruction(const DecodedInstruction& instr,
+                            char* const buffer,
+                            const std::size_t size) noexcept -> std::size_t;
+
+    /// @brief Writes the value of the register(s) an instruction wrote, e.g.
+    /// `$sp=0x801FFEE8`. Meant to be called after the instruction executed.
+    /// @param instr The decoded instruction.
+    /// @param cpu The CPU to read the values from.
+    /// @param buffer Where to write the text. It is always terminated.
+    /// @param size The size of `buffer`. The text is truncated to fit.
+    /// @return The number of characters written, excluding the terminator.
+    /// This is 0 if the instruction doesn't write a register.
+    auto format_result(const DecodedInstruction& instr,
+                       CPU& cpu,
+                       char* const buffer,
+                       const std::size_t size) noexcept -> std::size_t;
+}
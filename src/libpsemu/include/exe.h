@@ -0,0 +1,59 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a PS-X EXE.
+    class EXE final
+    {
+    public:
+        /// @brief Parses a PS-X EXE.
+        /// @param data The contents of the EXE file.
+        /// @return `false` if the data is not a PS-X EXE.
+        auto load(const std::vector<Byte>& data) noexcept -> bool;
+
+        /// @brief Reads and parses a PS-X EXE file.
+        /// @param path The path of the file.
+        /// @return `false` if the file couldn't be read or is not a PS-X EXE.
+        auto load_file(const std::string& path) noexcept -> bool;
+
+        /// @brief Initial value of the program counter
+        Word pc{ 0 };
+
+        /// @brief Initial value of $gp
+        Word gp{ 0 };
+
+        /// @brief Address in RAM to load the text to
+        Word dest{ 0 };
+
+        /// @brief First address of the BSS area, which is zero filled
+        Word bss_start{ 0 };
+
+        /// @brief Number of bytes in the BSS area
+        Word bss_size{ 0 };
+
+        /// @brief Initial value of $sp and $fp, or 0 to leave it to the
+        /// loader.
+        Word sp{ 0 };
+
+        /// @brief Code and data to load to `dest`
+        std::vector<Byte> text;
+    };
+}
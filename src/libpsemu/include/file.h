@@ -0,0 +1,36 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+namespace PlayStation
+{
+    /// @brief Reads an entire file into memory.
+    /// @param path The path of the file to read.
+    /// @param data Where to store the contents of the file.
+    /// @return `false` if the file couldn't be read.
+    auto read_file(const std::string& path, std::vector<Byte>& data) noexcept
+    -> bool;
+
+    /// @brief Reads a BIOS image.
+    /// @param path The path of the file to read.
+    /// @param bios Where to store the BIOS data.
+    /// @return `false` if the file couldn't be read or is not the size of a
+    /// BIOS image.
+    auto read_bios(const std::string& path, BIOS& bios) noexcept -> bool;
+}
@@ -0,0 +1,197 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "types.h"
+
+namespace PlayStation
+{
+    /// @brief Header at the start of a shared memory frame ring.
+    ///
+    /// The ring is a POSIX shared memory object holding this header followed
+    /// by `slot_count` slots of `slot_size` bytes each, starting at
+    /// `slot_offset`. Frame `n` (counting from 1) is published into slot
+    /// `(n - 1) % slot_count`, after which `published` is set to `n` (modulo
+    /// 2^32) and any process waiting on it, as a futex, is woken up.
+    struct FrameRing
+    {
+        /// @brief Identifies the object as a frame ring: "PSEMUFRM"
+        char magic[8];
+
+        /// @brief Version of the layout, currently 1
+        std::uint32_t version;
+
+        /// @brief Number of slots
+        std::uint32_t slot_count;
+
+        /// @brief Width of a frame, in pixels
+        std::uint32_t width;
+
+        /// @brief Height of a frame, in pixels
+        std::uint32_t height;
+
+        /// @brief Distance between two lines of a frame, in bytes
+        std::uint32_t stride;
+
+        /// @brief Pixel format of a frame: 0 is A1B5G5R5, as VRAM stores
+        /// pixels (`GL_UNSIGNED_SHORT_1_5_5_5_REV`)
+        std::uint32_t format;
+
+        /// @brief Offset of the first slot, in bytes
+        std::uint64_t slot_offset;
+
+        /// @brief Size of a slot including its header, in bytes
+        std::uint64_t slot_size;
+
+        /// @brief Number of frames published, modulo 2^32. This is the futex
+        /// consumers wait on.
+        std::atomic<std::uint32_t> published;
+
+        /// @brief Number of consumers waiting on `published`. The producer
+        /// only makes a system call to wake them up if this isn't 0.
+        std::atomic<std::uint32_t> waiters;
+    };
+
+    /// @brief Header at the start of every slot of a frame ring, followed by
+    /// the pixels at `PIXEL_OFFSET`.
+    struct FrameSlot
+    {
+        /// @brief Offset of the pixels from the start of the slot, in bytes
+        static constexpr std::size_t PIXEL_OFFSET{ 64 };
+
+        /// @brief Incremented before and after the slot is written, so it is
+        /// odd while the slot is being written. Consumers reading pixels in
+        /// place must check that it was even and unchanged around the read.
+        std::atomic<std::uint32_t> sequence;
+
+        /// @brief Number of the frame, counting from 1
+        std::uint64_t frame;
+
+        /// @brief Host `CLOCK_MONOTONIC` time the frame was published at, in
+        /// nanoseconds
+        std::int64_t monotonic_ns;
+
+        /// @brief Host `CLOCK_REALTIME` time the frame was published at, in
+        /// nanoseconds
+        std::int64_t realtime_ns;
+
+        /// @brief Returns the pixels of the frame.
+        auto pixels() const noexcept -> const Halfword*
+        {
+            return reinterpret_cast<const Halfword*>(
+                reinterpret_cast<const Byte*>(this) + PIXEL_OFFSET);
+        }
+    };
+
+    /// @brief Defines a publisher of frames to other processes on the same
+    /// host, through a shared memory frame ring (see `FrameRing`).
+    ///
+    /// As there is no display area emulation yet, a frame is all of VRAM.
+    /// Publishing copies it into the next slot, and consumers map the ring to
+    /// read frames where they are without further copies. Consumers that
+    /// fall more than `slot_count - 1` frames behind miss frames, the
+    /// producer never waits for them. Only available on Linux.
+    class FrameExport final
+    {
+    public:
+        /// @brief Number of slots used when none is given
+        static constexpr std::uint32_t DEFAULT_SLOTS{ 4 };
+
+        FrameExport() noexcept = default;
+        FrameExport(const FrameExport&) = delete;
+        auto operator=(const FrameExport&) -> FrameExport& = delete;
+
+        /// @brief Unmaps and removes the frame ring, if any.
+        ~FrameExport() noexcept;
+
+        /// @brief Creates the frame ring, replacing any existing one with the
+        /// same name.
+        /// @param name The name of the shared memory object, e.g. "/psemu".
+        /// @param slot_count The number of slots.
+        /// @return `false` if the ring couldn't be created.
+        auto open(const std::string& name,
+                  const std::uint32_t slot_count = DEFAULT_SLOTS) noexcept
+        -> bool;
+
+        /// @brief Unmaps and removes the frame ring.
+        auto close() noexcept -> void;
+
+        /// @brief Publishes a frame and wakes up waiting consumers.
+        /// @param vram The contents of VRAM at the end of the frame.
+        auto publish(const VRAM& vram) noexcept -> void;
+
+    private:
+        /// @brief The mapped frame ring, if any
+        FrameRing* ring{ nullptr };
+
+        /// @brief Size of the mapping, in bytes
+        std::size_t size{ 0 };
+
+        /// @brief Name of the shared memory object
+        std::string path;
+
+        /// @brief Number of frames published
+        std::uint64_t frames{ 0 };
+    };
+
+    /// @brief Defines a consumer of frames published by `FrameExport`, for
+    /// programs that would rather not map the ring themselves.
+    class FrameReader final
+    {
+    public:
+        FrameReader() noexcept = default;
+        FrameReader(const FrameReader&) = delete;
+        auto operator=(const FrameReader&) -> FrameReader& = delete;
+
+        /// @brief Unmaps the frame ring, if any.
+        ~FrameReader() noexcept;
+
+        /// @brief Maps an existing frame ring, unmapping the previous one if
+        /// any.
+        /// @param name The name of the shared memory object.
+        /// @return `false` if there is no valid frame ring with that name.
+        auto open(const std::string& name) noexcept -> bool;
+
+        /// @brief Unmaps the frame ring, if any.
+        auto close() noexcept -> void;
+
+        /// @brief Waits until a frame other than `seen` has been published.
+        /// @param seen The value of `FrameRing::published` last seen.
+        /// @param timeout_ms How long to wait for, in milliseconds, or a
+        /// negative value to wait forever.
+        /// @return The new value of `FrameRing::published`, which is `seen`
+        /// if the wait timed out.
+        auto wait(const std::uint32_t seen, const int timeout_ms = -1) noexcept
+        -> std::uint32_t;
+
+        /// @brief Returns the header of the frame ring.
+        auto header() const noexcept -> const FrameRing&;
+
+        /// @brief Returns the slot a frame is published into.
+        /// @param frame The number of the frame.
+        auto slot(const std::uint64_t frame) const noexcept -> const FrameSlot&;
+
+    private:
+        /// @brief The mapped frame ring, if any
+        const FrameRing* ring{ nullptr };
+
+        /// @brief Size of the mapping, in bytes
+        std::size_t size{ 0 };
+    };
+}
@@ -15,7 +15,6 @@
 #pragma once
 
 #include <array>
-#include <functional>
 #include <vector>
 #include "types.h"
 
@@ -25,6 +24,9 @@ namespace PlayStation
     class GPU final
     {
     public:
+        /// @brief Initializes the GPU.
+        GPU() noexcept;
+
         /// @brief Resets the GPU to the startup state.
         auto reset() noexcept -> void;
 
@@ -57,7 +59,18 @@ namespace PlayStation
         /// commands (R)
         Word gpuread;
 
+        /// @brief Number of VRAM pages tracked by `vram_dirty`
+        static constexpr auto VRAM_PAGES{ (VRAM_WIDTH * VRAM_HEIGHT *
+                                           sizeof(Halfword)) /
+                                          DIRTY_PAGE_SIZE };
+
+        /// @brief Pages of VRAM written to since each consumer last cleared
+        /// its flag, as with `SystemBus::ram_dirty`.
+        std::array<Byte, VRAM_PAGES> vram_dirty;
+
     private:
+        friend class Snapshot;
+
         /// @brief GP0 port state.
         ///
         /// XXX: With proper GPUSTAT implementation, this may not be necessary.
@@ -79,18 +92,43 @@ namespace PlayStation
             TransferringData
         };
 
+        /// @brief GP0 commands that take parameters or data.
+        enum class Command
+        {
+            /// @brief No command is being processed.
+            None,
+
+            /// @brief GP0(0x68) - Monochrome Rectangle(1x1) (Dot) (opaque)
+            DrawDot,
+
+            /// @brief GP0(0xA0) - Copy Rectangle (CPU to VRAM)
+            CopyToVRAM,
+
+            /// @brief GP0(0xC0) - Copy Rectangle (VRAM to CPU)
+            CopyFromVRAM
+        };
+
         /// @brief Current GP0 command data.
         struct
         {
             /// @brief Parameters to the command.
             std::vector<Word> params;
 
-            /// @brief The function to call when all of the parameters to the
-            /// command have been received.
-            std::function<void(const Word)> func;
+            /// @brief The command to run when all of its parameters have been
+            /// received.
+            Command command;
 
             /// @brief The number of parameters required by the command.
             unsigned int remaining_words;
+
+            /// @brief Current X position of a VRAM copy
+            int vram_x_pos;
+
+            /// @brief Current Y position of a VRAM copy
+            int vram_y_pos;
+
+            /// @brief Maximum length of a line (should be Xxxx+Xsiz)
+            int vram_x_pos_max;
         } cmd;
 
         struct Vertex
@@ -108,6 +146,31 @@ namespace PlayStation
         /// @brief Resets the GP0 port to accept commands.
         auto reset_gp0() noexcept -> void;
 
+        /// @brief Runs the current command once all of its parameters have
+        /// been received, and again for every data word.
+        /// @param data The data word, if any.
+        auto run_command(const Word data) noexcept -> void;
+
+        /// @brief Handles GP0(0xA0) - Copy Rectangle (CPU to VRAM).
+        /// @param data The data word, if any.
+        auto copy_to_vram(const Word data) noexcept -> void;
+
+        /// @brief Handles GP0(0xC0) - Copy Rectangle (VRAM to CPU).
+        /// @param data The data word, if any.
+        auto copy_from_vram(const Word data) noexcept -> void;
+
+        /// @brief Reads a pixel from VRAM.
+        /// @param x The X coordinate of the pixel, which wraps around.
+        /// @param y The Y coordinate of the pixel, which wraps around.
+        auto get_pixel(const int x, const int y) const noexcept -> Halfword;
+
+        /// @brief Writes a pixel to VRAM, marking its page as dirty.
+        /// @param x The X coordinate of the pixel, which wraps around.
+        /// @param y The Y coordinate of the pixel, which wraps around.
+        /// @param pixel The A1B5G5R5 value to write.
+        auto set_pixel(const int x, const int y, const Halfword pixel) noexcept
+        -> void;
+
         /// @brief Draws a rectangle.
         /// @param v0 The first and only vertex data to use.
         auto draw_rect(const Vertex& v0) noexcept -> void;
@@ -0,0 +1,288 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <bitset>
+#include <functional>
+#include <vector>
+#include "hooks.h"
+#include "types.h"
+
+namespace PlayStation
+{
+    class CPU;
+    class SystemBus;
+
+    /// @brief Defines the high-level emulation (HLE) layer of the BIOS kernel
+    /// functions.
+    ///
+    /// The kernel functions are called by jumping to 0xA0, 0xB0 or 0xC0 with
+    /// the function number in $t1. We hook those addresses and, for the
+    /// functions we know how to replace, do the work natively on main RAM and
+    /// return straight to $ra instead of interpreting the BIOS routine.
+    class HLE final
+    {
+    public:
+        /// @brief Kernel functions that can be replaced.
+        enum Function
+        {
+            /// @brief A(17h) - strcmp(str1, str2)
+            Strcmp,
+
+            /// @brief A(18h) - strncmp(str1, str2, maxlen)
+            Strncmp,
+
+            /// @brief A(19h) - strcpy(dst, src)
+            Strcpy,
+
+            /// @brief A(1Bh) - strlen(src)
+            Strlen,
+
+            /// @brief A(28h) - bzero(dst, len)
+            Bzero,
+
+            /// @brief A(2Ah) - memcpy(dst, src, len)
+            Memcpy,
+
+            /// @brief A(2Bh) - memset(dst, fillbyte, len)
+            Memset,
+
+            /// @brief A(2Fh) - rand() and A(30h) - srand(seed). These share
+            /// the seed, so they can only be toggled together.
+            Rand,
+
+            /// @brief C(02h) - SysEnqIntRP(priority, struc)
+            SysEnqIntRP,
+
+            /// @brief C(03h) - SysDeqIntRP(priority, struc)
+            SysDeqIntRP,
+
+            /// @brief Number of replaceable functions
+            FunctionCount
+        };
+
+        /// @brief Initializes the HLE layer and hooks the kernel function
+        /// vectors.
+        /// @param c The CPU instance.
+        /// @param b The system bus instance.
+        HLE(CPU& c, SystemBus& b) noexcept;
+
+        /// @brief Resets the HLE layer to the startup state.
+        auto reset() noexcept -> void;
+
+        /// @brief Installs a minimal kernel into main RAM, for running
+        /// programs without the BIOS.
+        ///
+        /// This consists of an exception handler at 0x80000080 that simply
+        /// returns past the offending instruction, and A0h/B0h/C0h vectors
+        /// dispatching through tables at the same addresses the BIOS uses.
+        /// Every table entry points to a stub returning 0, and every function
+        /// this class knows is handled natively, regardless of whether or not
+        /// it was enabled. Text output functions print to `on_putchar`.
+        auto install_kernel() noexcept -> void;
+
+        /// @brief Determines if the guest has exited, either by returning to
+        /// `EXIT_ADDRESS` or calling exit(). This is only tracked when the
+        /// minimal kernel is installed.
+        auto exited() const noexcept -> bool;
+
+        /// @brief Returns the exit code of the guest, if it has exited.
+        auto exit_code() const noexcept -> Word;
+
+        /// @brief Return address given to programs started without the BIOS.
+        /// Reaching it stops execution.
+        static constexpr Word EXIT_ADDRESS{ 0x80000570 };
+
+        /// @brief Enables or disables the native replacement of a function.
+        /// @param function The function to toggle.
+        /// @param enabled Whether or not to replace it.
+        auto enable(const Function function, const bool enabled) noexcept
+        -> void;
+
+        /// @brief Determines if a function is natively replaced.
+        /// @param function The function to check.
+        auto enabled(const Function function) const noexcept -> bool;
+
+        /// @brief Enables or disables verification mode.
+        ///
+        /// In verification mode, the enabled functions are computed natively
+        /// but then discarded, and the BIOS routine runs as usual. When it
+        /// returns, its result and memory writes are compared against the
+        /// native ones and any mismatch is reported.
+        /// @param enabled Whether or not to verify.
+        auto set_verify(const bool enabled) noexcept -> void;
+
+        /// @brief Returns the number of mismatches found in verification mode.
+        auto verify_failures() const noexcept -> unsigned int;
+
+        /// @brief Returns the name of a replaceable function.
+        /// @param function The function to name.
+        static auto name(const Function function) noexcept -> const char*;
+
+        /// @brief Called with each character the guest passes to A(3Ch) or
+        /// B(3Dh) putchar(char). The BIOS routine still runs as usual.
+        std::function<void(const char)> on_putchar;
+
+    private:
+        friend class Snapshot;
+
+        /// @brief Area of main RAM written to by a native replacement.
+        struct Area
+        {
+            /// @brief First guest address of the area
+            Word vaddr;
+
+            /// @brief Contents of the area before the native replacement ran
+            std::vector<Byte> before;
+
+            /// @brief Contents of the area after the native replacement ran
+            std::vector<Byte> after;
+        };
+
+        /// @brief Pending comparison of a BIOS routine against its native
+        /// replacement.
+        struct Verification
+        {
+            /// @brief The function being verified
+            Function function;
+
+            /// @brief Whether or not the function returns a value
+            bool returns;
+
+            /// @brief The value the native replacement returned in $v0
+            Word v0;
+
+            /// @brief Areas written to by the native replacement
+            std::vector<Area> areas;
+
+            /// @brief $ra on entry, where the BIOS routine will return to
+            Word ra;
+
+            /// @brief $sp on entry, used to identify the matching return
+            Word sp;
+
+            /// @brief Breakpoint placed on the return address
+            Hooks::Handle hook;
+        };
+
+        /// @brief Dispatches a call to one of the kernel function vectors.
+        /// @param vector The vector that was called (0xA0, 0xB0 or 0xC0).
+        auto dispatch(const Word vector) noexcept -> HookAction;
+
+        /// @brief Determines which function a vector and $t1 refer to.
+        /// @param vector The vector that was called (0xA0, 0xB0 or 0xC0).
+        /// @param number The function number passed in $t1.
+        /// @return The function, or `FunctionCount` if none.
+        static auto lookup(const Word vector,
+                           const Word number) noexcept -> Function;
+
+        /// @brief Handles the kernel functions that only need to be emulated
+        /// when the minimal kernel is installed.
+        /// @param vector The vector that was called (0xA0, 0xB0 or 0xC0).
+        /// @param number The function number passed in $t1.
+        /// @return `true` if the call was handled.
+        auto kernel_call(const Word vector, const Word number) noexcept
+        -> bool;
+
+        /// @brief Formats and prints a string as printf() would, taking the
+        /// format string from $a0 and the arguments following it.
+        auto print_formatted() noexcept -> void;
+
+        /// @brief Runs the native replacement of a function.
+        /// @param function The function to run.
+        /// @param v0 Where to store the return value.
+        /// @return `false` if the arguments can't be handled natively (e.g.
+        /// they point outside of main RAM, or are edge cases whose behavior
+        /// is BIOS specific), in which case nothing has been changed and the
+        /// BIOS routine must run instead.
+        auto call(const Function function, Word& v0) noexcept -> bool;
+
+        /// @brief Starts verifying a BIOS routine against its native
+        /// replacement.
+        /// @param function The function being called.
+        auto start_verification(const Function function) noexcept -> void;
+
+        /// @brief Checks a BIOS routine that has returned against its pending
+        /// verification.
+        /// @param paddr The physical address that was returned to.
+        auto check(const Word paddr) noexcept -> HookAction;
+
+        /// @brief Returns a pointer into main RAM for a guest address range.
+        /// @param vaddr The first guest address.
+        /// @param length The number of bytes that will be accessed.
+        /// @return The pointer, or `nullptr` if the range is not entirely
+        /// within main RAM.
+        auto ram_ptr(const Word vaddr, const Word length) noexcept -> Byte*;
+
+        /// @brief Same as `ram_ptr()`, but for areas that the native
+        /// replacement is about to write to. In verification mode, the
+        /// current contents are recorded so they can be restored afterwards.
+        /// @param vaddr The first guest address.
+        /// @param length The number of bytes that will be written.
+        auto writable(const Word vaddr, const Word length) noexcept -> Byte*;
+
+        /// @brief Computes the length of a NUL-terminated guest string.
+        /// @param vaddr The address of the string.
+        /// @param length Where to store the length, excluding the NUL.
+        /// @return `false` if the string runs outside of main RAM.
+        auto string_length(const Word vaddr, Word& length) noexcept -> bool;
+
+        /// @brief Reads a word from main RAM.
+        /// @param vaddr The guest address to read.
+        auto read_word(const Word vaddr) noexcept -> Word;
+
+        /// @brief Writes a word to main RAM.
+        /// @param vaddr The guest address to write.
+        /// @param data The word to write.
+        auto write_word(const Word vaddr, const Word data) noexcept -> void;
+
+        /// @brief Functions that are replaced natively
+        std::bitset<FunctionCount> replaced;
+
+        /// @brief Are we in verification mode?
+        bool verify{ false };
+
+        /// @brief Is the minimal kernel installed instead of the BIOS?
+        bool bios_free{ false };
+
+        /// @brief Has the guest exited?
+        bool has_exited{ false };
+
+        /// @brief Exit code of the guest
+        Word guest_exit_code{ 0 };
+
+        /// @brief Number of mismatches found in verification mode
+        unsigned int failures{ 0 };
+
+        /// @brief Verifications awaiting the return of their BIOS routine
+        std::vector<Verification> pending;
+
+        /// @brief Areas written to by the native replacement currently being
+        /// verified
+        std::vector<Area> journal;
+
+        /// @brief Is a native replacement being run for verification?
+        bool journaling{ false };
+
+        /// @brief Seed used by rand() and srand()
+        Word seed;
+
+        /// @brief CPU instance
+        CPU& cpu;
+
+        /// @brief System bus instance
+        SystemBus& bus;
+    };
+}
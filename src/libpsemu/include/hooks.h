@@ -0,0 +1,207 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <bitset>
+#include <functional>
+#include <vector>
+#include "types.h"
+
+namespace PlayStation
+{
+    /// @brief Defines what the system should do after a PC hook has run.
+    enum class HookAction
+    {
+        /// @brief Execute the instruction at the hooked address as usual.
+        Continue,
+
+        /// @brief The hook has redirected the CPU itself; the instruction at
+        /// the hooked address must not be executed.
+        Skip,
+
+        /// @brief Stop execution before the instruction at the hooked address
+        /// is executed.
+        Break
+    };
+
+    /// @brief Defines the memory accesses a watchpoint triggers on.
+    enum class WatchType
+    {
+        Read      = 1 << 0,
+        Write     = 1 << 1,
+        ReadWrite = Read | Write
+    };
+
+    /// @brief Defines a registry of PC breakpoints and memory watchpoints.
+    ///
+    /// All addresses are matched against their physical address, so a hook at
+    /// 0x000000A0 also triggers at 0x800000A0 and 0xA00000A0.
+    ///
+    /// Every hook marks the 4 KiB physical page(s) it covers. The execution
+    /// engine and the system bus only consult the registry proper if the page
+    /// of the address in question is marked, so unhooked addresses cost a
+    /// single bit test.
+    class Hooks final
+    {
+    public:
+        /// @brief Identifies a registered hook so it can be removed later.
+        using Handle = unsigned int;
+
+        /// @brief Callback invoked before the instruction at a hooked address
+        /// is executed.
+        /// @param paddr The physical address of the instruction.
+        /// @return What the system should do next.
+        using PCHook = std::function<HookAction(const Word paddr)>;
+
+        /// @brief Callback invoked when a watched memory area is accessed.
+        /// @param paddr The physical address of the access.
+        /// @param data The data that was read or is about to be written.
+        /// @param size The width of the access, in bytes.
+        /// @param type Whether this is a read or a write.
+        using WatchHook = std::function<void(const Word paddr,
+                                             const Word data,
+                                             const unsigned int size,
+                                             const WatchType type)>;
+
+        /// @brief Registers a PC breakpoint.
+        /// @param vaddr The address of the instruction to hook.
+        /// @param hook The function to call when the address is reached.
+        /// @return A handle that can be passed to `remove()`.
+        auto add_breakpoint(const Word vaddr, PCHook hook) noexcept -> Handle;
+
+        /// @brief Registers a memory watchpoint.
+        /// @param vaddr The first address of the area to watch.
+        /// @param length The number of bytes to watch.
+        /// @param type The accesses to trigger on.
+        /// @param hook The function to call when the area is accessed.
+        /// @return A handle that can be passed to `remove()`.
+        auto add_watchpoint(const Word vaddr,
+                            const Word length,
+                            const WatchType type,
+                            WatchHook hook) noexcept -> Handle;
+
+        /// @brief Removes a previously registered hook.
+        /// @param handle The handle returned when the hook was registered.
+        auto remove(const Handle handle) noexcept -> void;
+
+        /// @brief Removes all registered hooks.
+        auto clear() noexcept -> void;
+
+        /// @brief Determines if the page containing an instruction has any PC
+        /// hooks. This is consulted before every instruction.
+        /// @param vaddr The address of the instruction.
+        auto execute_hooked(const Word vaddr) const noexcept -> bool
+        {
+            return pc_pages[page(vaddr)];
+        }
+
+        /// @brief Determines if the page containing an address has any read
+        /// watchpoints.
+        /// @param paddr The physical address being read.
+        auto read_hooked(const Word paddr) const noexcept -> bool
+        {
+            return read_pages[page(paddr)];
+        }
+
+        /// @brief Determines if the page containing an address has any write
+        /// watchpoints.
+        /// @param paddr The physical address being written.
+        auto write_hooked(const Word paddr) const noexcept -> bool
+        {
+            return write_pages[page(paddr)];
+        }
+
+        /// @brief Runs the PC hooks registered at an address.
+        /// @param vaddr The address of the instruction about to be executed.
+        /// @return The most restrictive action requested by the hooks.
+        auto on_execute(const Word vaddr) noexcept -> HookAction;
+
+        /// @brief Runs the watchpoints covering a memory access.
+        /// @param paddr The physical address of the access.
+        /// @param data The data that was read or is about to be written.
+        /// @param size The width of the access, in bytes.
+        /// @param type Whether this is a read or a write.
+        auto on_access(const Word paddr,
+                       const Word data,
+                       const unsigned int size,
+                       const WatchType type) noexcept -> void;
+
+    private:
+        /// @brief log2 of the size of a hook page.
+        static constexpr auto PAGE_SHIFT{ 12 };
+
+        /// @brief Number of hook pages covering the physical address space.
+        static constexpr auto PAGE_COUNT{ 0x20000000 >> PAGE_SHIFT };
+
+        /// @brief Returns the hook page index of an address.
+        /// @param vaddr The address to convert.
+        static constexpr auto page(const Word vaddr) noexcept -> Word
+        {
+            return (vaddr & 0x1FFFFFFF) >> PAGE_SHIFT;
+        }
+
+        /// @brief Recomputes the page bitmaps after the set of hooks has
+        /// changed.
+        auto rebuild_pages() noexcept -> void;
+
+        struct Breakpoint
+        {
+            /// @brief Identifier of this hook
+            Handle handle;
+
+            /// @brief Physical address of the hooked instruction
+            Word paddr;
+
+            /// @brief The function to call when the address is reached
+            PCHook hook;
+        };
+
+        struct Watchpoint
+        {
+            /// @brief Identifier of this hook
+            Handle handle;
+
+            /// @brief First physical address of the watched area
+            Word paddr;
+
+            /// @brief Number of bytes in the watched area
+            Word length;
+
+            /// @brief The accesses to trigger on
+            WatchType type;
+
+            /// @brief The function to call when the area is accessed
+            WatchHook hook;
+        };
+
+        /// @brief Registered PC breakpoints
+        std::vector<Breakpoint> breakpoints;
+
+        /// @brief Registered memory watchpoints
+        std::vector<Watchpoint> watchpoints;
+
+        /// @brief Pages containing at least one PC breakpoint
+        std::bitset<PAGE_COUNT> pc_pages;
+
+        /// @brief Pages overlapped by at least one read watchpoint
+        std::bitset<PAGE_COUNT> read_pages;
+
+        /// @brief Pages overlapped by at least one write watchpoint
+        std::bitset<PAGE_COUNT> write_pages;
+
+        /// @brief The handle to give to the next registered hook
+        Handle next_handle{ 1 };
+    };
+}
@@ -0,0 +1,158 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "ps.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a harness running two systems in lockstep and reporting
+    /// the first point at which they diverge.
+    ///
+    /// The systems are expected to run the same program with different
+    /// execution engines or options. CPU registers are compared after every
+    /// instruction (or every block, i.e. whenever the first system doesn't
+    /// continue sequentially), and main RAM and VRAM after every frame.
+    ///
+    /// Systems with different HLE settings don't execute the same number of
+    /// instructions: one returns from a kernel call immediately, the other
+    /// runs the BIOS code. With `resync_kernel_calls` set, a system found to
+    /// be executing kernel code where the other isn't is run until it reaches
+    /// the same point, after which the registers a kernel call is free to
+    /// clobber are copied over from the other system and the kernel area of
+    /// RAM is excluded from comparison.
+    class Lockstep final
+    {
+    public:
+        /// @brief How often registers are compared.
+        enum class Granularity
+        {
+            /// @brief After every instruction
+            Instruction,
+
+            /// @brief After every jump or taken branch
+            Block
+        };
+
+        /// @brief Result of running the systems.
+        enum class Result
+        {
+            /// @brief The systems haven't diverged.
+            Continue,
+
+            /// @brief The systems have diverged, see `print_report()`.
+            Diverged,
+
+            /// @brief One of the systems has exited.
+            Exited
+        };
+
+        /// @brief Number of instructions kept in the history of each system
+        static constexpr std::size_t HISTORY_LENGTH{ 16 };
+
+        /// @brief Maximum number of instructions a system may take to catch
+        /// up with the other when resynchronizing.
+        static constexpr std::uint64_t RESYNC_LIMIT{ 10000000 };
+
+        /// @brief Initializes the harness.
+        /// @param a The reference system.
+        /// @param b The system under test.
+        Lockstep(System& a, System& b) noexcept;
+
+        /// @brief Executes one instruction on both systems and compares them
+        /// as configured.
+        auto step() noexcept -> Result;
+
+        /// @brief Executes one frame on both systems, comparing them as
+        /// configured, then compares main RAM and VRAM.
+        auto run_frame() noexcept -> Result;
+
+        /// @brief Prints the details of the divergence, along with the last
+        /// instructions executed by each system.
+        /// @param file The stream to print to.
+        auto print_report(FILE* file) const noexcept -> void;
+
+        /// @brief Returns the number of instructions executed by the
+        /// reference system so far.
+        auto instructions() const noexcept -> std::uint64_t;
+
+        /// @brief How often registers are compared
+        Granularity granularity{ Granularity::Instruction };
+
+        /// @brief Resynchronize the systems after kernel calls?
+        bool resync_kernel_calls{ false };
+
+    private:
+        /// @brief Defines an executed instruction.
+        struct Entry
+        {
+            /// @brief Address of the instruction
+            Word pc;
+
+            /// @brief The instruction
+            Word instruction;
+        };
+
+        /// @brief Defines a system and its recent history.
+        struct Side
+        {
+            /// @brief The system
+            System& system;
+
+            /// @brief The last `HISTORY_LENGTH` instructions executed
+            std::array<Entry, HISTORY_LENGTH> history;
+
+            /// @brief Number of instructions executed
+            std::uint64_t count;
+
+            /// @brief Executes one instruction, recording it.
+            /// @return `false` if the system has exited.
+            auto step() noexcept -> bool;
+        };
+
+        /// @brief Compares the CPU registers of the systems.
+        /// @return `false` if they differ.
+        auto compare_registers() noexcept -> bool;
+
+        /// @brief Compares main RAM and VRAM of the systems.
+        /// @return `false` if they differ.
+        auto compare_memory() noexcept -> bool;
+
+        /// @brief Runs the system that is executing kernel code until it
+        /// reaches the point where the other one is.
+        /// @return `false` if that didn't happen.
+        auto resync() noexcept -> bool;
+
+        /// @brief Reference system
+        Side a;
+
+        /// @brief System under test
+        Side b;
+
+        /// @brief Address of the last instruction executed by the reference
+        /// system
+        Word last_pc{ 0 };
+
+        /// @brief Number of instructions executed in the current frame
+        int frame_cycles{ 0 };
+
+        /// @brief Description of the divergence, if any
+        std::string divergence;
+    };
+}
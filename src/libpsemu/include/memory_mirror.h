@@ -0,0 +1,109 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "bus.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a copy of main RAM and VRAM, published at the end of
+    /// every frame, that other threads can read while the system keeps
+    /// running, e.g. for memory viewers or bots.
+    ///
+    /// The copy is double buffered: the system writes into one buffer while
+    /// readers use the other, and only pages written to since a buffer was
+    /// last published are copied into it. Each buffer is guarded by a
+    /// sequence lock, so readers never block the system; a read that
+    /// overlaps a write to its buffer (which takes the system a whole frame
+    /// to get around to) is simply retried.
+    class MemoryMirror final
+    {
+    public:
+        /// @brief Allocates both buffers.
+        MemoryMirror() noexcept;
+
+        MemoryMirror(const MemoryMirror&) = delete;
+        auto operator=(const MemoryMirror&) -> MemoryMirror& = delete;
+
+        /// @brief Publishes the current contents of main RAM and VRAM. This
+        /// is called by `System::run_frame()`, and must only ever be called
+        /// by the thread running the system.
+        /// @param bus The system bus to copy from.
+        auto publish(SystemBus& bus) noexcept -> void;
+
+        /// @brief Copies published main RAM. Safe to call from any thread.
+        /// @param paddr The physical address to start at.
+        /// @param data Where to copy the memory.
+        /// @param size The number of bytes to copy. The range must be within
+        /// main RAM.
+        /// @return The number of the frame the copy was published at, 0 if
+        /// nothing has been published yet.
+        auto read_ram(const Word paddr, Byte* data, const std::size_t size)
+        const noexcept -> std::uint64_t;
+
+        /// @brief Copies published VRAM. Safe to call from any thread.
+        /// @param pixels Where to copy VRAM, which must hold
+        /// `VRAM_WIDTH * VRAM_HEIGHT` pixels.
+        /// @return The number of the frame the copy was published at, 0 if
+        /// nothing has been published yet.
+        auto read_vram(Halfword* pixels) const noexcept -> std::uint64_t;
+
+        /// @brief Returns the number of the last frame published.
+        auto frame() const noexcept -> std::uint64_t;
+
+    private:
+        /// @brief One copy of main RAM and VRAM.
+        struct Buffer
+        {
+            /// @brief Odd while the buffer is being written to, incremented
+            /// before and after
+            std::atomic<std::uint64_t> sequence{ 0 };
+
+            /// @brief Number of the frame the buffer holds
+            std::atomic<std::uint64_t> frame{ 0 };
+
+            /// @brief Main RAM
+            std::vector<Byte> ram;
+
+            /// @brief VRAM
+            std::vector<Halfword> vram;
+
+            /// @brief Pages of main RAM this buffer is missing
+            std::array<bool, SystemBus::RAM_PAGES> ram_stale;
+
+            /// @brief Pages of VRAM this buffer is missing
+            std::array<bool, GPU::VRAM_PAGES> vram_stale;
+        };
+
+        /// @brief Copies published memory out of the current buffer,
+        /// retrying until the copy is consistent.
+        /// @param copy Function copying out of a buffer.
+        template<typename F>
+        auto read(F copy) const noexcept -> std::uint64_t;
+
+        /// @brief The buffers
+        std::array<Buffer, 2> buffers;
+
+        /// @brief Index of the buffer readers should use
+        std::atomic<unsigned int> current{ 0 };
+
+        /// @brief Number of frames published
+        std::uint64_t frames{ 0 };
+    };
+}
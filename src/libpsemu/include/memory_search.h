@@ -0,0 +1,127 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "bus.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a search of main RAM for values, e.g. to find where a
+    /// game keeps its health or score so that a cheat can be made for it.
+    ///
+    /// A search starts out with every aligned value of main RAM as a
+    /// candidate and is narrowed down by comparing the candidates, pass after
+    /// pass, against a constant or against their value at the previous pass.
+    /// Candidates are kept as a bitset, and each pass skips over the parts of
+    /// main RAM where none are left, so that a search can run every frame.
+    class MemorySearch final
+    {
+    public:
+        /// @brief Size of the values searched for.
+        enum class Width
+        {
+            /// @brief 8-bit values
+            Byte = 1,
+
+            /// @brief 16-bit values, at even addresses
+            Halfword = 2,
+
+            /// @brief 32-bit values, at addresses that are multiples of 4
+            Word = 4
+        };
+
+        /// @brief Comparisons to narrow a search with. Values are compared
+        /// as unsigned.
+        enum class Comparison
+        {
+            /// @brief The value is equal to the operand (unchanged, when
+            /// comparing against the previous pass).
+            Equal,
+
+            /// @brief The value differs from the operand (changed).
+            NotEqual,
+
+            /// @brief The value is greater than the operand (increased).
+            Greater,
+
+            /// @brief The value is less than the operand (decreased).
+            Less
+        };
+
+        /// @brief Starts a new search, with every value as a candidate.
+        /// @param bus The system bus whose main RAM to search.
+        /// @param width The size of the values to search for.
+        auto start(const SystemBus& bus, const Width width) noexcept -> void;
+
+        /// @brief Keeps the candidates whose value compares to their value at
+        /// the previous pass (or the start of the search) as asked.
+        /// @param bus The system bus whose main RAM to search.
+        /// @param comparison How to compare the values.
+        /// @return The number of candidates left, which is 0 until `start()` is
+        /// called.
+        auto compare_previous(const SystemBus& bus,
+                              const Comparison comparison) noexcept
+        -> std::size_t;
+
+        /// @brief Keeps the candidates whose value compares to a constant as
+        /// asked.
+        /// @param bus The system bus whose main RAM to search.
+        /// @param comparison How to compare the values.
+        /// @param value The constant to compare against. Only the lower bits
+        /// are used for values narrower than 32 bits.
+        /// @return The number of candidates left, which is 0 until `start()` is
+        /// called.
+        auto compare_value(const SystemBus& bus,
+                           const Comparison comparison,
+                           const Word value) noexcept -> std::size_t;
+
+        /// @brief Returns the number of candidates left.
+        auto count() const noexcept -> std::size_t;
+
+        /// @brief Lists the candidates left.
+        /// @param addresses Where to store the physical addresses of the
+        /// candidates, lowest first.
+        /// @param limit The maximum number of addresses to store.
+        auto results(std::vector<Word>& addresses,
+                     const std::size_t limit) const noexcept -> void;
+
+    private:
+        /// @brief Runs a pass over main RAM and remembers its contents for
+        /// the next one.
+        /// @param bus The system bus whose main RAM to search.
+        /// @param comparison How to compare the values.
+        /// @param against_value Compare against `value` rather than the
+        /// previous pass?
+        /// @param value The constant to compare against.
+        auto pass(const SystemBus& bus,
+                  const Comparison comparison,
+                  const bool against_value,
+                  const Word value) noexcept -> std::size_t;
+
+        /// @brief Size of the values searched for
+        Width width{ Width::Byte };
+
+        /// @brief One bit per value of main RAM, set for the candidates
+        std::vector<std::uint64_t> candidates;
+
+        /// @brief Contents of main RAM at the previous pass
+        std::vector<Byte> previous;
+
+        /// @brief Number of candidates left
+        std::size_t remaining{ 0 };
+    };
+}
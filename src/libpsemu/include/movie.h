@@ -0,0 +1,141 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.h"
+
+namespace PlayStation
+{
+    class System;
+
+    /// @brief Defines the input of one frame of a movie.
+    ///
+    /// A movie file begins with a 48 byte header: the magic "PSXMOVIE", the
+    /// format version (2), the size of a frame (16), the options and the
+    /// natively replaced HLE functions as little-endian 32-bit integers,
+    /// then the hashes of the BIOS, EXE and cheat codes as little-endian
+    /// 64-bit integers. Version 1 headers lack the hash of the cheat codes.
+    /// Frames follow, each consisting of these fields in little-endian.
+    struct MovieFrame
+    {
+        /// @brief Events happening before the frame.
+        enum Flags : Word
+        {
+            /// @brief The system was reset and booted again as it was at the
+            /// start of the movie.
+            Reset = 1 << 0
+        };
+
+        /// @brief Buttons held on each controller port, see `System::pads`
+        std::array<Halfword, 2> pads;
+
+        /// @brief Events, see `Flags`
+        Word flags;
+
+        /// @brief Hash of the state of the system at the end of the frame
+        /// (see `Movie::state_hash()`), or 0 if it wasn't recorded
+        std::uint64_t state_hash;
+    };
+
+    /// @brief Defines a recording of the input given to a system, frame by
+    /// frame, which can be played back to reproduce a run exactly.
+    ///
+    /// Along with the input, the hash of the state of the system at the end
+    /// of every frame is recorded, so that playback can tell exactly where it
+    /// stopped reproducing the recording, e.g. because of a change to the
+    /// emulator.
+    class Movie final
+    {
+    public:
+        /// @brief Emulator options a movie was recorded with.
+        enum Options : Word
+        {
+            /// @brief The EXE was started without the BIOS (see
+            /// `System::fast_boot()`).
+            FastBoot = 1 << 0
+        };
+
+        /// @brief Returns a 64-bit hash of data, e.g. the BIOS or the EXE.
+        /// @param data The data to hash.
+        /// @param size The size of the data, in bytes.
+        static auto hash(const Byte* data, const std::size_t size) noexcept
+        -> std::uint64_t;
+
+        /// @brief Returns a hash of the state of a system: its CPU registers,
+        /// main RAM and VRAM.
+        /// @param system The system to hash.
+        static auto state_hash(const System& system) noexcept
+        -> std::uint64_t;
+
+        /// @brief Reads a movie file.
+        /// @param path The path of the file to read.
+        /// @return `false` if the file couldn't be read or is not a movie.
+        auto load(const std::string& path) noexcept -> bool;
+
+        /// @brief Writes the movie to a file, replacing its contents.
+        /// @param path The path of the file to write.
+        /// @return `false` if the file couldn't be written.
+        auto save(const std::string& path) const noexcept -> bool;
+
+        /// @brief Records the options of a system, and the cheat codes it
+        /// applies.
+        /// @param system The system to record.
+        /// @param fast_boot Was the EXE started without the BIOS?
+        auto record_options(const System& system, const bool fast_boot)
+        noexcept -> void;
+
+        /// @brief Applies the recorded options to a system.
+        /// @param system The system to change.
+        auto apply_options(System& system) const noexcept -> void;
+
+        /// @brief Records a frame which has just been run.
+        /// @param system The system that ran it.
+        /// @param flags The events that happened before the frame.
+        auto record_frame(const System& system, const Word flags = 0) noexcept
+        -> void;
+
+        /// @brief Checks that a frame which has just been played back ended
+        /// in the same state as it was recorded in.
+        /// @param system The system that ran it.
+        /// @param frame The index of the frame.
+        /// @return `false` if the state differs.
+        auto check_frame(const System& system, const std::size_t frame) const
+        noexcept -> bool;
+
+        /// @brief Emulator options, see `Options`
+        Word options{ 0 };
+
+        /// @brief Natively replaced HLE functions, one bit per
+        /// `HLE::Function`
+        Word hle_functions{ 0 };
+
+        /// @brief Hash of the BIOS, or 0 if there was none
+        std::uint64_t bios_hash{ 0 };
+
+        /// @brief Hash of the EXE
+        std::uint64_t exe_hash{ 0 };
+
+        /// @brief Hash of the cheat codes applied (see `Cheats::hash()`), or 0
+        /// if there were none
+        std::uint64_t cheats_hash{ 0 };
+
+        /// @brief Recorded frames
+        std::vector<MovieFrame> frames;
+    };
+}
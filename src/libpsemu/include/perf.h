@@ -0,0 +1,171 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace PlayStation
+{
+    /// @brief Defines performance counters of the emulator.
+    ///
+    /// The raw counters are updated once per frame and as subsystems are
+    /// timed; the rates derived from them are only recomputed every
+    /// `UPDATE_INTERVAL`, so that they are stable enough to be displayed.
+    class Perf final
+    {
+    public:
+        /// @brief Clock used for measuring host time
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Parts of the emulator host time is measured for.
+        enum Subsystem
+        {
+            /// @brief The CPU and everything it does not otherwise account
+            /// for, such as memory accesses.
+            CPU,
+
+            /// @brief GP0 and GP1 commands
+            GPU,
+
+            /// @brief Time spent between frames, outside of the emulator
+            Frontend,
+
+            SubsystemCount
+        };
+
+        /// @brief Defines the rates derived from the counters.
+        struct Counters
+        {
+            /// @brief Emulated instructions per second
+            double instructions_per_second{ 0.0 };
+
+            /// @brief Emulated frames per second
+            double frames_per_second{ 0.0 };
+
+            /// @brief Emulation speed, in percent of real time
+            double speed{ 0.0 };
+
+            /// @brief Average host time per frame, in milliseconds, indexed
+            /// by `Subsystem`
+            std::array<double, SubsystemCount> frame_time{ };
+
+            /// @brief Number of times the rates have been computed, which
+            /// tells readers polling them whether or not they changed
+            std::uint64_t updates{ 0 };
+        };
+
+        /// @brief Measures the host time of a subsystem for as long as the
+        /// object lives.
+        class Scope final
+        {
+        public:
+            /// @brief Starts measuring.
+            /// @param p The counters to add the time to, if any.
+            /// @param s The subsystem to add the time to.
+            Scope(Perf* p, const Subsystem s) noexcept : perf(p), subsystem(s)
+            {
+                if (perf)
+                {
+                    start = Clock::now();
+                }
+            }
+
+            /// @brief Stops measuring.
+            ~Scope() noexcept
+            {
+                if (perf)
+                {
+                    perf->time[subsystem] += Clock::now() - start;
+                }
+            }
+
+        private:
+            /// @brief The counters to add the time to
+            Perf* perf;
+
+            /// @brief The subsystem to add the time to
+            Subsystem subsystem;
+
+            /// @brief When measuring started
+            Clock::time_point start;
+        };
+
+        /// @brief Interval at which the rates are recomputed
+        static constexpr std::chrono::milliseconds UPDATE_INTERVAL{ 500 };
+
+        /// @brief Refresh rate of the emulated system, in Hz
+        static constexpr double REFRESH_RATE{ 60.0 };
+
+        /// @brief Discards everything measured so far.
+        auto reset() noexcept -> void;
+
+        /// @brief Marks the beginning of an emulated frame.
+        auto begin_frame() noexcept -> void;
+
+        /// @brief Marks the end of an emulated frame.
+        /// @param count The number of instructions executed during the frame.
+        /// @return `true` if the rates were recomputed.
+        auto end_frame(const std::uint64_t count) noexcept -> bool;
+
+        /// @brief Returns the rates as of the last update.
+        auto counters() const noexcept -> const Counters&;
+
+        /// @brief Returns the peak resident set size of the process.
+        /// @return The size in bytes, or 0 if it can't be determined on this
+        /// platform.
+        static auto peak_rss() noexcept -> std::size_t;
+
+        /// @brief Prints the results of a benchmark run: wall time, emulated
+        /// frames per second, MIPS and peak resident set size.
+        /// @param file The stream to print to.
+        /// @param frames The number of frames emulated.
+        /// @param instructions The number of instructions executed.
+        /// @param time The wall time the frames took.
+        static auto print_benchmark(FILE* file,
+                                    const std::uint64_t frames,
+                                    const std::uint64_t instructions,
+                                    const Clock::duration time) noexcept
+        -> void;
+
+    private:
+        /// @brief Host time measured during the current interval, indexed by
+        /// `Subsystem`
+        std::array<Clock::duration, SubsystemCount> time{ };
+
+        /// @brief Start of the current interval
+        Clock::time_point interval_start;
+
+        /// @brief Start of the current frame
+        Clock::time_point frame_start;
+
+        /// @brief End of the last frame
+        Clock::time_point frame_end;
+
+        /// @brief Have we seen a frame since the last reset?
+        bool started{ false };
+
+        /// @brief Instructions executed during the current interval
+        std::uint64_t instructions{ 0 };
+
+        /// @brief Frames emulated during the current interval
+        std::uint64_t frames{ 0 };
+
+        /// @brief Rates as of the last update
+        Counters current;
+    };
+}
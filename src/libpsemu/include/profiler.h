@@ -0,0 +1,180 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "types.h"
+
+namespace PlayStation
+{
+    class CPU;
+    class SystemBus;
+
+    /// @brief Defines a call graph profiler for guest code.
+    ///
+    /// A shadow call stack is maintained by watching for JAL and JALR, which
+    /// push a frame, and JR $ra, which pops the frame it returns to, once
+    /// their delay slot has executed. Every instruction executed is
+    /// attributed to the function on top of the stack, and the instructions
+    /// executed between a call and its return are attributed to the call
+    /// itself, which gives the inclusive cost.
+    ///
+    /// Guest code doesn't always return the way it was called: a HLE function
+    /// returns without executing JR $ra, and longjmp() returns to a frame
+    /// further down the stack. Frames are therefore also popped whenever
+    /// their return address is reached, and a JR $ra that doesn't return to
+    /// any frame on the stack pops every frame whose stack pointer has been
+    /// unwound.
+    ///
+    /// The cost of an instruction is one, as the emulator doesn't count
+    /// cycles yet.
+    class Profiler final
+    {
+    public:
+        /// @brief Initializes the profiler.
+        /// @param c The CPU to profile.
+        /// @param b The system bus instance.
+        explicit Profiler(CPU& c, SystemBus& b) noexcept;
+
+        /// @brief Discards all data collected so far.
+        auto reset() noexcept -> void;
+
+        /// @brief Accounts for the instruction the CPU is about to execute.
+        auto step() noexcept -> void;
+
+        /// @brief Names a function in the output.
+        /// @param address The address of the function.
+        /// @param name The name of the function.
+        auto add_symbol(const Word address, const std::string& name) noexcept
+        -> void;
+
+        /// @brief Loads function names from a file. Every line is expected to
+        /// be either "address name" or "address type name" (as printed by
+        /// `nm`), with the address in hexadecimal.
+        /// @param path The path of the file to read.
+        /// @return `false` if the file couldn't be opened.
+        auto load_symbols(const std::string& path) noexcept -> bool;
+
+        /// @brief Writes the profile in callgrind format, for use with tools
+        /// such as KCachegrind.
+        /// @param file The stream to write to.
+        auto write_callgrind(FILE* file) const noexcept -> void;
+
+        /// @brief Writes the profile in callgrind format to a file.
+        /// @param path The path of the file to write to.
+        /// @return `false` if the file couldn't be opened.
+        auto write_callgrind(const std::string& path) const noexcept -> bool;
+
+    private:
+        /// @brief Defines the calls from one function to another.
+        struct Calls
+        {
+            /// @brief Number of calls
+            std::uint64_t count{ 0 };
+
+            /// @brief Instructions executed by the callee and its callees
+            std::uint64_t inclusive{ 0 };
+        };
+
+        /// @brief Defines what we know about a function.
+        struct Function
+        {
+            /// @brief Instructions executed by this function itself
+            std::uint64_t exclusive{ 0 };
+
+            /// @brief Calls made by this function, indexed by callee address
+            std::unordered_map<Word, Calls> calls;
+        };
+
+        /// @brief Defines an entry in the shadow call stack.
+        struct Frame
+        {
+            /// @brief The address of the function that was called
+            Word address;
+
+            /// @brief The function that was called
+            Function* function;
+
+            /// @brief The address the function is expected to return to
+            Word return_address;
+
+            /// @brief The value of $sp at the time of the call
+            Word sp;
+
+            /// @brief The number of instructions executed before the call
+            std::uint64_t start;
+        };
+
+        /// @brief Defines a call or return waiting for its delay slot.
+        struct Jump
+        {
+            /// @brief Is this a call, or a return?
+            bool call;
+
+            /// @brief The address jumped to
+            Word target;
+
+            /// @brief The address a call returns to
+            Word return_address;
+        };
+
+        /// @brief Pushes a frame onto the shadow call stack.
+        /// @param address The address of the function being called.
+        /// @param return_address The address the call returns to.
+        auto push(const Word address, const Word return_address) noexcept
+        -> void;
+
+        /// @brief Pops the frames a return leaves.
+        /// @param target The address returned to.
+        auto unwind(const Word target) noexcept -> void;
+
+        /// @brief Pops the frame on top of the shadow call stack.
+        auto pop() noexcept -> void;
+
+        /// @brief Returns the name of a function.
+        /// @param address The address of the function.
+        auto name(const Word address) const noexcept -> std::string;
+
+        /// @brief CPU instance
+        CPU& cpu;
+
+        /// @brief System bus instance
+        SystemBus& bus;
+
+        /// @brief Every function seen so far, indexed by address
+        std::unordered_map<Word, Function> functions;
+
+        /// @brief Shadow call stack. The bottom frame is the code that was
+        /// running when profiling started and is never popped.
+        std::vector<Frame> stack;
+
+        /// @brief The last call or return seen
+        Jump jump{ };
+
+        /// @brief Steps until `jump` takes effect: 2 after the jump itself, 1
+        /// after its delay slot, 0 once it has
+        int jump_delay{ 0 };
+
+        /// @brief Function names, indexed by address
+        std::unordered_map<Word, std::string> symbols;
+
+        /// @brief Number of instructions executed
+        std::uint64_t instructions{ 0 };
+    };
+}
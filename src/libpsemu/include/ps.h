@@ -14,8 +14,18 @@
 
 #pragma once
 
+#include <functional>
 #include "bus.h"
+#include "cheats.h"
+#include "coverage.h"
 #include "cpu.h"
+#include "exe.h"
+#include "frame_export.h"
+#include "hle.h"
+#include "memory_mirror.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "tty.h"
 
 namespace PlayStation
 {
@@ -35,12 +45,111 @@ namespace PlayStation
         auto reset() noexcept -> void;
 
         /// @brief Executes one full system step.
-        auto step() noexcept -> void;
+        /// @return `false` if a breakpoint stopped execution before the
+        /// current instruction, `true` otherwise. Calling this function again
+        /// after a breakpoint resumes execution past it.
+        auto step() noexcept -> bool;
+
+        /// @brief Loads a PS-X EXE into main RAM and jumps to its entry
+        /// point, as the BIOS shell would.
+        /// @param exe The EXE to load.
+        auto load_exe(const EXE& exe) noexcept -> void;
+
+        /// @brief Starts a PS-X EXE without executing the BIOS at all.
+        ///
+        /// The system is reset and the minimal kernel of the HLE layer is
+        /// installed in place of the BIOS. The EXE is then loaded, returning
+        /// to `HLE::EXIT_ADDRESS` when it is done. Programs that depend on
+        /// BIOS functions other than those the HLE layer knows about will not
+        /// work correctly.
+        /// @param exe The EXE to start.
+        auto fast_boot(const EXE& exe) noexcept -> void;
+
+        /// @brief Starts a PS-X EXE through the BIOS, which must have been
+        /// set.
+        ///
+        /// The system is reset and runs until the BIOS reaches
+        /// `SHELL_ADDRESS`, where the EXE is loaded in place of the shell.
+        /// @param exe The EXE to start.
+        /// @return `false` if the BIOS didn't reach `SHELL_ADDRESS` within
+        /// `BOOT_FRAME_LIMIT` frames, in which case the EXE isn't loaded.
+        auto boot_exe(const EXE& exe) noexcept -> bool;
+
+        /// @brief Runs the system for one frame.
+        /// @return `false` if a breakpoint stopped execution before the end of
+        /// the frame, `true` otherwise.
+        auto run_frame() noexcept -> bool;
+
+        /// @brief Address the BIOS jumps to once the kernel has been
+        /// initialized, which is the earliest point an EXE can be injected
+        static constexpr Word SHELL_ADDRESS{ 0x80030000 };
+
+        /// @brief Frames the BIOS is given to reach `SHELL_ADDRESS` (10
+        /// seconds), far more than it takes to initialize the kernel
+        static constexpr unsigned int BOOT_FRAME_LIMIT{ 600 };
+
+        /// @brief Number of steps in one frame (33.8688MHz / 60Hz)
+        static constexpr auto CYCLES_PER_FRAME{ 33868800 / 60 };
+
+        /// @brief Buttons held on each controller port, active low as the
+        /// hardware reports them. Frontends (or a movie being played back)
+        /// set these before each frame; nothing reads them until controllers
+        /// are emulated.
+        std::array<Halfword, 2> pads{ 0xFFFF, 0xFFFF };
 
         /// @brief System bus instance
         SystemBus bus;
 
         /// @brief CPU instance
         CPU cpu;
+
+        /// @brief BIOS kernel function HLE instance
+        HLE hle;
+
+        /// @brief Guest TTY output
+        TTY tty;
+
+        /// @brief Performance counters, updated by `run_frame()`. GPU time is
+        /// only measured once `bus.perf` points to these, as timing every
+        /// GP0/GP1 write slows the GPU down considerably.
+        Perf perf;
+
+        /// @brief Profiler to notify of every instruction executed, if any
+        Profiler* profiler{ nullptr };
+
+        /// @brief Coverage collector to notify of every instruction executed,
+        /// if any
+        Coverage* coverage{ nullptr };
+
+        /// @brief Cheat codes to apply at the end of every frame completed by
+        /// `run_frame()`, if any
+        Cheats* cheats{ nullptr };
+
+        /// @brief Frame ring to publish every frame completed by
+        /// `run_frame()` to, if any
+        FrameExport* frame_export{ nullptr };
+
+        /// @brief Recorder to queue every frame completed by `run_frame()`
+        /// to, if any
+        Recorder* recorder{ nullptr };
+
+        /// @brief Mirror to publish main RAM and VRAM to at the end of every
+        /// frame completed by `run_frame()`, if any
+        MemoryMirror* mirror{ nullptr };
+
+        /// @brief Called after every instruction executed, e.g. to trace
+        /// execution.
+        /// @param pc The address of the instruction.
+        std::function<void(const Word pc)> on_instruction;
+
+    private:
+        friend class Snapshot;
+
+        /// @brief The address of the breakpoint that last stopped execution,
+        /// which must not stop it again when execution is resumed.
+        Word break_pc{ 0xFFFFFFFF };
+
+        /// @brief Number of steps taken in the current frame
+        int frame_cycles{ 0 };
     };
 }
@@ -0,0 +1,151 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "types.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a recorder of the frames displayed to a video file.
+    ///
+    /// Frames are copied into a bounded queue by `push()` and converted and
+    /// written by a background thread, so the emulator never waits for the
+    /// disk. When the queue is full the frame is dropped and counted instead,
+    /// unless `drop_frames` is cleared.
+    ///
+    /// Files ending in ".y4m" are written directly as YUV4MPEG2 (4:4:4,
+    /// BT.601). Anything else is encoded losslessly to FFV1 by piping raw
+    /// frames to `ffmpeg`, which must be in the `PATH`. As there is no display
+    /// area emulation yet, a frame is all of VRAM.
+    class Recorder final
+    {
+    public:
+        /// @brief Number of frames queued when no length is given
+        static constexpr std::size_t DEFAULT_QUEUE_LENGTH{ 16 };
+
+        /// @brief Frame rate of the video (see `System::CYCLES_PER_FRAME`)
+        static constexpr unsigned int FRAME_RATE{ 60 };
+
+        Recorder() noexcept = default;
+        Recorder(const Recorder&) = delete;
+        auto operator=(const Recorder&) -> Recorder& = delete;
+
+        /// @brief Finishes the recording, if any, see `close()`.
+        ~Recorder() noexcept;
+
+        /// @brief Starts recording to a file, replacing it.
+        /// @param path The path of the file to write.
+        /// @param queue_length The number of frames that may be waiting to be
+        /// written before frames are dropped.
+        /// @return `false` if the file or encoder couldn't be opened.
+        auto open(const std::string& path,
+                  const std::size_t queue_length = DEFAULT_QUEUE_LENGTH)
+        noexcept -> bool;
+
+        /// @brief Writes the frames still queued and closes the file.
+        /// @return `false` if anything couldn't be written.
+        auto close() noexcept -> bool;
+
+        /// @brief Queues a frame for writing, without waiting unless
+        /// `drop_frames` is cleared.
+        /// @param vram The contents of VRAM at the end of the frame.
+        /// @return `false` if the frame was dropped, or nothing is being
+        /// recorded.
+        auto push(const VRAM& vram) noexcept -> bool;
+
+        /// @brief Returns the number of frames written so far.
+        auto recorded() const noexcept -> std::uint64_t;
+
+        /// @brief Returns the number of frames dropped so far.
+        auto dropped() const noexcept -> std::uint64_t;
+
+        /// @brief Drop frames when the queue is full? Offline rendering would
+        /// rather wait for the writer to catch up.
+        bool drop_frames{ true };
+
+    private:
+        /// @brief Output formats.
+        enum class Format
+        {
+            /// @brief YUV4MPEG2, converted here
+            Y4M,
+
+            /// @brief Raw frames piped to an FFV1 encoder
+            FFV1
+        };
+
+        /// @brief Background thread entry point: converts and writes queued
+        /// frames until the recording is closed, then closes the file. Frames
+        /// queued after a write failed are dropped.
+        auto writer() noexcept -> void;
+
+        /// @brief Writes a frame to the file.
+        /// @param frame The frame to write.
+        /// @return `false` if it couldn't be written.
+        auto write_frame(const VRAM& frame) noexcept -> bool;
+
+        /// @brief The file or pipe written to
+        FILE* file{ nullptr };
+
+        /// @brief The output format
+        Format format{ Format::Y4M };
+
+        /// @brief Frame buffers making up the queue
+        std::vector<VRAM> queue;
+
+        /// @brief Index of the oldest queued frame
+        std::size_t head{ 0 };
+
+        /// @brief Number of queued frames
+        std::size_t count{ 0 };
+
+        /// @brief Has `close()` been called?
+        bool stopping{ false };
+
+        /// @brief Has a write failed? No more frames are written after that.
+        bool failed{ false };
+
+        /// @brief Number of frames written
+        std::uint64_t frames_recorded{ 0 };
+
+        /// @brief Number of frames dropped
+        std::uint64_t frames_dropped{ 0 };
+
+        /// @brief Guards the queue indices, flags and counters
+        mutable std::mutex mutex;
+
+        /// @brief Signalled when a frame is queued or the recording closed
+        std::condition_variable queued;
+
+        /// @brief Signalled when a frame has been written
+        std::condition_variable written;
+
+        /// @brief YUV 4:4:4 value of every A1B5G5R5 pixel, packed as 0x00YYUUVV
+        std::vector<std::uint32_t> yuv;
+
+        /// @brief Planes of the frame being converted
+        std::vector<Byte> planes;
+
+        /// @brief The writer thread
+        std::thread thread;
+    };
+}
@@ -0,0 +1,180 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "ps.h"
+
+namespace PlayStation
+{
+    /// @brief Defines a copy of the state of a system that can be restored
+    /// quickly and repeatedly, e.g. between the runs of a fuzzer.
+    ///
+    /// Restoring copies the CPU, GPU and HLE state in full, but only those
+    /// pages of main RAM and VRAM that have been written to since the
+    /// snapshot was captured or last restored. Code that writes to main RAM
+    /// without going through the bus must call `SystemBus::mark_dirty()` for
+    /// this to work.
+    ///
+    /// Hooks, the BIOS and pending HLE verifications are not part of the
+    /// snapshot.
+    class Snapshot final
+    {
+    public:
+        /// @brief Captures the state of a system, and starts tracking the
+        /// pages it writes to.
+        /// @param system The system to capture.
+        auto capture(System& system) noexcept -> void;
+
+        /// @brief Restores a system to the captured state.
+        /// @param system The system to restore, which must be the one the
+        /// snapshot was captured from.
+        /// @return The number of pages of main RAM and VRAM copied.
+        auto restore(System& system) const noexcept -> std::size_t;
+
+        /// @brief Restores the captured state in full into any system, e.g. a
+        /// fresh one running on another thread. The system must use the same
+        /// BIOS as the one the snapshot was captured from.
+        /// @param system The system to restore.
+        auto load(System& system) const noexcept -> void;
+
+        /// @brief Returns the size of the data written by `serialize()`,
+        /// which is the same for every snapshot.
+        static auto serialized_size() noexcept -> std::size_t;
+
+        /// @brief Writes the captured state to memory, e.g. for a save state.
+        /// The format is specific to this version of the emulator.
+        /// @param data Where to write `serialized_size()` bytes.
+        auto serialize(Byte* data) const noexcept -> void;
+
+        /// @brief Writes the state of a system to memory in the format of
+        /// `serialize()`, copying its memory once rather than capturing it
+        /// first. Only the registers are captured into the snapshot, which
+        /// must be captured or unserialized again before it is restored or
+        /// loaded.
+        /// @param system The system to write the state of.
+        /// @param data Where to write `serialized_size()` bytes.
+        auto serialize(const System& system, Byte* data) noexcept -> void;
+
+        /// @brief Reads state written by `serialize()` into the snapshot,
+        /// which can then be loaded into a system.
+        /// @param data The state to read.
+        /// @param size The size of the state, in bytes.
+        /// @return `false` if the data is not a serialized snapshot, or
+        /// describes a state the system can't be in.
+        auto unserialize(const Byte* data, const std::size_t size) noexcept
+        -> bool;
+
+    private:
+        /// @brief Captures the state of a system other than its memory.
+        /// @param system The system to capture.
+        auto capture_registers(const System& system) noexcept -> void;
+
+        /// @brief Writes the captured registers and the given memory in the
+        /// format of `serialize()`.
+        /// @param data Where to write `serialized_size()` bytes.
+        /// @param ram_data Main RAM.
+        /// @param scratchpad_data The scratchpad.
+        /// @param vram_data VRAM.
+        auto write(Byte* data,
+                   const Byte* ram_data,
+                   const Byte* scratchpad_data,
+                   const Halfword* vram_data) const noexcept -> void;
+
+        /// @brief Determines if the GP0 command state is one the GPU can be
+        /// in, so that it can't index outside of its parameters.
+        auto valid_command() const noexcept -> bool;
+
+        /// @brief Main RAM
+        std::vector<Byte> ram;
+
+        /// @brief Scratchpad
+        std::array<Byte, SCRATCHPAD_SIZE> scratchpad;
+
+        /// @brief VRAM
+        std::vector<Halfword> vram;
+
+        /// @brief CPU state
+        struct
+        {
+            /// @brief General purpose registers
+            std::array<Word, 32> gpr;
+
+            /// @brief Program counter
+            Word pc;
+
+            /// @brief Next program counter
+            Word next_pc;
+
+            /// @brief HI register
+            Word hi;
+
+            /// @brief LO register
+            Word lo;
+
+            /// @brief Current instruction
+            Word instruction;
+
+            /// @brief System control co-processor registers
+            decltype(CPU::cop0) cop0;
+
+            /// @brief Register a pending load is to, or -1 if there is none
+            int delay_slot_reg;
+
+            /// @brief Value of the pending load
+            Word delay_slot_value;
+
+            /// @brief Instructions before the pending load completes
+            unsigned int delay_slot_instrs;
+        } cpu;
+
+        /// @brief GPU state, other than VRAM
+        struct
+        {
+            /// @brief GPUREAD register
+            Word gpuread;
+
+            /// @brief GP0 port state
+            GPU::GP0State gp0_state;
+
+            /// @brief Current GP0 command data
+            decltype(GPU::cmd) cmd;
+        } gpu;
+
+        /// @brief HLE state
+        struct
+        {
+            /// @brief Is the minimal kernel installed?
+            bool bios_free;
+
+            /// @brief Has the guest exited?
+            bool has_exited;
+
+            /// @brief Exit code of the guest
+            Word guest_exit_code;
+
+            /// @brief Seed used by rand() and srand()
+            Word seed;
+        } hle;
+
+        /// @brief Address of the breakpoint that last stopped the system
+        Word break_pc;
+
+        /// @brief Number of steps taken in the current frame
+        int frame_cycles;
+    };
+}
@@ -0,0 +1,140 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "types.h"
+
+namespace PlayStation
+{
+#ifdef PSEMU_ENABLE_STATS
+    /// @brief Are the statistics counters compiled in?
+    constexpr bool STATS_ENABLED{ true };
+#else
+    /// @brief Are the statistics counters compiled in?
+    constexpr bool STATS_ENABLED{ false };
+#endif
+
+    /// @brief Defines counters of executed instructions, memory accesses and
+    /// exceptions.
+    ///
+    /// The counters are only updated if the library was built with
+    /// `PSEMU_ENABLE_STATS`; otherwise every call site is compiled out. They
+    /// are kept per thread (see `this_thread`) so that counting doesn't need
+    /// any synchronization; every system running on a thread adds to the
+    /// same counters.
+    class Stats final
+    {
+    public:
+        /// @brief Memory regions accesses are counted by.
+        enum Region
+        {
+            RAM,
+            Expansion1,
+            Scratchpad,
+            MemoryControl,
+            Peripheral,
+            InterruptControl,
+            DMA,
+            Timers,
+            CDROM,
+            GPU,
+            MDEC,
+            SPU,
+            Expansion2,
+            BIOS,
+            CacheControl,
+            Unknown,
+            RegionCount
+        };
+
+        /// @brief Counts an instruction about to be executed.
+        /// @param word The instruction.
+        auto instruction(const Word word) noexcept -> void
+        {
+            const auto op{ word >> 26 };
+
+            instructions++;
+
+            if (op == 0x00)
+            {
+                special[word & 0x3F]++;
+            }
+            else
+            {
+                opcodes[op]++;
+            }
+        }
+
+        /// @brief Counts a load or store.
+        /// @param paddr The physical address accessed.
+        /// @param size The width of the access, in bytes.
+        /// @param store Is this a store?
+        auto access(const Word paddr,
+                    const unsigned int size,
+                    const bool store) noexcept -> void
+        {
+            // 1, 2 and 4 bytes map to 0, 1 and 2 respectively.
+            accesses[store][region(paddr)][size >> 1]++;
+        }
+
+        /// @brief Counts an exception.
+        /// @param code The exception code (as stored in the Cause register).
+        auto exception(const Word code) noexcept -> void
+        {
+            exceptions[code & 0x1F]++;
+        }
+
+        /// @brief Determines which region a physical address belongs to.
+        /// @param paddr The physical address.
+        static auto region(const Word paddr) noexcept -> Region;
+
+        /// @brief Resets every counter to zero.
+        auto reset() noexcept -> void;
+
+        /// @brief Writes every counter as a JSON object.
+        /// @param file The stream to write to.
+        auto write_json(FILE* file) const noexcept -> void;
+
+        /// @brief Writes every counter as a JSON object to a file.
+        /// @param path The path of the file to write to.
+        /// @return `false` if the file couldn't be opened.
+        auto write_json(const std::string& path) const noexcept -> bool;
+
+        /// @brief Counters of the calling thread
+        static thread_local Stats this_thread;
+
+    private:
+        /// @brief Number of instructions executed
+        std::uint64_t instructions{ 0 };
+
+        /// @brief Number of instructions executed, indexed by opcode
+        std::array<std::uint64_t, 64> opcodes{ };
+
+        /// @brief Number of SPECIAL instructions executed, indexed by funct
+        std::array<std::uint64_t, 64> special{ };
+
+        /// @brief Number of accesses, indexed by load (0) or store (1), then
+        /// region, then width (byte, halfword, word)
+        std::array<std::array<std::array<std::uint64_t, 3>, RegionCount>, 2>
+        accesses{ };
+
+        /// @brief Number of exceptions, indexed by exception code
+        std::array<std::uint64_t, 32> exceptions{ };
+    };
+}
@@ -0,0 +1,34 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include "types.h"
+
+namespace PlayStation
+{
+    /// @brief Function names, indexed by address
+    using Symbols = std::map<Word, std::string>;
+
+    /// @brief Reads function names from a file. Every line is expected to be
+    /// either "address name" or "address type name" (as printed by `nm`),
+    /// with the address in hexadecimal.
+    /// @param path The path of the file to read.
+    /// @param symbols Where to add the names.
+    /// @return `false` if the file couldn't be opened.
+    auto read_symbols(const std::string& path, Symbols& symbols) noexcept
+    -> bool;
+}
@@ -0,0 +1,144 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "types.h"
+
+namespace PlayStation
+{
+    class CPU;
+
+    /// @brief Defines one instruction of a binary execution trace.
+    ///
+    /// A trace file begins with a 16 byte header: the magic "PSXTRACE",
+    /// followed by the format version (1) and the size of a record (140) as
+    /// little-endian 32-bit integers. Records follow, one per instruction
+    /// executed, each consisting of these fields as little-endian 32-bit
+    /// integers. The registers are those visible after the instruction at
+    /// `pc` was executed; a load still in its delay slot is not visible yet.
+    struct TraceRecord
+    {
+        /// @brief Address of the instruction
+        Word pc;
+
+        /// @brief General purpose registers
+        std::array<Word, 32> gpr;
+
+        /// @brief HI register
+        Word hi;
+
+        /// @brief LO register
+        Word lo;
+    };
+
+    /// @brief Format version written to and expected in the header
+    constexpr Word TRACE_VERSION{ 1 };
+
+    /// @brief Defines a reader of trace files, which are mapped into memory
+    /// rather than read, and released as they are consumed, so that traces
+    /// of any size can be streamed.
+    class TraceReader final
+    {
+    public:
+        TraceReader() noexcept = default;
+
+        /// @brief Closes the trace.
+        ~TraceReader() noexcept;
+
+        TraceReader(const TraceReader&) = delete;
+        auto operator=(const TraceReader&) -> TraceReader& = delete;
+
+        /// @brief Opens a trace file.
+        /// @param path The path of the file to open.
+        /// @return `false` if the file couldn't be opened or is not a trace.
+        auto open(const std::string& path) noexcept -> bool;
+
+        /// @brief Closes the trace.
+        auto close() noexcept -> void;
+
+        /// @brief Reads the next record.
+        /// @param record Where to store the record.
+        /// @return `false` if there are no records left.
+        auto next(TraceRecord& record) noexcept -> bool;
+
+        /// @brief Returns the number of records read so far.
+        auto position() const noexcept -> std::uint64_t;
+
+        /// @brief Returns the total number of records in the trace.
+        auto size() const noexcept -> std::uint64_t;
+
+    private:
+        /// @brief Releases the pages of the mapping that have been read.
+        auto release() noexcept -> void;
+
+        /// @brief Beginning of the mapping
+        const Byte* data{ nullptr };
+
+        /// @brief Size of the mapping, in bytes
+        std::size_t length{ 0 };
+
+        /// @brief Offset of the next record
+        std::size_t offset{ 0 };
+
+        /// @brief Offset up to which the mapping has been released
+        std::size_t released{ 0 };
+
+        /// @brief Number of records read
+        std::uint64_t count{ 0 };
+
+#if !defined(__unix__) && !defined(__APPLE__)
+        /// @brief File the records are read from, on hosts without mmap()
+        FILE* file{ nullptr };
+#endif
+    };
+
+    /// @brief Defines a writer of trace files.
+    class TraceWriter final
+    {
+    public:
+        TraceWriter() noexcept = default;
+
+        /// @brief Flushes and closes the trace.
+        ~TraceWriter() noexcept;
+
+        TraceWriter(const TraceWriter&) = delete;
+        auto operator=(const TraceWriter&) -> TraceWriter& = delete;
+
+        /// @brief Creates a trace file, replacing its contents.
+        /// @param path The path of the file to write to.
+        /// @return `false` if the file couldn't be opened.
+        auto open(const std::string& path) noexcept -> bool;
+
+        /// @brief Flushes and closes the trace.
+        auto close() noexcept -> void;
+
+        /// @brief Writes a record of the current state of a CPU.
+        /// @param pc The address of the instruction that was just executed.
+        /// @param cpu The CPU that executed it.
+        auto write(const Word pc, const CPU& cpu) noexcept -> void;
+
+    private:
+        /// @brief The file being written to
+        FILE* file{ nullptr };
+
+        /// @brief Records not yet written to `file`
+        std::vector<Byte> buffer;
+    };
+}
@@ -0,0 +1,138 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace PlayStation
+{
+    /// @brief Defines a line buffered sink for the guest's TTY output.
+    ///
+    /// Characters are collected per instance and handed to the sink one line
+    /// at a time (or whenever the buffer fills up), so that many instances
+    /// writing to the same stream don't interleave each other's lines.
+    class TTY final
+    {
+    public:
+        /// @brief Callback receiving buffered output.
+        /// @param data The characters. This is not NUL-terminated.
+        /// @param length The number of characters.
+        using Callback = std::function<void(const char* data,
+                                            const std::size_t length)>;
+
+        /// @brief Initializes the TTY, writing to `stdout`.
+        TTY() noexcept;
+
+        /// @brief Flushes any pending output and closes the file opened by
+        /// `to_file()`, if any.
+        ~TTY() noexcept;
+
+        TTY(const TTY&) = delete;
+        auto operator=(const TTY&) -> TTY& = delete;
+
+        /// @brief Writes output to a stream, such as `stdout`. The stream is
+        /// not closed by the TTY.
+        /// @param stream The stream to write to.
+        auto to_stream(FILE* stream) noexcept -> void;
+
+        /// @brief Writes output to a file, replacing its contents.
+        /// @param path The path of the file to write to.
+        /// @return `false` if the file couldn't be opened, in which case the
+        /// previous sink is kept.
+        auto to_file(const std::string& path) noexcept -> bool;
+
+        /// @brief Hands output to a callback.
+        /// @param callback The function to call with each line.
+        auto to_callback(Callback callback) noexcept -> void;
+
+        /// @brief Discards all output.
+        auto discard() noexcept -> void;
+
+        /// @brief Sets a string to write at the beginning of every line, e.g.
+        /// to tell instances apart.
+        /// @param prefix The string to use.
+        auto set_prefix(const std::string& prefix) noexcept -> void;
+
+        /// @brief Adds a character to the output.
+        /// @param c The character to add.
+        auto put(const char c) noexcept -> void
+        {
+            if (line_start)
+            {
+                line_start = false;
+                write(prefix.data(), prefix.size());
+            }
+
+            buffer[length++] = c;
+
+            if (c == '\n')
+            {
+                line_start = true;
+                flush();
+            }
+            else if (length == buffer.size())
+            {
+                flush();
+            }
+        }
+
+        /// @brief Hands any buffered output to the sink.
+        auto flush() noexcept -> void;
+
+    private:
+        /// @brief Where the output goes.
+        enum class Sink
+        {
+            None,
+            Stream,
+            Callback
+        };
+
+        /// @brief Adds a string to the buffer, flushing as necessary.
+        /// @param data The characters to add.
+        /// @param size The number of characters.
+        auto write(const char* data, std::size_t size) noexcept -> void;
+
+        /// @brief Closes the file opened by `to_file()`, if any.
+        auto close() noexcept -> void;
+
+        /// @brief Pending output
+        std::array<char, 256> buffer;
+
+        /// @brief Number of characters in `buffer`
+        std::size_t length{ 0 };
+
+        /// @brief Is the next character the first of a line?
+        bool line_start{ true };
+
+        /// @brief String written at the beginning of every line
+        std::string prefix;
+
+        /// @brief Current sink
+        Sink sink{ Sink::Stream };
+
+        /// @brief Stream to write to, if `sink` is `Sink::Stream`
+        FILE* stream{ stdout };
+
+        /// @brief Was `stream` opened by us?
+        bool owns_stream{ false };
+
+        /// @brief Function to call, if `sink` is `Sink::Callback`
+        Callback callback;
+    };
+}
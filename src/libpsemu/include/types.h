@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <limits>
 #include <type_traits>
@@ -95,6 +96,24 @@ namespace PlayStation
     /// @brief Height of the VRAM buffer.
     constexpr auto VRAM_HEIGHT{ 512 };
 
+    /// @brief Size of the pages in which changes to main RAM and VRAM are
+    /// tracked for snapshots.
+    constexpr auto DIRTY_PAGE_SIZE{ 4096 };
+
+    /// @brief Dirty page flag of `Snapshot`. Each consumer of the dirty page
+    /// flags clears its own bit, while writes set all of them.
+    constexpr Byte DIRTY_SNAPSHOT{ 1 << 0 };
+
+    /// @brief Dirty page flag of `MemoryMirror`
+    constexpr Byte DIRTY_MIRROR{ 1 << 1 };
+
+    /// @brief Dirty page flag of `SystemBus::reset()` and `GPU::reset()`,
+    /// which only have to zero the pages written since they last did.
+    constexpr Byte DIRTY_RESET{ 1 << 2 };
+
+    /// @brief Value of the dirty page flags of a page that has been written
+    constexpr Byte DIRTY_ALL{ 0xFF };
+
     /// @brief Type alias for the VRAM data.
     using VRAM = std::array<Halfword, VRAM_WIDTH * VRAM_HEIGHT>;
 
@@ -0,0 +1,315 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include "disasm.h"
+#include "lockstep.h"
+
+using namespace PlayStation;
+
+/// @brief Registers a kernel call may leave in any state
+static constexpr std::array<unsigned int, 18> volatile_gprs
+{
+    1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27
+};
+
+/// @brief Size of the area of main RAM used by the kernel
+constexpr Word KERNEL_SIZE{ 0x10000 };
+
+/// @brief Determines if an address belongs to the kernel, either in RAM or in
+/// the BIOS.
+/// @param vaddr The address to check.
+static auto is_kernel(const Word vaddr) noexcept -> bool
+{
+    const Word paddr{ vaddr & 0x1FFFFFFF };
+    return paddr < KERNEL_SIZE || paddr >= 0x1FC00000;
+}
+
+/// @brief Executes one instruction, recording it.
+/// @return `false` if the system has exited.
+auto Lockstep::Side::step() noexcept -> bool
+{
+    const Word pc{ system.cpu.pc };
+
+    history[count % HISTORY_LENGTH] = { pc, system.bus.fetch(pc) };
+    count++;
+
+    // Breakpoints only matter to the frontend, resume past them.
+    while (!system.step())
+    {
+        if (system.hle.exited())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Initializes the harness.
+/// @param sa The reference system.
+/// @param sb The system under test.
+Lockstep::Lockstep(System& sa, System& sb) noexcept : a{ sa, { }, 0 },
+                                                      b{ sb, { }, 0 }
+{ }
+
+/// @brief Executes one instruction on both systems and compares them as
+/// configured.
+auto Lockstep::step() noexcept -> Result
+{
+    last_pc = a.system.cpu.pc;
+
+    if (!a.step() || !b.step())
+    {
+        return Result::Exited;
+    }
+
+    if (granularity == Granularity::Block && a.system.cpu.pc == last_pc + 4)
+    {
+        return Result::Continue;
+    }
+
+    if (resync_kernel_calls && a.system.cpu.pc != b.system.cpu.pc)
+    {
+        if (!resync())
+        {
+            return Result::Diverged;
+        }
+    }
+    return compare_registers() ? Result::Continue : Result::Diverged;
+}
+
+/// @brief Executes one frame on both systems, comparing them as configured,
+/// then compares main RAM and VRAM.
+auto Lockstep::run_frame() noexcept -> Result
+{
+    while (frame_cycles != System::CYCLES_PER_FRAME)
+    {
+        const auto result{ step() };
+
+        if (result != Result::Continue)
+        {
+            return result;
+        }
+        frame_cycles++;
+    }
+
+    frame_cycles = 0;
+    return compare_memory() ? Result::Continue : Result::Diverged;
+}
+
+/// @brief Prints the details of the divergence, along with the last
+/// instructions executed by each system.
+/// @param file The stream to print to.
+auto Lockstep::print_report(FILE* file) const noexcept -> void
+{
+    std::fprintf(file,
+                 "Systems diverged after %" PRIu64 " (reference) and %" PRIu64
+                 " (under test) instructions:\n%s",
+                 a.count,
+                 b.count,
+                 divergence.c_str());
+
+    for (const auto side : { &a, &b })
+    {
+        std::fprintf(file,
+                     "\nLast instructions of the %s system:\n",
+                     side == &a ? "reference" : "tested");
+
+        const auto length{ std::min<std::uint64_t>(side->count,
+                                                   HISTORY_LENGTH) };
+
+        for (auto index{ side->count - length }; index < side->count; ++index)
+        {
+            const auto& entry{ side->history[index % HISTORY_LENGTH] };
+            char text[64];
+
+            format_instruction(decode_instruction(entry.pc, entry.instruction),
+                               text,
+                               sizeof(text));
+
+            std::fprintf(file,
+                         "  0x%08X: 0x%08X  %s\n",
+                         entry.pc,
+                         entry.instruction,
+                         text);
+        }
+    }
+}
+
+/// @brief Returns the number of instructions executed by the reference system
+/// so far.
+auto Lockstep::instructions() const noexcept -> std::uint64_t
+{
+    return a.count;
+}
+
+/// @brief Compares the CPU registers of the systems.
+/// @return `false` if they differ.
+auto Lockstep::compare_registers() noexcept -> bool
+{
+    const auto& ca{ a.system.cpu };
+    const auto& cb{ b.system.cpu };
+
+    auto same{ true };
+    char line[64];
+
+    const auto compare = [&](const char* name, const Word va, const Word vb)
+    {
+        if (va != vb)
+        {
+            std::snprintf(line,
+                          sizeof(line),
+                          "  %-5s 0x%08X != 0x%08X\n",
+                          name,
+                          va,
+                          vb);
+
+            divergence += line;
+            same        = false;
+        }
+    };
+
+    compare("pc", ca.pc, cb.pc);
+
+    for (auto index{ 0 }; index < 32; ++index)
+    {
+        compare(GPR_NAMES[index], ca.gpr[index], cb.gpr[index]);
+    }
+
+    compare("hi",    ca.hi,             cb.hi);
+    compare("lo",    ca.lo,             cb.lo);
+    compare("SR",    ca.cop0.SR.word,    cb.cop0.SR.word);
+    compare("Cause", ca.cop0.Cause.word, cb.cop0.Cause.word);
+    compare("EPC",   ca.cop0.EPC,        cb.cop0.EPC);
+
+    return same;
+}
+
+/// @brief Compares main RAM and VRAM of the systems.
+/// @return `false` if they differ.
+auto Lockstep::compare_memory() noexcept -> bool
+{
+    char line[96];
+
+    // The kernel's variables depend on whether or not its functions were
+    // actually executed.
+    const Word start{ resync_kernel_calls ? KERNEL_SIZE : 0 };
+
+    const auto& ram_a{ a.system.bus.ram };
+    const auto& ram_b{ b.system.bus.ram };
+
+    const auto ram{ std::mismatch(ram_a.cbegin() + start,
+                                  ram_a.cend(),
+                                  ram_b.cbegin() + start) };
+
+    if (ram.first != ram_a.cend())
+    {
+        std::snprintf(line,
+                      sizeof(line),
+                      "  RAM differs at 0x%08zX: 0x%02X != 0x%02X\n",
+                      static_cast<std::size_t>(ram.first - ram_a.cbegin()),
+                      *ram.first,
+                      *ram.second);
+
+        divergence += line;
+        return false;
+    }
+
+    const auto& vram_a{ a.system.bus.gpu.vram };
+    const auto& vram_b{ b.system.bus.gpu.vram };
+
+    const auto vram{ std::mismatch(vram_a.cbegin(),
+                                   vram_a.cend(),
+                                   vram_b.cbegin()) };
+
+    if (vram.first != vram_a.cend())
+    {
+        const auto index{ vram.first - vram_a.cbegin() };
+
+        std::snprintf(line,
+                      sizeof(line),
+                      "  VRAM differs at (%d, %d): 0x%04X != 0x%04X\n",
+                      static_cast<int>(index % VRAM_WIDTH),
+                      static_cast<int>(index / VRAM_WIDTH),
+                      *vram.first,
+                      *vram.second);
+
+        divergence += line;
+        return false;
+    }
+    return true;
+}
+
+/// @brief Runs the system that is executing kernel code until it reaches the
+/// point where the other one is.
+/// @return `false` if that didn't happen.
+auto Lockstep::resync() noexcept -> bool
+{
+    constexpr auto SP{ 29 };
+
+    Side* lagging;
+    Side* leading;
+
+    if (is_kernel(b.system.cpu.pc) && !is_kernel(a.system.cpu.pc))
+    {
+        lagging = &b;
+        leading = &a;
+    }
+    else if (is_kernel(a.system.cpu.pc) && !is_kernel(b.system.cpu.pc))
+    {
+        lagging = &a;
+        leading = &b;
+    }
+    else
+    {
+        // Not a kernel call, let the comparison report it.
+        return true;
+    }
+
+    auto& cpu{ lagging->system.cpu };
+    const auto& target{ leading->system.cpu };
+
+    for (std::uint64_t count{ 0 }; count < RESYNC_LIMIT; ++count)
+    {
+        if (cpu.pc == target.pc && cpu.gpr[SP] == target.gpr[SP])
+        {
+            for (const auto reg : volatile_gprs)
+            {
+                cpu.gpr[reg] = target.gpr[reg];
+            }
+
+            cpu.hi = target.hi;
+            cpu.lo = target.lo;
+
+            return true;
+        }
+
+        if (!lagging->step())
+        {
+            break;
+        }
+    }
+
+    char line[96];
+    std::snprintf(line,
+                  sizeof(line),
+                  "  the %s system didn't return to 0x%08X from kernel code\n",
+                  lagging == &a ? "reference" : "tested",
+                  target.pc);
+
+    divergence += line;
+    return false;
+}
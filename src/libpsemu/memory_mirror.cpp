@@ -0,0 +1,172 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include "memory_mirror.h"
+
+using namespace PlayStation;
+
+/// @brief Allocates both buffers.
+MemoryMirror::MemoryMirror() noexcept
+{
+    for (auto& buffer : buffers)
+    {
+        buffer.ram.resize(RAM_SIZE);
+        buffer.vram.resize(VRAM_WIDTH * VRAM_HEIGHT);
+
+        buffer.ram_stale.fill(true);
+        buffer.vram_stale.fill(true);
+    }
+}
+
+/// @brief Takes the pages of a memory written to since the last frame, and
+/// marks them as missing from both buffers.
+/// @param dirty The dirty flags of each page of the memory.
+/// @param stale0 The pages missing from the first buffer.
+/// @param stale1 The pages missing from the second buffer.
+template<std::size_t N>
+static auto take_dirty(std::array<Byte, N>& dirty,
+                       std::array<bool, N>& stale0,
+                       std::array<bool, N>& stale1) noexcept -> void
+{
+    for (std::size_t page{ 0 }; page < N; ++page)
+    {
+        if (dirty[page] & DIRTY_MIRROR)
+        {
+            dirty[page] &= ~DIRTY_MIRROR;
+
+            stale0[page] = true;
+            stale1[page] = true;
+        }
+    }
+}
+
+/// @brief Copies the pages of a memory missing from a buffer into it.
+/// @param dst The memory in the buffer.
+/// @param src The memory to copy from.
+/// @param stale The pages missing from the buffer.
+template<typename T, std::size_t N>
+static auto copy_stale(T* dst, const T* src, std::array<bool, N>& stale)
+noexcept -> void
+{
+    constexpr auto PAGE_LENGTH{ DIRTY_PAGE_SIZE / sizeof(T) };
+
+    for (std::size_t page{ 0 }; page < N; ++page)
+    {
+        if (stale[page])
+        {
+            std::copy_n(&src[page * PAGE_LENGTH],
+                        PAGE_LENGTH,
+                        &dst[page * PAGE_LENGTH]);
+
+            stale[page] = false;
+        }
+    }
+}
+
+/// @brief Publishes the current contents of main RAM and VRAM. This is called
+/// by `System::run_frame()`, and must only ever be called by the thread
+/// running the system.
+/// @param bus The system bus to copy from.
+auto MemoryMirror::publish(SystemBus& bus) noexcept -> void
+{
+    take_dirty(bus.ram_dirty, buffers[0].ram_stale, buffers[1].ram_stale);
+    take_dirty(bus.gpu.vram_dirty,
+               buffers[0].vram_stale,
+               buffers[1].vram_stale);
+
+    // Readers are on the other buffer, unless they have been at it for a
+    // whole frame.
+    const auto index{ current.load(std::memory_order_relaxed) ^ 1 };
+    auto& buffer{ buffers[index] };
+
+    const auto sequence{ buffer.sequence.load(std::memory_order_relaxed) };
+
+    buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    copy_stale(buffer.ram.data(), bus.ram.data(), buffer.ram_stale);
+    copy_stale(buffer.vram.data(), bus.gpu.vram.data(), buffer.vram_stale);
+
+    buffer.frame.store(++frames, std::memory_order_relaxed);
+    buffer.sequence.store(sequence + 2, std::memory_order_release);
+
+    current.store(index, std::memory_order_release);
+}
+
+/// @brief Copies published memory out of the current buffer, retrying until
+/// the copy is consistent.
+/// @param copy Function copying out of a buffer.
+template<typename F>
+auto MemoryMirror::read(F copy) const noexcept -> std::uint64_t
+{
+    for (;;)
+    {
+        const auto& buffer{ buffers[current.load(std::memory_order_acquire)] };
+        const auto sequence{ buffer.sequence.load(std::memory_order_acquire) };
+
+        if (sequence & 1)
+        {
+            continue;
+        }
+
+        copy(buffer);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (buffer.sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            return buffer.frame.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/// @brief Copies published main RAM. Safe to call from any thread.
+/// @param paddr The physical address to start at.
+/// @param data Where to copy the memory.
+/// @param size The number of bytes to copy. The range must be within main
+/// RAM.
+/// @return The number of the frame the copy was published at, 0 if nothing
+/// has been published yet.
+auto MemoryMirror::read_ram(const Word paddr,
+                            Byte* data,
+                            const std::size_t size) const noexcept
+-> std::uint64_t
+{
+    return read([&](const Buffer& buffer)
+    {
+        std::memcpy(data, &buffer.ram[paddr], size);
+    });
+}
+
+/// @brief Copies published VRAM. Safe to call from any thread.
+/// @param pixels Where to copy VRAM, which must hold
+/// `VRAM_WIDTH * VRAM_HEIGHT` pixels.
+/// @return The number of the frame the copy was published at, 0 if nothing
+/// has been published yet.
+auto MemoryMirror::read_vram(Halfword* pixels) const noexcept
+-> std::uint64_t
+{
+    return read([&](const Buffer& buffer)
+    {
+        std::memcpy(pixels, buffer.vram.data(), sizeof(VRAM));
+    });
+}
+
+/// @brief Returns the number of the last frame published.
+auto MemoryMirror::frame() const noexcept -> std::uint64_t
+{
+    return buffers[current.load(std::memory_order_acquire)].frame.load(
+           std::memory_order_relaxed);
+}
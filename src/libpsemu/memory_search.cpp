@@ -0,0 +1,494 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include "memory_search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PSEMU_SEARCH_AVX2
+#endif
+
+using namespace PlayStation;
+using Comparison = MemorySearch::Comparison;
+
+/// @brief Number of values covered by one word of the candidate bitset,
+/// which are compared together
+constexpr std::size_t BLOCK_VALUES{ 64 };
+
+/// @brief Compares two values.
+/// @tparam C The comparison to make.
+/// @param a The value.
+/// @param b The operand.
+template<Comparison C, typename T>
+static auto compare(const T a, const T b) noexcept -> bool
+{
+    if constexpr (C == Comparison::Equal)
+    {
+        return a == b;
+    }
+    else if constexpr (C == Comparison::NotEqual)
+    {
+        return a != b;
+    }
+    else if constexpr (C == Comparison::Greater)
+    {
+        return a > b;
+    }
+    else
+    {
+        return a < b;
+    }
+}
+
+/// @brief Compares a block of values, one at a time.
+/// @tparam T The type of the values.
+/// @tparam C The comparison to make.
+/// @tparam ToValue Compare against `value` rather than `previous`?
+/// @param ram The values.
+/// @param previous The values at the previous pass.
+/// @param value The constant to compare against.
+/// @return One bit per value, set if the comparison holds.
+template<typename T, Comparison C, bool ToValue>
+static auto block_scalar(const Byte* ram, const Byte* previous, const T value)
+noexcept -> std::uint64_t
+{
+    std::uint64_t bits{ 0 };
+
+    for (std::size_t index{ 0 }; index < BLOCK_VALUES; ++index)
+    {
+        T a;
+        T b{ value };
+
+        std::memcpy(&a, &ram[index * sizeof(T)], sizeof(T));
+
+        if constexpr (!ToValue)
+        {
+            std::memcpy(&b, &previous[index * sizeof(T)], sizeof(T));
+        }
+
+        bits |= std::uint64_t{ compare<C>(a, b) } << index;
+    }
+    return bits;
+}
+
+/// @brief Narrows the candidates of a search, one value at a time.
+/// @tparam T The type of the values.
+/// @tparam C The comparison to make.
+/// @tparam ToValue Compare against `value` rather than `previous`?
+/// @param ram Main RAM.
+/// @param previous Main RAM at the previous pass.
+/// @param value The constant to compare against.
+/// @param candidates The candidate bitset.
+/// @param blocks The number of words in the bitset.
+/// @return The number of candidates left.
+template<typename T, Comparison C, bool ToValue>
+static auto filter_scalar(const Byte* ram,
+                          const Byte* previous,
+                          const Word value,
+                          std::uint64_t* candidates,
+                          const std::size_t blocks) noexcept -> std::size_t
+{
+    std::size_t remaining{ 0 };
+
+    for (std::size_t block{ 0 }; block < blocks; ++block)
+    {
+        if (candidates[block] == 0)
+        {
+            continue;
+        }
+
+        const auto offset{ block * BLOCK_VALUES * sizeof(T) };
+
+        candidates[block] &=
+        block_scalar<T, C, ToValue>(&ram[offset],
+                                    &previous[offset],
+                                    static_cast<T>(value));
+
+        remaining += __builtin_popcountll(candidates[block]);
+    }
+    return remaining;
+}
+
+#ifdef PSEMU_SEARCH_AVX2
+/// @brief Determines if the host supports AVX2.
+static auto has_avx2() noexcept -> bool
+{
+    // This runs before main(), which is too early without this.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+/// @brief Does the host support AVX2?
+static const bool HAS_AVX2{ has_avx2() };
+
+/// @brief Compares the lanes of two vectors for equality.
+/// @tparam T The type of the lanes.
+template<typename T>
+[[gnu::target("avx2")]]
+static auto equal(const __m256i a, const __m256i b) noexcept -> __m256i
+{
+    if constexpr (sizeof(T) == sizeof(Byte))
+    {
+        return _mm256_cmpeq_epi8(a, b);
+    }
+    else if constexpr (sizeof(T) == sizeof(Halfword))
+    {
+        return _mm256_cmpeq_epi16(a, b);
+    }
+    else
+    {
+        return _mm256_cmpeq_epi32(a, b);
+    }
+}
+
+/// @brief Returns the unsigned maximum of the lanes of two vectors.
+/// @tparam T The type of the lanes.
+template<typename T>
+[[gnu::target("avx2")]]
+static auto maximum(const __m256i a, const __m256i b) noexcept -> __m256i
+{
+    if constexpr (sizeof(T) == sizeof(Byte))
+    {
+        return _mm256_max_epu8(a, b);
+    }
+    else if constexpr (sizeof(T) == sizeof(Halfword))
+    {
+        return _mm256_max_epu16(a, b);
+    }
+    else
+    {
+        return _mm256_max_epu32(a, b);
+    }
+}
+
+/// @brief Returns a vector with a value in every lane.
+/// @tparam T The type of the lanes.
+template<typename T>
+[[gnu::target("avx2")]]
+static auto broadcast(const Word value) noexcept -> __m256i
+{
+    if constexpr (sizeof(T) == sizeof(Byte))
+    {
+        return _mm256_set1_epi8(static_cast<char>(value));
+    }
+    else if constexpr (sizeof(T) == sizeof(Halfword))
+    {
+        return _mm256_set1_epi16(static_cast<short>(value));
+    }
+    else
+    {
+        return _mm256_set1_epi32(static_cast<int>(value));
+    }
+}
+
+/// @brief Packs the lane masks of a block of values into one bit per value.
+/// @tparam T The type of the lanes.
+/// @param masks The masks, all ones in the lanes to set the bit of.
+template<typename T>
+[[gnu::target("avx2")]]
+static auto pack(const __m256i* masks) noexcept -> std::uint64_t
+{
+    std::uint64_t bits{ 0 };
+
+    if constexpr (sizeof(T) == sizeof(Byte))
+    {
+        for (auto half{ 0 }; half < 2; ++half)
+        {
+            const auto mask{ _mm256_movemask_epi8(masks[half]) };
+            bits |= std::uint64_t{ static_cast<Word>(mask) } << (half * 32);
+        }
+    }
+    else if constexpr (sizeof(T) == sizeof(Halfword))
+    {
+        // Narrow each pair of vectors to one byte per lane. Packing works
+        // within 128-bit lanes, so the quadwords come out of order.
+        for (auto half{ 0 }; half < 2; ++half)
+        {
+            const auto packed{ _mm256_packs_epi16(masks[half * 2],
+                                                  masks[half * 2 + 1]) };
+            const auto ordered{ _mm256_permute4x64_epi64(packed, 0xD8) };
+            const auto mask{ _mm256_movemask_epi8(ordered) };
+
+            bits |= std::uint64_t{ static_cast<Word>(mask) } << (half * 32);
+        }
+    }
+    else
+    {
+        for (auto vector{ 0 }; vector < 8; ++vector)
+        {
+            const auto mask{
+                _mm256_movemask_ps(_mm256_castsi256_ps(masks[vector])) };
+
+            bits |= std::uint64_t{ static_cast<Word>(mask) } << (vector * 8);
+        }
+    }
+    return bits;
+}
+
+/// @brief Compares a block of values, 32 bytes at a time.
+/// @tparam T The type of the values.
+/// @tparam C The comparison to make.
+/// @tparam ToValue Compare against `value` rather than `previous`?
+/// @param ram The values.
+/// @param previous The values at the previous pass.
+/// @param value The constant to compare against, in every lane.
+/// @return One bit per value, set if the comparison holds.
+template<typename T, Comparison C, bool ToValue>
+[[gnu::target("avx2")]]
+static auto block_avx2(const Byte* ram,
+                       const Byte* previous,
+                       const __m256i value) noexcept -> std::uint64_t
+{
+    constexpr auto VECTORS{ (BLOCK_VALUES * sizeof(T)) / sizeof(__m256i) };
+    __m256i masks[VECTORS];
+
+    for (std::size_t vector{ 0 }; vector < VECTORS; ++vector)
+    {
+        const auto a{ _mm256_loadu_si256(
+                      reinterpret_cast<const __m256i*>(ram) + vector) };
+        auto b{ value };
+
+        if constexpr (!ToValue)
+        {
+            b = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(previous) + vector);
+        }
+
+        // There are no unsigned comparisons other than for equality, but
+        // max(a, b) == b is a <= b, and max(a, b) == a is a >= b. Those are
+        // inverted into a > b and a < b along with a != b below.
+        if constexpr (C == Comparison::Greater)
+        {
+            masks[vector] = equal<T>(maximum<T>(a, b), b);
+        }
+        else if constexpr (C == Comparison::Less)
+        {
+            masks[vector] = equal<T>(maximum<T>(a, b), a);
+        }
+        else
+        {
+            masks[vector] = equal<T>(a, b);
+        }
+    }
+
+    const auto bits{ pack<T>(masks) };
+    return C == Comparison::Equal ? bits : ~bits;
+}
+
+/// @brief Same as `filter_scalar()`, using AVX2.
+template<typename T, Comparison C, bool ToValue>
+[[gnu::target("avx2")]]
+static auto filter_avx2(const Byte* ram,
+                        const Byte* previous,
+                        const Word value,
+                        std::uint64_t* candidates,
+                        const std::size_t blocks) noexcept -> std::size_t
+{
+    const auto operand{ broadcast<T>(value) };
+    std::size_t remaining{ 0 };
+
+    for (std::size_t block{ 0 }; block < blocks; ++block)
+    {
+        if (candidates[block] == 0)
+        {
+            continue;
+        }
+
+        const auto offset{ block * BLOCK_VALUES * sizeof(T) };
+
+        candidates[block] &= block_avx2<T, C, ToValue>(&ram[offset],
+                                                       &previous[offset],
+                                                       operand);
+
+        remaining += __builtin_popcountll(candidates[block]);
+    }
+    return remaining;
+}
+#endif
+
+/// @brief Narrows the candidates of a search, using AVX2 if the host has it.
+/// @tparam T The type of the values.
+/// @tparam C The comparison to make.
+/// @tparam ToValue Compare against `value` rather than `previous`?
+/// @param ram Main RAM.
+/// @param previous Main RAM at the previous pass.
+/// @param value The constant to compare against.
+/// @param candidates The candidate bitset.
+/// @return The number of candidates left.
+template<typename T, Comparison C, bool ToValue>
+static auto filter(const Byte* ram,
+                   const Byte* previous,
+                   const Word value,
+                   std::vector<std::uint64_t>& candidates) noexcept
+-> std::size_t
+{
+#ifdef PSEMU_SEARCH_AVX2
+    if (HAS_AVX2)
+    {
+        return filter_avx2<T, C, ToValue>(ram, previous, value,
+                                          candidates.data(),
+                                          candidates.size());
+    }
+#endif
+    return filter_scalar<T, C, ToValue>(ram, previous, value,
+                                        candidates.data(),
+                                        candidates.size());
+}
+
+/// @brief Same as above, picking the comparison at runtime.
+template<typename T, bool ToValue>
+static auto filter(const Comparison comparison,
+                   const Byte* ram,
+                   const Byte* previous,
+                   const Word value,
+                   std::vector<std::uint64_t>& candidates) noexcept
+-> std::size_t
+{
+    switch (comparison)
+    {
+        case Comparison::Equal:
+            return filter<T, Comparison::Equal, ToValue>(ram, previous, value,
+                                                         candidates);
+
+        case Comparison::NotEqual:
+            return filter<T, Comparison::NotEqual, ToValue>(ram, previous,
+                                                            value,
+                                                            candidates);
+
+        case Comparison::Greater:
+            return filter<T, Comparison::Greater, ToValue>(ram, previous,
+                                                           value,
+                                                           candidates);
+
+        case Comparison::Less:
+            return filter<T, Comparison::Less, ToValue>(ram, previous, value,
+                                                        candidates);
+    }
+    return 0;
+}
+
+/// @brief Starts a new search, with every value as a candidate.
+/// @param bus The system bus whose main RAM to search.
+/// @param width The size of the values to search for.
+auto MemorySearch::start(const SystemBus& bus, const Width width) noexcept
+-> void
+{
+    this->width = width;
+    remaining   = RAM_SIZE / static_cast<std::size_t>(width);
+
+    candidates.assign(remaining / BLOCK_VALUES, ~std::uint64_t{ 0 });
+    previous.assign(bus.ram.begin(), bus.ram.end());
+}
+
+/// @brief Keeps the candidates whose value compares to their value at the
+/// previous pass (or the start of the search) as asked.
+/// @param bus The system bus whose main RAM to search.
+/// @param comparison How to compare the values.
+/// @return The number of candidates left, which is 0 until `start()` is
+/// called.
+auto MemorySearch::compare_previous(const SystemBus& bus,
+                                    const Comparison comparison) noexcept
+-> std::size_t
+{
+    return pass(bus, comparison, false, 0);
+}
+
+/// @brief Keeps the candidates whose value compares to a constant as asked.
+/// @param bus The system bus whose main RAM to search.
+/// @param comparison How to compare the values.
+/// @param value The constant to compare against. Only the lower bits are used
+/// for values narrower than 32 bits.
+/// @return The number of candidates left, which is 0 until `start()` is
+/// called.
+auto MemorySearch::compare_value(const SystemBus& bus,
+                                 const Comparison comparison,
+                                 const Word value) noexcept -> std::size_t
+{
+    return pass(bus, comparison, true, value);
+}
+
+/// @brief Returns the number of candidates left.
+auto MemorySearch::count() const noexcept -> std::size_t
+{
+    return remaining;
+}
+
+/// @brief Lists the candidates left.
+/// @param addresses Where to store the physical addresses of the candidates,
+/// lowest first.
+/// @param limit The maximum number of addresses to store.
+auto MemorySearch::results(std::vector<Word>& addresses,
+                           const std::size_t limit) const noexcept -> void
+{
+    addresses.clear();
+
+    for (std::size_t block{ 0 }; block < candidates.size(); ++block)
+    {
+        for (auto bits{ candidates[block] }; bits != 0; bits &= bits - 1)
+        {
+            if (addresses.size() == limit)
+            {
+                return;
+            }
+
+            const auto index{ (block * BLOCK_VALUES) +
+                              __builtin_ctzll(bits) };
+
+            addresses.push_back(static_cast<Word>(index *
+                                static_cast<std::size_t>(width)));
+        }
+    }
+}
+
+/// @brief Runs a pass over main RAM and remembers its contents for the next
+/// one.
+/// @param bus The system bus whose main RAM to search.
+/// @param comparison How to compare the values.
+/// @param against_value Compare against `value` rather than the previous
+/// pass?
+/// @param value The constant to compare against.
+auto MemorySearch::pass(const SystemBus& bus,
+                        const Comparison comparison,
+                        const bool against_value,
+                        const Word value) noexcept -> std::size_t
+{
+    // Without a search, there are no candidates to narrow down.
+    if (previous.empty())
+    {
+        return 0;
+    }
+
+    const auto run = [&](auto type)
+    {
+        using T = decltype(type);
+
+        return against_value ?
+               filter<T, true>(comparison, bus.ram.data(), previous.data(),
+                               value, candidates) :
+               filter<T, false>(comparison, bus.ram.data(), previous.data(),
+                                value, candidates);
+    };
+
+    switch (width)
+    {
+        case Width::Byte:     remaining = run(Byte{ });     break;
+        case Width::Halfword: remaining = run(Halfword{ }); break;
+        case Width::Word:     remaining = run(Word{ });     break;
+    }
+
+    std::copy(bus.ram.begin(), bus.ram.end(), previous.begin());
+    return remaining;
+}
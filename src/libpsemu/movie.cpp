@@ -0,0 +1,256 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cstdio>
+#include <cstring>
+#include "cheats.h"
+#include "movie.h"
+#include "ps.h"
+
+using namespace PlayStation;
+
+/// @brief Identifies a file as a movie
+static constexpr char MAGIC[8]{ 'P', 'S', 'X', 'M', 'O', 'V', 'I', 'E' };
+
+/// @brief Format version written to the header
+constexpr Word MOVIE_VERSION{ 2 };
+
+/// @brief Size of the header of a movie file
+constexpr std::size_t HEADER_SIZE{ 48 };
+
+/// @brief Size of the header of a version 1 movie file, which didn't record
+/// cheat codes
+constexpr std::size_t V1_HEADER_SIZE{ 40 };
+
+/// @brief Size of a frame in a movie file
+constexpr std::size_t FRAME_SIZE{ 16 };
+
+// Frames are copied as is, which is only correct if the layout matches.
+static_assert(sizeof(MovieFrame) == FRAME_SIZE);
+
+/// @brief Mixes a 64-bit word into a hash.
+/// @param hash The hash so far.
+/// @param word The word to mix in.
+static auto mix(const std::uint64_t hash, const std::uint64_t word) noexcept
+-> std::uint64_t
+{
+    const std::uint64_t value{ hash ^ word };
+    return ((value << 29) | (value >> 35)) * 0x9E3779B97F4A7C15;
+}
+
+/// @brief Mixes a block of memory into a hash, eight bytes at a time.
+/// @param hash The hash so far.
+/// @param data The memory to mix in.
+/// @param size The size of the memory, in bytes.
+static auto mix(std::uint64_t hash, const Byte* data, const std::size_t size)
+noexcept -> std::uint64_t
+{
+    std::size_t offset{ 0 };
+
+    for (; offset + sizeof(std::uint64_t) <= size; offset += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, &data[offset], sizeof(word));
+
+        hash = mix(hash, word);
+    }
+
+    for (; offset < size; ++offset)
+    {
+        hash = mix(hash, data[offset]);
+    }
+    return mix(hash, size);
+}
+
+/// @brief Returns a 64-bit hash of data, e.g. the BIOS or the EXE.
+/// @param data The data to hash.
+/// @param size The size of the data, in bytes.
+auto Movie::hash(const Byte* data, const std::size_t size) noexcept
+-> std::uint64_t
+{
+    return mix(0, data, size);
+}
+
+/// @brief Returns a hash of the state of a system: its CPU registers, main
+/// RAM and VRAM.
+/// @param system The system to hash.
+auto Movie::state_hash(const System& system) noexcept -> std::uint64_t
+{
+    const auto& cpu{ system.cpu };
+    std::uint64_t result{ 0 };
+
+    for (const auto reg : cpu.gpr)
+    {
+        result = mix(result, reg);
+    }
+
+    result = mix(result, (std::uint64_t{ cpu.hi } << 32) | cpu.lo);
+    result = mix(result, (std::uint64_t{ cpu.pc } << 32) | cpu.next_pc);
+
+    result = mix(result, system.bus.ram.data(), system.bus.ram.size());
+
+    return mix(result,
+               reinterpret_cast<const Byte*>(system.bus.gpu.vram.data()),
+               sizeof(VRAM));
+}
+
+/// @brief Reads a movie file.
+/// @param path The path of the file to read.
+/// @return `false` if the file couldn't be read or is not a movie.
+auto Movie::load(const std::string& path) noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "rb") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    Byte header[HEADER_SIZE];
+
+    const auto word = [&](const std::size_t offset) -> Word
+    {
+        Word value;
+        std::memcpy(&value, &header[offset], sizeof(value));
+
+        return value;
+    };
+
+    const auto doubleword = [&](const std::size_t offset) -> std::uint64_t
+    {
+        std::uint64_t value;
+        std::memcpy(&value, &header[offset], sizeof(value));
+
+        return value;
+    };
+
+    if (std::fread(header, V1_HEADER_SIZE, 1, file) != 1 ||
+        std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 ||
+        (word(8) != 1 && word(8) != MOVIE_VERSION) ||
+        word(12) != FRAME_SIZE ||
+        (word(8) != 1 &&
+         std::fread(&header[V1_HEADER_SIZE],
+                    HEADER_SIZE - V1_HEADER_SIZE,
+                    1,
+                    file) != 1))
+    {
+        std::fclose(file);
+        return false;
+    }
+
+    options       = word(16);
+    hle_functions = word(20);
+    bios_hash     = doubleword(24);
+    exe_hash      = doubleword(32);
+    cheats_hash   = word(8) != 1 ? doubleword(40) : 0;
+
+    frames.clear();
+    MovieFrame frame;
+
+    while (std::fread(&frame, sizeof(frame), 1, file) == 1)
+    {
+        frames.push_back(frame);
+    }
+
+    const bool ok{ !std::ferror(file) };
+    std::fclose(file);
+
+    return ok;
+}
+
+/// @brief Writes the movie to a file, replacing its contents.
+/// @param path The path of the file to write.
+/// @return `false` if the file couldn't be written.
+auto Movie::save(const std::string& path) const noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "wb") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    Byte header[HEADER_SIZE];
+
+    std::memcpy(&header[0], MAGIC, sizeof(MAGIC));
+    std::memcpy(&header[8], &MOVIE_VERSION, sizeof(Word));
+    std::memcpy(&header[12], &FRAME_SIZE, sizeof(Word));
+    std::memcpy(&header[16], &options, sizeof(options));
+    std::memcpy(&header[20], &hle_functions, sizeof(hle_functions));
+    std::memcpy(&header[24], &bios_hash, sizeof(bios_hash));
+    std::memcpy(&header[32], &exe_hash, sizeof(exe_hash));
+    std::memcpy(&header[40], &cheats_hash, sizeof(cheats_hash));
+
+    bool ok{ std::fwrite(header, sizeof(header), 1, file) == 1 };
+
+    if (ok && !frames.empty())
+    {
+        ok = std::fwrite(frames.data(),
+                         sizeof(MovieFrame),
+                         frames.size(),
+                         file) == frames.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+/// @brief Records the options of a system, and the cheat codes it applies.
+/// @param system The system to record.
+/// @param fast_boot Was the EXE started without the BIOS?
+auto Movie::record_options(const System& system, const bool fast_boot)
+noexcept -> void
+{
+    options       = fast_boot ? Word{ FastBoot } : 0;
+    hle_functions = 0;
+    cheats_hash   = system.cheats ? system.cheats->hash() : 0;
+
+    for (auto f{ 0 }; f < HLE::FunctionCount; ++f)
+    {
+        if (system.hle.enabled(static_cast<HLE::Function>(f)))
+        {
+            hle_functions |= 1 << f;
+        }
+    }
+}
+
+/// @brief Applies the recorded options to a system.
+/// @param system The system to change.
+auto Movie::apply_options(System& system) const noexcept -> void
+{
+    for (auto f{ 0 }; f < HLE::FunctionCount; ++f)
+    {
+        system.hle.enable(static_cast<HLE::Function>(f),
+                          (hle_functions >> f) & 1);
+    }
+}
+
+/// @brief Records a frame which has just been run.
+/// @param system The system that ran it.
+/// @param flags The events that happened before the frame.
+auto Movie::record_frame(const System& system, const Word flags) noexcept
+-> void
+{
+    frames.push_back({ system.pads, flags, state_hash(system) });
+}
+
+/// @brief Checks that a frame which has just been played back ended in the
+/// same state as it was recorded in.
+/// @param system The system that ran it.
+/// @param frame The index of the frame.
+/// @return `false` if the state differs.
+auto Movie::check_frame(const System& system, const std::size_t frame) const
+noexcept -> bool
+{
+    return frames[frame].state_hash == 0 ||
+           frames[frame].state_hash == state_hash(system);
+}
@@ -0,0 +1,144 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cinttypes>
+#include "perf.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace PlayStation;
+
+/// @brief Discards everything measured so far.
+auto Perf::reset() noexcept -> void
+{
+    *this = { };
+}
+
+/// @brief Marks the beginning of an emulated frame.
+auto Perf::begin_frame() noexcept -> void
+{
+    frame_start = Clock::now();
+
+    if (!started)
+    {
+        started        = true;
+        interval_start = frame_start;
+    }
+    else
+    {
+        time[Frontend] += frame_start - frame_end;
+    }
+}
+
+/// @brief Marks the end of an emulated frame.
+/// @param count The number of instructions executed during the frame.
+/// @return `true` if the rates were recomputed.
+auto Perf::end_frame(const std::uint64_t count) noexcept -> bool
+{
+    frame_end = Clock::now();
+
+    // Whatever isn't accounted for by another subsystem happened in the CPU.
+    time[CPU] += (frame_end - frame_start);
+
+    instructions += count;
+    frames++;
+
+    const auto elapsed{ frame_end - interval_start };
+
+    if (elapsed < UPDATE_INTERVAL)
+    {
+        return false;
+    }
+
+    const std::chrono::duration<double> seconds{ elapsed };
+    const auto per_frame = [&](const Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count() / frames;
+    };
+
+    current.instructions_per_second = instructions / seconds.count();
+    current.frames_per_second       = frames / seconds.count();
+    current.speed = (current.frames_per_second / REFRESH_RATE) * 100.0;
+
+    current.frame_time[CPU]      = per_frame(time[CPU] - time[GPU]);
+    current.frame_time[GPU]      = per_frame(time[GPU]);
+    current.frame_time[Frontend] = per_frame(time[Frontend]);
+    current.updates++;
+
+    time.fill(Clock::duration::zero());
+    instructions   = 0;
+    frames         = 0;
+    interval_start = frame_end;
+
+    return true;
+}
+
+/// @brief Returns the rates as of the last update.
+auto Perf::counters() const noexcept -> const Counters&
+{
+    return current;
+}
+
+/// @brief Returns the peak resident set size of the process.
+/// @return The size in bytes, or 0 if it can't be determined on this platform.
+auto Perf::peak_rss() noexcept -> std::size_t
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+#ifdef __APPLE__
+    // macOS reports bytes...
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    // ...everyone else kilobytes.
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+/// @brief Prints the results of a benchmark run: wall time, emulated frames
+/// per second, MIPS and peak resident set size.
+/// @param file The stream to print to.
+/// @param frames The number of frames emulated.
+/// @param instructions The number of instructions executed.
+/// @param time The wall time the frames took.
+auto Perf::print_benchmark(FILE* file,
+                           const std::uint64_t frames,
+                           const std::uint64_t instructions,
+                           const Clock::duration time) noexcept -> void
+{
+    const std::chrono::duration<double> seconds{ time };
+
+    std::fprintf(file,
+                 "frames:    %" PRIu64 "\n"
+                 "wall time: %.3f s\n"
+                 "FPS:       %.2f (%.0f%% of real time)\n"
+                 "MIPS:      %.2f\n"
+                 "peak RSS:  %.1f MiB\n",
+                 frames,
+                 seconds.count(),
+                 frames / seconds.count(),
+                 ((frames / seconds.count()) / REFRESH_RATE) * 100.0,
+                 (instructions / seconds.count()) / 1000000.0,
+                 peak_rss() / (1024.0 * 1024.0));
+}
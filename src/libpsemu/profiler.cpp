@@ -0,0 +1,294 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cinttypes>
+#include "bus.h"
+#include "cpu.h"
+#include "profiler.h"
+#include "symbols.h"
+
+using namespace PlayStation;
+
+/// @brief Register numbers of $sp and $ra respectively
+constexpr auto SP{ 29 };
+constexpr auto RA{ 31 };
+
+/// @brief Depth past which the oldest frames are forgotten. Code that calls
+/// without ever returning would otherwise grow the stack without bound.
+constexpr std::size_t MAX_DEPTH{ 1024 };
+
+/// @brief Initializes the profiler.
+/// @param c The CPU to profile.
+/// @param b The system bus instance.
+Profiler::Profiler(CPU& c, SystemBus& b) noexcept : cpu(c), bus(b)
+{ }
+
+/// @brief Discards all data collected so far.
+auto Profiler::reset() noexcept -> void
+{
+    functions.clear();
+    stack.clear();
+
+    jump_delay   = 0;
+    instructions = 0;
+}
+
+/// @brief Accounts for the instruction the CPU is about to execute.
+auto Profiler::step() noexcept -> void
+{
+    const Word pc{ cpu.pc };
+
+    // A jump takes effect once its delay slot has executed, which belongs to
+    // the caller (or, for a return, to the callee).
+    if (jump_delay != 0 && --jump_delay == 0)
+    {
+        if (jump.call)
+        {
+            push(jump.target, jump.return_address);
+        }
+        else
+        {
+            unwind(jump.target);
+        }
+    }
+
+    if (stack.empty())
+    {
+        push(pc, 0xFFFFFFFF);
+    }
+    else if (stack.size() > 1 && pc == stack.back().return_address)
+    {
+        // Returned without us noticing, e.g. from a HLE function.
+        pop();
+    }
+
+    stack.back().function->exclusive++;
+    instructions++;
+
+    const Word instruction{ bus.fetch(pc) };
+
+    switch (instruction >> 26)
+    {
+        // SPECIAL
+        case 0x00:
+            switch (instruction & 0x3F)
+            {
+                // JR
+                case 0x08:
+                    if (((instruction >> 21) & 0x1F) == RA)
+                    {
+                        jump       = { false, cpu.gpr[RA], 0 };
+                        jump_delay = 2;
+                    }
+                    break;
+
+                // JALR
+                case 0x09:
+                    jump       = { true,
+                                   cpu.gpr[(instruction >> 21) & 0x1F],
+                                   pc + 8 };
+                    jump_delay = 2;
+                    break;
+            }
+            break;
+
+        // JAL
+        case 0x03:
+            jump       = { true,
+                           ((instruction & 0x03FFFFFF) << 2) |
+                           ((pc + 4) & 0xF0000000),
+                           pc + 8 };
+            jump_delay = 2;
+            break;
+    }
+}
+
+/// @brief Names a function in the output.
+/// @param address The address of the function.
+/// @param name The name of the function.
+auto Profiler::add_symbol(const Word address, const std::string& name) noexcept
+-> void
+{
+    symbols[address] = name;
+}
+
+/// @brief Loads function names from a file. Every line is expected to be
+/// either "address name" or "address type name" (as printed by `nm`), with
+/// the address in hexadecimal.
+/// @param path The path of the file to read.
+/// @return `false` if the file couldn't be opened.
+auto Profiler::load_symbols(const std::string& path) noexcept -> bool
+{
+    Symbols loaded;
+
+    if (!read_symbols(path, loaded))
+    {
+        return false;
+    }
+
+    for (const auto& [address, name] : loaded)
+    {
+        add_symbol(address, name);
+    }
+    return true;
+}
+
+/// @brief Writes the profile in callgrind format, for use with tools such as
+/// KCachegrind.
+/// @param file The stream to write to.
+auto Profiler::write_callgrind(FILE* file) const noexcept -> void
+{
+    // Calls that haven't returned yet are included as if they just did.
+    std::unordered_map<Word, std::unordered_map<Word, Calls>> pending;
+
+    for (std::size_t index{ 1 }; index < stack.size(); ++index)
+    {
+        auto& calls{ pending[stack[index - 1].address][stack[index].address] };
+
+        calls.count++;
+        calls.inclusive += instructions - stack[index].start;
+    }
+
+    std::fprintf(file,
+                 "# callgrind format\n"
+                 "version: 1\n"
+                 "creator: psemu\n"
+                 "positions: instr\n"
+                 "events: Instructions\n"
+                 "summary: %" PRIu64 "\n",
+                 instructions);
+
+    for (const auto& [address, function] : functions)
+    {
+        std::fprintf(file,
+                     "\nfn=%s\n0x%08X %" PRIu64 "\n",
+                     name(address).c_str(),
+                     address,
+                     function.exclusive);
+
+        auto calls{ function.calls };
+        const auto entry{ pending.find(address) };
+
+        if (entry != pending.cend())
+        {
+            for (const auto& [callee, c] : entry->second)
+            {
+                calls[callee].count     += c.count;
+                calls[callee].inclusive += c.inclusive;
+            }
+        }
+
+        for (const auto& [callee, c] : calls)
+        {
+            std::fprintf(file,
+                         "cfn=%s\ncalls=%" PRIu64 " 0x%08X\n"
+                         "0x%08X %" PRIu64 "\n",
+                         name(callee).c_str(),
+                         c.count,
+                         callee,
+                         address,
+                         c.inclusive);
+        }
+    }
+}
+
+/// @brief Writes the profile in callgrind format to a file.
+/// @param path The path of the file to write to.
+/// @return `false` if the file couldn't be opened.
+auto Profiler::write_callgrind(const std::string& path) const noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "w") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    write_callgrind(file);
+    std::fclose(file);
+
+    return true;
+}
+
+/// @brief Pushes a frame onto the shadow call stack.
+/// @param address The address of the function being called.
+/// @param return_address The address the call returns to.
+auto Profiler::push(const Word address, const Word return_address) noexcept
+-> void
+{
+    if (stack.size() == MAX_DEPTH)
+    {
+        stack.erase(stack.begin() + 1);
+    }
+
+    stack.push_back({ address,
+                      &functions[address],
+                      return_address,
+                      cpu.gpr[SP],
+                      instructions });
+}
+
+/// @brief Pops the frames a return leaves.
+/// @param target The address returned to.
+auto Profiler::unwind(const Word target) noexcept -> void
+{
+    for (auto index{ stack.size() - 1 }; index != 0; --index)
+    {
+        if (stack[index].return_address == target)
+        {
+            while (stack.size() != index)
+            {
+                pop();
+            }
+            return;
+        }
+    }
+
+    // Not returning to any frame we know of, assume the stack has been
+    // unwound (e.g. by longjmp()) and drop every frame that was called from
+    // below it.
+    while (stack.size() > 1 && stack.back().sp < cpu.gpr[SP])
+    {
+        pop();
+    }
+}
+
+/// @brief Pops the frame on top of the shadow call stack.
+auto Profiler::pop() noexcept -> void
+{
+    const auto frame{ stack.back() };
+    stack.pop_back();
+
+    auto& calls{ stack.back().function->calls[frame.address] };
+
+    calls.count++;
+    calls.inclusive += instructions - frame.start;
+}
+
+/// @brief Returns the name of a function.
+/// @param address The address of the function.
+auto Profiler::name(const Word address) const noexcept -> std::string
+{
+    const auto symbol{ symbols.find(address) };
+
+    if (symbol != symbols.cend())
+    {
+        return symbol->second;
+    }
+
+    char str[11];
+    std::snprintf(str, sizeof(str), "0x%08X", address);
+
+    return str;
+}
@@ -12,13 +12,19 @@
 // OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
 // CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
+#include <algorithm>
 #include "ps.h"
 
 using namespace PlayStation;
 
 /// @brief Initializes the PlayStation emulator.
-System::System() noexcept : cpu(bus)
-{ }
+System::System() noexcept : cpu(bus), hle(cpu, bus)
+{
+    hle.on_putchar = [this](const char c)
+    {
+        tty.put(c);
+    };
+}
 
 /// @brief Sets the BIOS data.
 /// @param data The data to use.
@@ -33,10 +39,208 @@ auto System::reset() noexcept -> void
 {
     bus.reset();
     cpu.reset();
+    hle.reset();
+
+    // A breakpoint hit before the reset must stop execution again.
+    break_pc     = 0xFFFFFFFF;
+    frame_cycles = 0;
+}
+
+/// @brief Loads a PS-X EXE into main RAM and jumps to its entry point, as the
+/// BIOS shell would.
+/// @param exe The EXE to load.
+auto System::load_exe(const EXE& exe) noexcept -> void
+{
+    // Register numbers of $gp, $sp and $fp respectively
+    constexpr auto GP{ 28 };
+    constexpr auto SP{ 29 };
+    constexpr auto FP{ 30 };
+
+    const auto copy_to_ram = [&](Word vaddr, const Byte* data, Word size)
+    {
+        const Word paddr{ (vaddr & 0x1FFFFFFF) % RAM_SIZE };
+        size = std::min<Word>(size, RAM_SIZE - paddr);
+
+        if (data)
+        {
+            std::copy_n(data, size, &bus.ram[paddr]);
+        }
+        else
+        {
+            std::fill_n(&bus.ram[paddr], size, 0x00);
+        }
+        bus.mark_dirty(paddr, size);
+    };
+
+    copy_to_ram(exe.dest, exe.text.data(), exe.text.size());
+
+    if (exe.bss_size != 0)
+    {
+        copy_to_ram(exe.bss_start, nullptr, exe.bss_size);
+    }
+
+    cpu.gpr[GP] = exe.gp;
+
+    if (exe.sp != 0)
+    {
+        cpu.gpr[SP] = exe.sp;
+        cpu.gpr[FP] = exe.sp;
+    }
+
+    cpu.set_pc(exe.pc);
+}
+
+/// @brief Starts a PS-X EXE without executing the BIOS at all.
+/// @param exe The EXE to start.
+auto System::fast_boot(const EXE& exe) noexcept -> void
+{
+    // The stack pointer the BIOS shell uses if the EXE doesn't specify one
+    constexpr Word DEFAULT_SP{ 0x801FFF00 };
+
+    reset();
+    hle.install_kernel();
+
+    cpu.gpr[29] = DEFAULT_SP;
+    cpu.gpr[30] = DEFAULT_SP;
+    cpu.gpr[31] = HLE::EXIT_ADDRESS;
+
+    load_exe(exe);
+}
+
+/// @brief Starts a PS-X EXE through the BIOS, which must have been set.
+/// @param exe The EXE to start.
+/// @return `false` if the BIOS didn't reach `SHELL_ADDRESS` within
+/// `BOOT_FRAME_LIMIT` frames, in which case the EXE isn't loaded.
+auto System::boot_exe(const EXE& exe) noexcept -> bool
+{
+    reset();
+
+    const auto shell{ bus.hooks.add_breakpoint(SHELL_ADDRESS, [](const Word)
+    {
+        return HookAction::Break;
+    }) };
+
+    unsigned int frames{ 0 };
+
+    // Breakpoints set by others are stepped over, only the shell stops us.
+    while (frames < BOOT_FRAME_LIMIT)
+    {
+        if (run_frame())
+        {
+            frames++;
+        }
+        else if (cpu.pc == SHELL_ADDRESS)
+        {
+            break;
+        }
+    }
+
+    bus.hooks.remove(shell);
+    break_pc = 0xFFFFFFFF;
+
+    if (frames == BOOT_FRAME_LIMIT)
+    {
+        return false;
+    }
+
+    load_exe(exe);
+    return true;
+}
+
+/// @brief Runs the system for one frame.
+/// @return `false` if a breakpoint stopped execution before the end of the
+/// frame, `true` otherwise.
+auto System::run_frame() noexcept -> bool
+{
+    if (frame_cycles == 0)
+    {
+        perf.begin_frame();
+    }
+
+    // A frame interrupted by a breakpoint picks up where it left off.
+    while (frame_cycles != CYCLES_PER_FRAME)
+    {
+        if (!step())
+        {
+            return false;
+        }
+        frame_cycles++;
+    }
+
+    frame_cycles = 0;
+    perf.end_frame(CYCLES_PER_FRAME);
+
+    if (cheats)
+    {
+        cheats->apply(bus);
+    }
+
+    if (frame_export)
+    {
+        frame_export->publish(bus.gpu.vram);
+    }
+
+    if (recorder)
+    {
+        recorder->push(bus.gpu.vram);
+    }
+
+    if (mirror)
+    {
+        mirror->publish(bus);
+    }
+    return true;
 }
 
 /// @brief Executes one full system step.
-auto System::step() noexcept -> void
+/// @return `false` if a breakpoint stopped execution before the current
+/// instruction, `true` otherwise. Calling this function again after a
+/// breakpoint resumes execution past it.
+auto System::step() noexcept -> bool
 {
+    if (bus.hooks.execute_hooked(cpu.pc))
+    {
+        // If we've already stopped here, the caller wants to resume. The
+        // other hooks here still have to run, e.g. to skip a function
+        // implemented by the HLE BIOS, but we mustn't stop again.
+        const bool resuming{ cpu.pc == break_pc };
+        break_pc = 0xFFFFFFFF;
+
+        switch (bus.hooks.on_execute(cpu.pc))
+        {
+            case HookAction::Continue:
+                break;
+
+            case HookAction::Skip:
+                return true;
+
+            case HookAction::Break:
+                if (resuming)
+                {
+                    break;
+                }
+
+                break_pc = cpu.pc;
+                return false;
+        }
+    }
+
+    if (profiler)
+    {
+        profiler->step();
+    }
+
+    if (coverage)
+    {
+        coverage->step(cpu.pc, cpu.instruction.word);
+    }
+
+    const Word pc{ cpu.pc };
     cpu.step();
+
+    if (on_instruction)
+    {
+        on_instruction(pc);
+    }
+    return true;
 }
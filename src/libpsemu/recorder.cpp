@@ -0,0 +1,318 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <pthread.h>
+#include "recorder.h"
+
+using namespace PlayStation;
+
+/// @brief Quotes a string for the shell.
+/// @param text The string to quote.
+static auto shell_quote(const std::string& text) noexcept -> std::string
+{
+    std::string quoted{ "'" };
+
+    for (const auto c : text)
+    {
+        quoted += c == '\'' ? std::string{ "'\\''" } : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+/// @brief Determines if a string ends with another.
+/// @param text The string to check.
+/// @param suffix The suffix to look for.
+static auto ends_with(const std::string& text, const std::string& suffix)
+noexcept -> bool
+{
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/// @brief Finishes the recording, if any, see `close()`.
+Recorder::~Recorder() noexcept
+{
+    close();
+}
+
+/// @brief Starts recording to a file, replacing it.
+/// @param path The path of the file to write.
+/// @param queue_length The number of frames that may be waiting to be written
+/// before frames are dropped.
+/// @return `false` if the file or encoder couldn't be opened.
+auto Recorder::open(const std::string& path, const std::size_t queue_length)
+noexcept -> bool
+{
+    close();
+
+    if (queue_length == 0)
+    {
+        return false;
+    }
+
+    format = ends_with(path, ".y4m") ? Format::Y4M : Format::FFV1;
+
+    if (format == Format::Y4M)
+    {
+        file = std::fopen(path.c_str(), "wb");
+
+        if (!file)
+        {
+            return false;
+        }
+
+        std::fprintf(file,
+                     "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n",
+                     VRAM_WIDTH,
+                     VRAM_HEIGHT,
+                     FRAME_RATE);
+
+        // Every pixel is one of 32768 colors, so convert each only once.
+        yuv.resize(32768);
+
+        for (std::uint32_t pixel{ 0 }; pixel < yuv.size(); ++pixel)
+        {
+            const auto expand = [&](const unsigned int shift) -> int
+            {
+                const int c = (pixel >> shift) & 0x1F;
+                return (c << 3) | (c >> 2);
+            };
+
+            const auto r{ expand(0) };
+            const auto g{ expand(5) };
+            const auto b{ expand(10) };
+
+            const auto y{ ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16 };
+            const auto u{ ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128 };
+            const auto v{ ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128 };
+
+            yuv[pixel] = (y << 16) | (u << 8) | v;
+        }
+        planes.resize(VRAM_WIDTH * VRAM_HEIGHT * 3);
+    }
+    else
+    {
+        if (std::system("ffmpeg -version > /dev/null 2>&1") != 0)
+        {
+            return false;
+        }
+
+        // VRAM pixels are what FFmpeg calls BGR555: red in the low bits.
+        const std::string command
+        {
+            "ffmpeg -loglevel error -y -f rawvideo -pixel_format bgr555le "
+            "-video_size " + std::to_string(VRAM_WIDTH) + "x" +
+            std::to_string(VRAM_HEIGHT) + " -framerate " +
+            std::to_string(FRAME_RATE) + " -i - -c:v ffv1 -level 3 " +
+            shell_quote(path)
+        };
+
+        file = popen(command.c_str(), "w");
+
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    queue.resize(queue_length);
+
+    head            = 0;
+    count           = 0;
+    stopping        = false;
+    failed          = false;
+    frames_recorded = 0;
+    frames_dropped  = 0;
+
+    thread = std::thread{ &Recorder::writer, this };
+    return true;
+}
+
+/// @brief Writes the frames still queued and closes the file.
+/// @return `false` if anything couldn't be written.
+auto Recorder::close() noexcept -> bool
+{
+    if (!file)
+    {
+        return true;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock{ mutex };
+        stopping = true;
+    }
+
+    // The writer closes the file itself.
+    queued.notify_one();
+    thread.join();
+
+    file = nullptr;
+
+    queue.clear();
+    queue.shrink_to_fit();
+
+    return !failed;
+}
+
+/// @brief Queues a frame for writing, without waiting unless `drop_frames` is
+/// cleared.
+/// @param vram The contents of VRAM at the end of the frame.
+/// @return `false` if the frame was dropped, or nothing is being recorded.
+auto Recorder::push(const VRAM& vram) noexcept -> bool
+{
+    if (!file)
+    {
+        return false;
+    }
+
+    std::size_t index;
+
+    {
+        std::unique_lock<std::mutex> lock{ mutex };
+
+        // Frames can't be written once a write has failed.
+        if (failed)
+        {
+            frames_dropped++;
+            return false;
+        }
+
+        if (count == queue.size())
+        {
+            if (drop_frames)
+            {
+                frames_dropped++;
+                return false;
+            }
+            written.wait(lock, [this]() { return count != queue.size(); });
+        }
+        index = (head + count) % queue.size();
+    }
+
+    // Only this thread adds frames, and the writer won't touch the buffer
+    // until it is counted, so it can be filled without holding the lock.
+    queue[index] = vram;
+
+    {
+        const std::lock_guard<std::mutex> lock{ mutex };
+        count++;
+    }
+
+    queued.notify_one();
+    return true;
+}
+
+/// @brief Returns the number of frames written so far.
+auto Recorder::recorded() const noexcept -> std::uint64_t
+{
+    const std::lock_guard<std::mutex> lock{ mutex };
+    return frames_recorded;
+}
+
+/// @brief Returns the number of frames dropped so far.
+auto Recorder::dropped() const noexcept -> std::uint64_t
+{
+    const std::lock_guard<std::mutex> lock{ mutex };
+    return frames_dropped;
+}
+
+/// @brief Background thread entry point: converts and writes queued frames
+/// until the recording is closed, then closes the file. Frames queued after a
+/// write failed are dropped.
+auto Recorder::writer() noexcept -> void
+{
+    // If FFmpeg exits early, e.g. because it can't create the file, writing
+    // to it would raise SIGPIPE and kill the emulator. With the signal
+    // blocked in this thread, the write fails with EPIPE instead.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    std::unique_lock<std::mutex> lock{ mutex };
+
+    for (;;)
+    {
+        queued.wait(lock, [this]() { return count != 0 || stopping; });
+
+        if (count == 0)
+        {
+            // Closing the file flushes it, which must happen here too.
+            lock.unlock();
+
+            const bool closed
+            {
+                format == Format::Y4M ? std::fclose(file) == 0 :
+                                        pclose(file) == 0
+            };
+
+            lock.lock();
+            failed |= !closed;
+
+            return;
+        }
+
+        const auto& frame{ queue[head] };
+
+        // Once a write has failed, the rest of the frames are dropped.
+        const bool write{ !failed };
+
+        // Writing takes the longest, don't keep the emulator from queueing
+        // frames meanwhile.
+        lock.unlock();
+        const bool ok{ write && write_frame(frame) };
+        lock.lock();
+
+        head = (head + 1) % queue.size();
+        count--;
+
+        frames_recorded += ok;
+        frames_dropped  += !write;
+        failed          |= !ok;
+
+        written.notify_one();
+    }
+}
+
+/// @brief Writes a frame to the file.
+/// @param frame The frame to write.
+/// @return `false` if it couldn't be written.
+auto Recorder::write_frame(const VRAM& frame) noexcept -> bool
+{
+    if (format == Format::FFV1)
+    {
+        return std::fwrite(frame.data(), sizeof(frame), 1, file) == 1;
+    }
+
+    constexpr std::size_t PLANE_SIZE{ VRAM_WIDTH * VRAM_HEIGHT };
+
+    auto y{ planes.data() };
+    auto u{ y + PLANE_SIZE };
+    auto v{ u + PLANE_SIZE };
+
+    for (const auto pixel : frame)
+    {
+        const auto value{ yuv[pixel & 0x7FFF] };
+
+        *y++ = value >> 16;
+        *u++ = value >> 8;
+        *v++ = value;
+    }
+
+    return std::fputs("FRAME\n", file) >= 0 &&
+           std::fwrite(planes.data(), planes.size(), 1, file) == 1;
+}
@@ -0,0 +1,475 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include "snapshot.h"
+
+using namespace PlayStation;
+
+/// @brief Identifies serialized snapshots
+static constexpr char MAGIC[8]{ 'P', 'S', 'X', 'S', 'T', 'A', 'T', 'E' };
+
+/// @brief Version of the serialized format, to be incremented whenever the
+/// state changes
+constexpr Word SERIALIZED_VERSION{ 1 };
+
+/// @brief Number of GP0 command parameters kept in a serialized snapshot,
+/// which is more than any command takes
+constexpr std::size_t MAX_COMMAND_PARAMS{ 16 };
+
+// The COP0 registers are written out as is.
+static_assert(std::is_trivially_copyable_v<decltype(CPU::cop0)>);
+
+/// @brief Size of a serialized snapshot
+constexpr std::size_t SERIALIZED_SIZE
+{
+    sizeof(MAGIC) + sizeof(Word) +
+
+    // Main RAM, scratchpad and VRAM
+    RAM_SIZE + SCRATCHPAD_SIZE + sizeof(VRAM) +
+
+    // CPU registers, current instruction and pending load
+    (32 * sizeof(Word)) + (5 * sizeof(Word)) + sizeof(decltype(CPU::cop0)) +
+    (3 * sizeof(Word)) +
+
+    // GPUREAD, GP0 port state and current command
+    (8 * sizeof(Word)) + (MAX_COMMAND_PARAMS * sizeof(Word)) +
+
+    // HLE state
+    2 + (2 * sizeof(Word)) +
+
+    // Breakpoint and frame position
+    (2 * sizeof(Word))
+};
+
+/// @brief Writes a value to memory, advancing past it.
+/// @param data Where to write.
+/// @param value The value to write.
+template<typename T>
+static auto put(Byte*& data, const T& value) noexcept -> void
+{
+    std::memcpy(data, &value, sizeof(value));
+    data += sizeof(value);
+}
+
+/// @brief Reads a value from memory, advancing past it.
+/// @param data Where to read.
+/// @param value Where to store the value.
+template<typename T>
+static auto get(const Byte*& data, T& value) noexcept -> void
+{
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+}
+
+/// @brief Clears the snapshot's dirty flag of every page of a memory.
+/// @param dirty The dirty flags of each page of the memory.
+template<std::size_t N>
+static auto clear_flags(std::array<Byte, N>& dirty) noexcept -> void
+{
+    for (auto& flags : dirty)
+    {
+        flags &= ~DIRTY_SNAPSHOT;
+    }
+}
+
+/// @brief Captures the state of a system, and starts tracking the pages it
+/// writes to.
+/// @param system The system to capture.
+auto Snapshot::capture(System& system) noexcept -> void
+{
+    auto& bus{ system.bus };
+
+    ram.assign(bus.ram.begin(), bus.ram.end());
+    vram.assign(bus.gpu.vram.begin(), bus.gpu.vram.end());
+    scratchpad = bus.scratchpad;
+
+    clear_flags(bus.ram_dirty);
+    clear_flags(bus.gpu.vram_dirty);
+
+    capture_registers(system);
+}
+
+/// @brief Captures the state of a system other than its memory.
+/// @param system The system to capture.
+auto Snapshot::capture_registers(const System& system) noexcept -> void
+{
+    const auto& bus{ system.bus };
+    const auto& c{ system.cpu };
+
+    cpu.gpr         = c.gpr;
+    cpu.pc          = c.pc;
+    cpu.next_pc     = c.next_pc;
+    cpu.hi          = c.hi;
+    cpu.lo          = c.lo;
+    cpu.instruction = c.instruction.word;
+    cpu.cop0        = c.cop0;
+
+    // The pending load refers to a register by address, which is meaningless
+    // outside of the CPU it was taken from.
+    cpu.delay_slot_reg    = c.delay_slot.pending ?
+                            static_cast<int>(c.delay_slot.reg - c.gpr.data()) :
+                            -1;
+    cpu.delay_slot_value  = c.delay_slot.value;
+    cpu.delay_slot_instrs = c.delay_slot.instrs;
+
+    gpu.gpuread   = bus.gpu.gpuread;
+    gpu.gp0_state = bus.gpu.gp0_state;
+    gpu.cmd       = bus.gpu.cmd;
+
+    hle.bios_free       = system.hle.bios_free;
+    hle.has_exited      = system.hle.has_exited;
+    hle.guest_exit_code = system.hle.guest_exit_code;
+    hle.seed            = system.hle.seed;
+
+    break_pc     = system.break_pc;
+    frame_cycles = system.frame_cycles;
+}
+
+/// @brief Copies the dirty pages of a memory back from the snapshot, marking
+/// them clean.
+/// @param dst The memory to restore.
+/// @param src The captured contents of the memory.
+/// @param dirty The dirty flags of each page of the memory.
+/// @return The number of pages copied.
+template<typename T, std::size_t N>
+static auto restore_pages(T* dst,
+                          const T* src,
+                          std::array<Byte, N>& dirty) noexcept -> std::size_t
+{
+    constexpr auto PAGE_LENGTH{ DIRTY_PAGE_SIZE / sizeof(T) };
+    std::size_t copied{ 0 };
+
+    for (std::size_t page{ 0 }; page < N; ++page)
+    {
+        if (dirty[page] & DIRTY_SNAPSHOT)
+        {
+            std::copy_n(&src[page * PAGE_LENGTH],
+                        PAGE_LENGTH,
+                        &dst[page * PAGE_LENGTH]);
+
+            // The page has changed as far as everybody else is concerned.
+            dirty[page] = DIRTY_ALL & ~DIRTY_SNAPSHOT;
+            copied++;
+        }
+    }
+    return copied;
+}
+
+/// @brief Restores a system to the captured state.
+/// @param system The system to restore, which must be the one the snapshot
+/// was captured from.
+/// @return The number of pages of main RAM and VRAM copied.
+auto Snapshot::restore(System& system) const noexcept -> std::size_t
+{
+    auto& bus{ system.bus };
+    auto& c{ system.cpu };
+
+    const auto copied{ restore_pages(bus.ram.data(),
+                                     ram.data(),
+                                     bus.ram_dirty) +
+                       restore_pages(bus.gpu.vram.data(),
+                                     vram.data(),
+                                     bus.gpu.vram_dirty) };
+
+    bus.scratchpad = scratchpad;
+
+    c.gpr              = cpu.gpr;
+    c.pc               = cpu.pc;
+    c.next_pc          = cpu.next_pc;
+    c.hi               = cpu.hi;
+    c.lo               = cpu.lo;
+    c.instruction.word = cpu.instruction;
+    c.cop0             = cpu.cop0;
+
+    c.delay_slot = { };
+
+    if (cpu.delay_slot_reg >= 0)
+    {
+        c.delay_slot.reg     = &c.gpr[cpu.delay_slot_reg];
+        c.delay_slot.value   = cpu.delay_slot_value;
+        c.delay_slot.instrs  = cpu.delay_slot_instrs;
+        c.delay_slot.pending = true;
+    }
+
+    bus.gpu.gpuread   = gpu.gpuread;
+    bus.gpu.gp0_state = gpu.gp0_state;
+    bus.gpu.cmd       = gpu.cmd;
+
+    system.hle.bios_free       = hle.bios_free;
+    system.hle.has_exited      = hle.has_exited;
+    system.hle.guest_exit_code = hle.guest_exit_code;
+    system.hle.seed            = hle.seed;
+
+    system.break_pc     = break_pc;
+    system.frame_cycles = frame_cycles;
+
+    return copied;
+}
+
+/// @brief Restores the captured state in full into any system, e.g. a fresh
+/// one running on another thread. The system must use the same BIOS as the
+/// one the snapshot was captured from.
+/// @param system The system to restore.
+auto Snapshot::load(System& system) const noexcept -> void
+{
+    system.bus.ram_dirty.fill(DIRTY_ALL);
+    system.bus.gpu.vram_dirty.fill(DIRTY_ALL);
+
+    restore(system);
+}
+
+/// @brief Returns the size of the data written by `serialize()`, which is the
+/// same for every snapshot.
+auto Snapshot::serialized_size() noexcept -> std::size_t
+{
+    return SERIALIZED_SIZE;
+}
+
+/// @brief Writes the captured state to memory, e.g. for a save state. The
+/// format is specific to this version of the emulator.
+/// @param data Where to write `serialized_size()` bytes.
+auto Snapshot::serialize(Byte* data) const noexcept -> void
+{
+    write(data, ram.data(), scratchpad.data(), vram.data());
+}
+
+/// @brief Writes the state of a system to memory in the format of
+/// `serialize()`, copying its memory once rather than capturing it first.
+/// Only the registers are captured into the snapshot, which must be captured
+/// or unserialized again before it is restored or loaded.
+/// @param system The system to write the state of.
+/// @param data Where to write `serialized_size()` bytes.
+auto Snapshot::serialize(const System& system, Byte* data) noexcept -> void
+{
+    const auto& bus{ system.bus };
+
+    capture_registers(system);
+    write(data, bus.ram.data(), bus.scratchpad.data(), bus.gpu.vram.data());
+}
+
+/// @brief Writes the captured registers and the given memory in the format
+/// of `serialize()`.
+/// @param data Where to write `serialized_size()` bytes.
+/// @param ram_data Main RAM.
+/// @param scratchpad_data The scratchpad.
+/// @param vram_data VRAM.
+auto Snapshot::write(Byte* data,
+                     const Byte* ram_data,
+                     const Byte* scratchpad_data,
+                     const Halfword* vram_data) const noexcept -> void
+{
+    std::memcpy(data, MAGIC, sizeof(MAGIC));
+    data += sizeof(MAGIC);
+
+    put(data, SERIALIZED_VERSION);
+
+    data = std::copy_n(ram_data, RAM_SIZE, data);
+    data = std::copy_n(scratchpad_data, SCRATCHPAD_SIZE, data);
+
+    std::memcpy(data, vram_data, sizeof(VRAM));
+    data += sizeof(VRAM);
+
+    put(data, cpu.gpr);
+    put(data, cpu.pc);
+    put(data, cpu.next_pc);
+    put(data, cpu.hi);
+    put(data, cpu.lo);
+    put(data, cpu.instruction);
+    put(data, cpu.cop0);
+    put(data, static_cast<std::int32_t>(cpu.delay_slot_reg));
+    put(data, cpu.delay_slot_value);
+    put(data, static_cast<Word>(cpu.delay_slot_instrs));
+
+    const auto params{ std::min(gpu.cmd.params.size(), MAX_COMMAND_PARAMS) };
+
+    put(data, gpu.gpuread);
+    put(data, static_cast<Word>(gpu.gp0_state));
+    put(data, static_cast<Word>(gpu.cmd.command));
+    put(data, static_cast<Word>(gpu.cmd.remaining_words));
+    put(data, static_cast<std::int32_t>(gpu.cmd.vram_x_pos));
+    put(data, static_cast<std::int32_t>(gpu.cmd.vram_y_pos));
+    put(data, static_cast<std::int32_t>(gpu.cmd.vram_x_pos_max));
+    put(data, static_cast<Word>(params));
+
+    // There are usually no parameters, and the vector has no storage then.
+    for (std::size_t index{ 0 }; index < params; ++index)
+    {
+        put(data, gpu.cmd.params[index]);
+    }
+
+    std::memset(data, 0, (MAX_COMMAND_PARAMS - params) * sizeof(Word));
+    data += (MAX_COMMAND_PARAMS - params) * sizeof(Word);
+
+    put(data, static_cast<Byte>(hle.bios_free));
+    put(data, static_cast<Byte>(hle.has_exited));
+    put(data, hle.guest_exit_code);
+    put(data, hle.seed);
+
+    put(data, break_pc);
+    put(data, static_cast<std::int32_t>(frame_cycles));
+}
+
+/// @brief Determines if the GP0 command state is one the GPU can be in, so
+/// that it can't index outside of its parameters.
+auto Snapshot::valid_command() const noexcept -> bool
+{
+    const auto& cmd{ gpu.cmd };
+
+    // Copies may run past the right and bottom edges of VRAM, which wrap.
+    if (cmd.vram_x_pos < 0 || cmd.vram_x_pos > cmd.vram_x_pos_max ||
+        cmd.vram_x_pos_max >= VRAM_WIDTH * 2 ||
+        cmd.vram_y_pos < 0 || cmd.vram_y_pos >= VRAM_HEIGHT * 2)
+    {
+        return false;
+    }
+
+    switch (gpu.gp0_state)
+    {
+        case GPU::GP0State::AwaitingCommand:
+            return cmd.command == GPU::Command::None;
+
+        // Every command takes two parameters, the dot takes its first one
+        // from the command word itself.
+        case GPU::GP0State::ReceivingParameters:
+            return cmd.command != GPU::Command::None &&
+                   cmd.remaining_words != 0 &&
+                   cmd.params.size() + cmd.remaining_words == 2;
+
+        case GPU::GP0State::ReceivingData:
+            return cmd.command == GPU::Command::CopyToVRAM &&
+                   cmd.params.size() >= 2;
+
+        case GPU::GP0State::TransferringData:
+            return cmd.command == GPU::Command::CopyFromVRAM &&
+                   cmd.params.size() >= 2;
+    }
+    return false;
+}
+
+/// @brief Reads state written by `serialize()` into the snapshot, which can
+/// then be loaded into a system.
+/// @param data The state to read.
+/// @param size The size of the state, in bytes.
+/// @return `false` if the data is not a serialized snapshot, or describes a
+/// state the system can't be in.
+auto Snapshot::unserialize(const Byte* data, const std::size_t size) noexcept
+-> bool
+{
+    if (size != SERIALIZED_SIZE ||
+        std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        return false;
+    }
+
+    data += sizeof(MAGIC);
+
+    Word version;
+    get(data, version);
+
+    if (version != SERIALIZED_VERSION)
+    {
+        return false;
+    }
+
+    ram.assign(data, data + RAM_SIZE);
+    data += RAM_SIZE;
+
+    std::copy_n(data, scratchpad.size(), scratchpad.begin());
+    data += scratchpad.size();
+
+    vram.resize(VRAM_WIDTH * VRAM_HEIGHT);
+    std::memcpy(vram.data(), data, sizeof(VRAM));
+    data += sizeof(VRAM);
+
+    std::int32_t value;
+    Word word;
+
+    get(data, cpu.gpr);
+    get(data, cpu.pc);
+    get(data, cpu.next_pc);
+    get(data, cpu.hi);
+    get(data, cpu.lo);
+    get(data, cpu.instruction);
+    get(data, cpu.cop0);
+    get(data, value);
+    get(data, cpu.delay_slot_value);
+    get(data, word);
+
+    // Anything else would index past the registers.
+    cpu.delay_slot_reg    = value >= 0 && value < 32 ? value : -1;
+    cpu.delay_slot_instrs = word;
+
+    get(data, gpu.gpuread);
+    get(data, word);
+
+    if (word > static_cast<Word>(GPU::GP0State::TransferringData))
+    {
+        return false;
+    }
+
+    gpu.gp0_state = static_cast<GPU::GP0State>(word);
+    get(data, word);
+
+    if (word > static_cast<Word>(GPU::Command::CopyFromVRAM))
+    {
+        return false;
+    }
+
+    gpu.cmd.command = static_cast<GPU::Command>(word);
+    get(data, word);
+    gpu.cmd.remaining_words = word;
+    get(data, value);
+    gpu.cmd.vram_x_pos = value;
+    get(data, value);
+    gpu.cmd.vram_y_pos = value;
+    get(data, value);
+    gpu.cmd.vram_x_pos_max = value;
+    get(data, word);
+
+    if (word > MAX_COMMAND_PARAMS)
+    {
+        return false;
+    }
+
+    gpu.cmd.params.resize(word);
+
+    for (auto& param : gpu.cmd.params)
+    {
+        get(data, param);
+    }
+    data += (MAX_COMMAND_PARAMS - word) * sizeof(Word);
+
+    if (!valid_command())
+    {
+        return false;
+    }
+
+    Byte flag;
+
+    get(data, flag);
+    hle.bios_free = flag != 0;
+    get(data, flag);
+    hle.has_exited = flag != 0;
+    get(data, hle.guest_exit_code);
+    get(data, hle.seed);
+
+    get(data, break_pc);
+    get(data, value);
+    frame_cycles = value;
+
+    return true;
+}
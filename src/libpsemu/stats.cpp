@@ -0,0 +1,226 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cinttypes>
+#include "stats.h"
+
+using namespace PlayStation;
+
+thread_local Stats Stats::this_thread;
+
+/// @brief Mnemonics of the instructions, indexed by opcode. Opcodes that
+/// aren't listed are printed in hexadecimal.
+static constexpr std::array<const char*, 64> opcode_names
+{
+    "SPECIAL", "BCOND", "J",     "JAL",   "BEQ",  "BNE", "BLEZ",  "BGTZ",
+    "ADDI",    "ADDIU", "SLTI",  "SLTIU", "ANDI", "ORI", "XORI",  "LUI",
+    "COP0",    "COP1",  "COP2",  "COP3",  nullptr, nullptr, nullptr, nullptr,
+    nullptr,   nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    "LB",      "LH",    "LWL",   "LW",    "LBU",  "LHU", "LWR",   nullptr,
+    "SB",      "SH",    "SWL",   "SW",    nullptr, nullptr, "SWR", nullptr,
+    "LWC0",    "LWC1",  "LWC2",  "LWC3",  nullptr, nullptr, nullptr, nullptr,
+    "SWC0",    "SWC1",  "SWC2",  "SWC3",  nullptr, nullptr, nullptr, nullptr
+};
+
+/// @brief Mnemonics of the SPECIAL instructions, indexed by funct.
+static constexpr std::array<const char*, 64> special_names
+{
+    "SLL",   "",      "SRL",  "SRA",   "SLLV",    "",      "SRLV", "SRAV",
+    "JR",    "JALR",  "",     "",      "SYSCALL", "BREAK", "",     "",
+    "MFHI",  "MTHI",  "MFLO", "MTLO",  "",        "",      "",     "",
+    "MULT",  "MULTU", "DIV",  "DIVU",  "",        "",      "",     "",
+    "ADD",   "ADDU",  "SUB",  "SUBU",  "AND",     "OR",    "XOR",  "NOR",
+    "",      "",      "SLT",  "SLTU",  "",        "",      "",     "",
+    "",      "",      "",     "",      "",        "",      "",     "",
+    "",      "",      "",     "",      "",        "",      "",     ""
+};
+
+/// @brief Names of the regions, indexed by `Stats::Region`.
+static constexpr std::array<const char*, Stats::RegionCount> region_names
+{
+    "RAM",
+    "Expansion1",
+    "Scratchpad",
+    "MemoryControl",
+    "Peripheral",
+    "InterruptControl",
+    "DMA",
+    "Timers",
+    "CDROM",
+    "GPU",
+    "MDEC",
+    "SPU",
+    "Expansion2",
+    "BIOS",
+    "CacheControl",
+    "Unknown"
+};
+
+/// @brief Names of the exceptions, indexed by exception code.
+static constexpr std::array<const char*, 13> exception_names
+{
+    "Int", "Mod", "TLBL", "TLBS", "AdEL", "AdES", "IBE", "DBE", "Sys", "Bp",
+    "RI",  "CpU", "Ov"
+};
+
+/// @brief Determines which region a physical address belongs to.
+/// @param paddr The physical address.
+auto Stats::region(const Word paddr) noexcept -> Region
+{
+    switch (paddr)
+    {
+        case 0x00000000 ... 0x007FFFFF: return RAM;
+        case 0x1F000000 ... 0x1F7FFFFF: return Expansion1;
+        case 0x1F800000 ... 0x1F8003FF: return Scratchpad;
+        case 0x1F801000 ... 0x1F801023: return MemoryControl;
+        case 0x1F801040 ... 0x1F80105F: return Peripheral;
+        case 0x1F801060 ... 0x1F801063: return MemoryControl;
+        case 0x1F801070 ... 0x1F801077: return InterruptControl;
+        case 0x1F801080 ... 0x1F8010FF: return DMA;
+        case 0x1F801100 ... 0x1F80112F: return Timers;
+        case 0x1F801800 ... 0x1F801803: return CDROM;
+        case 0x1F801810 ... 0x1F801817: return GPU;
+        case 0x1F801820 ... 0x1F801827: return MDEC;
+        case 0x1F801C00 ... 0x1F801FFF: return SPU;
+        case 0x1F802000 ... 0x1F803FFF: return Expansion2;
+        case 0x1FC00000 ... 0x1FC7FFFF: return BIOS;
+        case 0x1FFE0130:                return CacheControl;
+        default:                        return Unknown;
+    }
+}
+
+/// @brief Resets every counter to zero.
+auto Stats::reset() noexcept -> void
+{
+    *this = { };
+}
+
+/// @brief Writes every counter as a JSON object.
+/// @param file The stream to write to.
+auto Stats::write_json(FILE* file) const noexcept -> void
+{
+    // Writes the non-zero counters of a table as a JSON object.
+    const auto table = [&](const char* key,
+                           const std::array<std::uint64_t, 64>& counts,
+                           const std::array<const char*, 64>& names)
+    {
+        auto separator{ "" };
+
+        std::fprintf(file, "  \"%s\": {", key);
+
+        for (std::size_t index{ 0 }; index < counts.size(); ++index)
+        {
+            if (counts[index] == 0)
+            {
+                continue;
+            }
+
+            const char* name{ names[index] };
+            char hex[5];
+
+            if (!name || !*name)
+            {
+                std::snprintf(hex, sizeof(hex), "0x%02X",
+                              static_cast<unsigned int>(index));
+                name = hex;
+            }
+
+            std::fprintf(file,
+                         "%s\n    \"%s\": %" PRIu64,
+                         separator,
+                         name,
+                         counts[index]);
+            separator = ",";
+        }
+        std::fprintf(file, "\n  },\n");
+    };
+
+    std::fprintf(file,
+                 "{\n  \"instructions\": %" PRIu64 ",\n",
+                 instructions);
+
+    table("opcodes", opcodes, opcode_names);
+    table("special", special, special_names);
+
+    for (auto store{ 0 }; store < 2; ++store)
+    {
+        auto separator{ "" };
+
+        std::fprintf(file, "  \"%s\": {", store ? "stores" : "loads");
+
+        for (auto region{ 0 }; region < RegionCount; ++region)
+        {
+            const auto& widths{ accesses[store][region] };
+
+            if (widths[0] == 0 && widths[1] == 0 && widths[2] == 0)
+            {
+                continue;
+            }
+
+            std::fprintf(file,
+                         "%s\n    \"%s\": { \"8\": %" PRIu64
+                         ", \"16\": %" PRIu64 ", \"32\": %" PRIu64 " }",
+                         separator,
+                         region_names[region],
+                         widths[0],
+                         widths[1],
+                         widths[2]);
+            separator = ",";
+        }
+        std::fprintf(file, "\n  },\n");
+    }
+
+    auto separator{ "" };
+
+    std::fprintf(file, "  \"exceptions\": {");
+
+    for (std::size_t code{ 0 }; code < exceptions.size(); ++code)
+    {
+        if (exceptions[code] == 0)
+        {
+            continue;
+        }
+
+        char hex[5];
+        std::snprintf(hex, sizeof(hex), "0x%02X",
+                      static_cast<unsigned int>(code));
+
+        std::fprintf(file,
+                     "%s\n    \"%s\": %" PRIu64,
+                     separator,
+                     code < exception_names.size() ? exception_names[code] :
+                                                     hex,
+                     exceptions[code]);
+        separator = ",";
+    }
+    std::fprintf(file, "\n  }\n}\n");
+}
+
+/// @brief Writes every counter as a JSON object to a file.
+/// @param path The path of the file to write to.
+/// @return `false` if the file couldn't be opened.
+auto Stats::write_json(const std::string& path) const noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "w") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    write_json(file);
+    std::fclose(file);
+
+    return true;
+}
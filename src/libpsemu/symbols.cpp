@@ -0,0 +1,58 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cstdio>
+#include "symbols.h"
+
+using namespace PlayStation;
+
+/// @brief Reads function names from a file. Every line is expected to be
+/// either "address name" or "address type name" (as printed by `nm`), with
+/// the address in hexadecimal.
+/// @param path The path of the file to read.
+/// @param symbols Where to add the names.
+/// @return `false` if the file couldn't be opened.
+auto PlayStation::read_symbols(const std::string& path,
+                               Symbols& symbols) noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "r") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    char line[512];
+
+    while (std::fgets(line, sizeof(line), file))
+    {
+        unsigned int address;
+        char first[256];
+        char second[256];
+
+        switch (std::sscanf(line, "%x %255s %255s", &address, first, second))
+        {
+            case 2:
+                symbols[address] = first;
+                break;
+
+            case 3:
+                symbols[address] = second;
+                break;
+        }
+    }
+
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,272 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cstring>
+#include "cpu.h"
+#include "trace.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace PlayStation;
+
+/// @brief Size of the header of a trace file
+constexpr std::size_t HEADER_SIZE{ 16 };
+
+/// @brief Size of a record in a trace file
+constexpr std::size_t RECORD_SIZE{ 35 * sizeof(Word) };
+
+// Records are copied as is, which is only correct if the layout matches.
+static_assert(sizeof(TraceRecord) == RECORD_SIZE);
+
+/// @brief Amount of data read before the pages containing it are released
+constexpr std::size_t RELEASE_INTERVAL{ 32 * 1024 * 1024 };
+
+/// @brief Number of records buffered by the writer
+constexpr std::size_t WRITE_BUFFER_RECORDS{ 4096 };
+
+/// @brief Closes the trace.
+TraceReader::~TraceReader() noexcept
+{
+    close();
+}
+
+/// @brief Opens a trace file.
+/// @param path The path of the file to open.
+/// @return `false` if the file couldn't be opened or is not a trace.
+auto TraceReader::open(const std::string& path) noexcept -> bool
+{
+    close();
+
+    Byte header[HEADER_SIZE];
+
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd{ ::open(path.c_str(), O_RDONLY) };
+
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(HEADER_SIZE))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping{ mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) };
+
+    // The mapping keeps the file open on its own.
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // We only ever read forward.
+    madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+
+    data   = static_cast<const Byte*>(mapping);
+    length = st.st_size;
+
+    std::memcpy(header, data, HEADER_SIZE);
+#else
+    file = std::fopen(path.c_str(), "rb");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    length = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+
+    if (std::fread(header, 1, HEADER_SIZE, file) != HEADER_SIZE)
+    {
+        close();
+        return false;
+    }
+#endif
+
+    Word version;
+    Word record_size;
+
+    std::memcpy(&version,     &header[8],  sizeof(Word));
+    std::memcpy(&record_size, &header[12], sizeof(Word));
+
+    if (std::memcmp(header, "PSXTRACE", 8) != 0 ||
+        version != TRACE_VERSION ||
+        record_size != RECORD_SIZE)
+    {
+        close();
+        return false;
+    }
+
+    offset   = HEADER_SIZE;
+    released = 0;
+    count    = 0;
+
+    return true;
+}
+
+/// @brief Closes the trace.
+auto TraceReader::close() noexcept -> void
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (data)
+    {
+        munmap(const_cast<Byte*>(data), length);
+    }
+#else
+    if (file)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+#endif
+    data   = nullptr;
+    length = 0;
+    offset = 0;
+}
+
+/// @brief Reads the next record.
+/// @param record Where to store the record.
+/// @return `false` if there are no records left.
+auto TraceReader::next(TraceRecord& record) noexcept -> bool
+{
+    if (length - offset < RECORD_SIZE)
+    {
+        return false;
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    std::memcpy(&record, &data[offset], RECORD_SIZE);
+#else
+    if (std::fread(&record, 1, RECORD_SIZE, file) != RECORD_SIZE)
+    {
+        return false;
+    }
+#endif
+
+    offset += RECORD_SIZE;
+    count++;
+
+    if (offset - released >= RELEASE_INTERVAL)
+    {
+        release();
+    }
+    return true;
+}
+
+/// @brief Returns the number of records read so far.
+auto TraceReader::position() const noexcept -> std::uint64_t
+{
+    return count;
+}
+
+/// @brief Returns the total number of records in the trace.
+auto TraceReader::size() const noexcept -> std::uint64_t
+{
+    return length < HEADER_SIZE ? 0 : (length - HEADER_SIZE) / RECORD_SIZE;
+}
+
+/// @brief Releases the pages of the mapping that have been read.
+auto TraceReader::release() noexcept -> void
+{
+#if defined(__unix__) || defined(__APPLE__)
+    // Only whole pages can be released; the page containing the next record
+    // is kept.
+    const auto page_size{ static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) };
+    const auto end{ offset & ~(page_size - 1) };
+
+    if (end > released)
+    {
+        madvise(const_cast<Byte*>(&data[released]),
+                end - released,
+                MADV_DONTNEED);
+    }
+    released = end;
+#else
+    released = offset;
+#endif
+}
+
+/// @brief Flushes and closes the trace.
+TraceWriter::~TraceWriter() noexcept
+{
+    close();
+}
+
+/// @brief Creates a trace file, replacing its contents.
+/// @param path The path of the file to write to.
+/// @return `false` if the file couldn't be opened.
+auto TraceWriter::open(const std::string& path) noexcept -> bool
+{
+    close();
+
+    file = std::fopen(path.c_str(), "wb");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    const Word header[2]{ TRACE_VERSION, RECORD_SIZE };
+
+    std::fwrite("PSXTRACE", 1, 8, file);
+    std::fwrite(header, 1, sizeof(header), file);
+
+    buffer.reserve(WRITE_BUFFER_RECORDS * RECORD_SIZE);
+    return true;
+}
+
+/// @brief Flushes and closes the trace.
+auto TraceWriter::close() noexcept -> void
+{
+    if (!file)
+    {
+        return;
+    }
+
+    std::fwrite(buffer.data(), 1, buffer.size(), file);
+    std::fclose(file);
+
+    file = nullptr;
+    buffer.clear();
+}
+
+/// @brief Writes a record of the current state of a CPU.
+/// @param pc The address of the instruction that was just executed.
+/// @param cpu The CPU that executed it.
+auto TraceWriter::write(const Word pc, const CPU& cpu) noexcept -> void
+{
+    const TraceRecord record{ pc, cpu.gpr, cpu.hi, cpu.lo };
+    const auto bytes{ reinterpret_cast<const Byte*>(&record) };
+
+    buffer.insert(buffer.end(), bytes, bytes + RECORD_SIZE);
+
+    if (buffer.size() == buffer.capacity())
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        buffer.clear();
+    }
+}
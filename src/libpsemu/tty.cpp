@@ -0,0 +1,151 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include "tty.h"
+
+using namespace PlayStation;
+
+/// @brief Initializes the TTY, writing to `stdout`.
+TTY::TTY() noexcept
+{ }
+
+/// @brief Flushes any pending output and closes the file opened by
+/// `to_file()`, if any.
+TTY::~TTY() noexcept
+{
+    flush();
+    close();
+}
+
+/// @brief Writes output to a stream, such as `stdout`. The stream is not
+/// closed by the TTY.
+/// @param s The stream to write to.
+auto TTY::to_stream(FILE* s) noexcept -> void
+{
+    flush();
+    close();
+
+    sink   = Sink::Stream;
+    stream = s;
+}
+
+/// @brief Writes output to a file, replacing its contents.
+/// @param path The path of the file to write to.
+/// @return `false` if the file couldn't be opened, in which case the previous
+/// sink is kept.
+auto TTY::to_file(const std::string& path) noexcept -> bool
+{
+    FILE* file{ std::fopen(path.c_str(), "w") };
+
+    if (!file)
+    {
+        return false;
+    }
+
+    to_stream(file);
+    owns_stream = true;
+
+    return true;
+}
+
+/// @brief Hands output to a callback.
+/// @param cb The function to call with each line.
+auto TTY::to_callback(Callback cb) noexcept -> void
+{
+    flush();
+    close();
+
+    sink     = Sink::Callback;
+    callback = std::move(cb);
+}
+
+/// @brief Discards all output.
+auto TTY::discard() noexcept -> void
+{
+    flush();
+    close();
+
+    sink = Sink::None;
+}
+
+/// @brief Sets a string to write at the beginning of every line, e.g. to tell
+/// instances apart.
+/// @param p The string to use.
+auto TTY::set_prefix(const std::string& p) noexcept -> void
+{
+    prefix = p;
+}
+
+/// @brief Hands any buffered output to the sink.
+auto TTY::flush() noexcept -> void
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    switch (sink)
+    {
+        case Sink::None:
+            break;
+
+        case Sink::Stream:
+            // A single call per line; stdio locks the stream for its
+            // duration, so lines from other instances can't end up in the
+            // middle of ours.
+            std::fwrite(buffer.data(), 1, length, stream);
+            break;
+
+        case Sink::Callback:
+            callback(buffer.data(), length);
+            break;
+    }
+    length = 0;
+}
+
+/// @brief Adds a string to the buffer, flushing as necessary.
+/// @param data The characters to add.
+/// @param size The number of characters.
+auto TTY::write(const char* data, std::size_t size) noexcept -> void
+{
+    while (size != 0)
+    {
+        const auto chunk{ std::min(size, buffer.size() - length) };
+
+        std::memcpy(&buffer[length], data, chunk);
+
+        length += chunk;
+        data   += chunk;
+        size   -= chunk;
+
+        if (length == buffer.size())
+        {
+            flush();
+        }
+    }
+}
+
+/// @brief Closes the file opened by `to_file()`, if any.
+auto TTY::close() noexcept -> void
+{
+    if (owns_stream)
+    {
+        std::fclose(stream);
+
+        owns_stream = false;
+        stream      = stdout;
+    }
+}
@@ -0,0 +1,419 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <libretro.h>
+#include "../libpsemu/include/file.h"
+#include "../libpsemu/include/ps.h"
+#include "../libpsemu/include/snapshot.h"
+
+/// @brief BIOS image looked for in the frontend's system directory. Without
+/// it, EXEs are started directly.
+constexpr const char* BIOS_FILE{ "scph1001.bin" };
+
+/// @brief Frames per second presented to the frontend
+constexpr unsigned int FRAME_RATE{ 60 };
+
+/// @brief Audio sample rate reported to the frontend
+constexpr unsigned int SAMPLE_RATE{ 44100 };
+
+/// @brief Stereo samples sent to the frontend each frame
+constexpr std::size_t SAMPLES_PER_FRAME{ SAMPLE_RATE / FRAME_RATE };
+
+/// @brief Bit cleared in `System::pads` by each button of the RetroPad, in
+/// the order of the RETRO_DEVICE_ID_JOYPAD_* constants. The PlayStation's
+/// face buttons are mapped by position, i.e. B is Cross.
+constexpr std::array<PlayStation::Halfword, 16> PAD_BITS
+{
+    1 << 14, // B:      Cross
+    1 << 15, // Y:      Square
+    1 << 0,  // Select: Select
+    1 << 3,  // Start:  Start
+    1 << 4,  // Up:     Up
+    1 << 6,  // Down:   Down
+    1 << 7,  // Left:   Left
+    1 << 5,  // Right:  Right
+    1 << 13, // A:      Circle
+    1 << 12, // X:      Triangle
+    1 << 10, // L:      L1
+    1 << 11, // R:      R1
+    1 << 8,  // L2:     L2
+    1 << 9,  // R2:     R2
+    1 << 1,  // L3:     L3
+    1 << 2   // R3:     R3
+};
+
+/// @brief Frontend callbacks
+static retro_environment_t environment;
+static retro_video_refresh_t video_refresh;
+static retro_audio_sample_batch_t audio_sample_batch;
+static retro_input_poll_t input_poll;
+static retro_input_state_t input_state;
+
+/// @brief The emulated system, which is rather large and kept off of the
+/// stack.
+static std::unique_ptr<PlayStation::System> emulator;
+
+/// @brief The EXE being run
+static PlayStation::EXE exe;
+
+/// @brief Has a BIOS been loaded?
+static bool has_bios;
+
+/// @brief Cheat codes enabled by the frontend
+static PlayStation::Cheats cheats;
+
+/// @brief State being serialized or unserialized
+static PlayStation::Snapshot state;
+
+/// @brief Frame buffer used when the frontend doesn't provide one
+static std::vector<std::uint16_t> frame_buffer;
+
+/// @brief Sent to the frontend until sound is emulated
+static std::array<std::int16_t, SAMPLES_PER_FRAME * 2> silence;
+
+/// @brief Loads the BIOS from the frontend's system directory, if it's there.
+/// @return `false` if there is no BIOS.
+static auto load_bios() noexcept -> bool
+{
+    const char* directory{ nullptr };
+
+    if (!environment(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &directory) ||
+        !directory)
+    {
+        return false;
+    }
+
+    PlayStation::BIOS bios;
+
+    if (!PlayStation::read_bios(std::string{ directory } + "/" + BIOS_FILE,
+                                bios))
+    {
+        return false;
+    }
+
+    emulator->set_bios_data(bios);
+    return true;
+}
+
+/// @brief Boots the system and starts the EXE.
+/// @return `false` if the BIOS didn't reach the shell.
+static auto boot() noexcept -> bool
+{
+    if (has_bios)
+    {
+        return emulator->boot_exe(exe);
+    }
+
+    emulator->fast_boot(exe);
+    return true;
+}
+
+/// @brief Converts VRAM to the RGB565 format the frontend is given.
+/// @param dst Where to write the frame.
+/// @param pitch The distance between two lines of `dst`, in bytes.
+static auto convert_frame(void* dst, const std::size_t pitch) noexcept -> void
+{
+    using namespace PlayStation;
+
+    const auto& vram{ emulator->bus.gpu.vram };
+
+    for (auto y{ 0 }; y < VRAM_HEIGHT; ++y)
+    {
+        const Halfword* src{ &vram[y * VRAM_WIDTH] };
+        auto line{ reinterpret_cast<std::uint16_t*>(static_cast<Byte*>(dst) +
+                                                    (y * pitch)) };
+
+        // VRAM holds 5 bits per channel, blue in the upper bits.
+        for (auto x{ 0 }; x < VRAM_WIDTH; ++x)
+        {
+            const unsigned int r{ src[x] & 0x1Fu };
+            const unsigned int g{ (src[x] >> 5) & 0x1Fu };
+            const unsigned int b{ (src[x] >> 10) & 0x1Fu };
+
+            // Green has a sixth bit, filled with its top one.
+            line[x] = static_cast<std::uint16_t>((r << 11) |
+                                                 (g << 6) |
+                                                 ((g >> 4) << 5) |
+                                                 b);
+        }
+    }
+}
+
+/// @brief Sends the current frame to the frontend, converting it straight
+/// into the frontend's own buffer if it has one.
+static auto present_frame() noexcept -> void
+{
+    using namespace PlayStation;
+
+    retro_framebuffer frame{ };
+
+    frame.width        = VRAM_WIDTH;
+    frame.height       = VRAM_HEIGHT;
+    frame.access_flags = RETRO_MEMORY_ACCESS_WRITE;
+
+    if (environment(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER,
+                    &frame) &&
+        frame.data &&
+        frame.format == RETRO_PIXEL_FORMAT_RGB565)
+    {
+        convert_frame(frame.data, frame.pitch);
+        video_refresh(frame.data, VRAM_WIDTH, VRAM_HEIGHT, frame.pitch);
+
+        return;
+    }
+
+    constexpr std::size_t pitch{ VRAM_WIDTH * sizeof(std::uint16_t) };
+
+    convert_frame(frame_buffer.data(), pitch);
+    video_refresh(frame_buffer.data(), VRAM_WIDTH, VRAM_HEIGHT, pitch);
+}
+
+RETRO_API void retro_set_environment(retro_environment_t callback)
+{
+    environment = callback;
+}
+
+RETRO_API void retro_set_video_refresh(retro_video_refresh_t callback)
+{
+    video_refresh = callback;
+}
+
+RETRO_API void retro_set_audio_sample(retro_audio_sample_t)
+{ }
+
+RETRO_API void retro_set_audio_sample_batch(retro_audio_sample_batch_t callback)
+{
+    audio_sample_batch = callback;
+}
+
+RETRO_API void retro_set_input_poll(retro_input_poll_t callback)
+{
+    input_poll = callback;
+}
+
+RETRO_API void retro_set_input_state(retro_input_state_t callback)
+{
+    input_state = callback;
+}
+
+RETRO_API void retro_init(void)
+{
+    emulator = std::make_unique<PlayStation::System>();
+    emulator->cheats = &cheats;
+
+    frame_buffer.resize(PlayStation::VRAM_WIDTH * PlayStation::VRAM_HEIGHT);
+}
+
+RETRO_API void retro_deinit(void)
+{
+    emulator.reset();
+    cheats.clear();
+    frame_buffer = { };
+}
+
+RETRO_API unsigned retro_api_version(void)
+{
+    return RETRO_API_VERSION;
+}
+
+RETRO_API void retro_get_system_info(retro_system_info* info)
+{
+    *info = { };
+
+    info->library_name     = "psemu";
+    info->library_version  = "0.1";
+    info->valid_extensions = "exe|psx";
+    info->need_fullpath    = false;
+}
+
+RETRO_API void retro_get_system_av_info(retro_system_av_info* info)
+{
+    using namespace PlayStation;
+
+    *info = { };
+
+    info->geometry.base_width   = VRAM_WIDTH;
+    info->geometry.base_height  = VRAM_HEIGHT;
+    info->geometry.max_width    = VRAM_WIDTH;
+    info->geometry.max_height   = VRAM_HEIGHT;
+    info->geometry.aspect_ratio = static_cast<float>(VRAM_WIDTH) /
+                                  static_cast<float>(VRAM_HEIGHT);
+
+    info->timing.fps         = FRAME_RATE;
+    info->timing.sample_rate = SAMPLE_RATE;
+}
+
+RETRO_API void retro_set_controller_port_device(unsigned, unsigned)
+{ }
+
+RETRO_API void retro_reset(void)
+{
+    // The frontend may have written to memory through retro_get_memory_data()
+    // without the system knowing, which resetting must not miss.
+    emulator->bus.mark_dirty(0, PlayStation::RAM_SIZE);
+    emulator->bus.gpu.vram_dirty.fill(PlayStation::DIRTY_ALL);
+
+    // The BIOS reached the shell when the game was loaded, it does again.
+    boot();
+}
+
+RETRO_API void retro_run(void)
+{
+    input_poll();
+
+    for (unsigned int port{ 0 }; port < emulator->pads.size(); ++port)
+    {
+        PlayStation::Halfword pad{ 0xFFFF };
+
+        for (unsigned int id{ 0 }; id < PAD_BITS.size(); ++id)
+        {
+            if (input_state(port, RETRO_DEVICE_JOYPAD, 0, id))
+            {
+                pad &= ~PAD_BITS[id];
+            }
+        }
+        emulator->pads[port] = pad;
+    }
+
+    // Once the EXE has exited, its last frame stays on screen.
+    if (!emulator->hle.exited())
+    {
+        emulator->run_frame();
+    }
+
+    present_frame();
+    audio_sample_batch(silence.data(), SAMPLES_PER_FRAME);
+}
+
+RETRO_API size_t retro_serialize_size(void)
+{
+    return PlayStation::Snapshot::serialized_size();
+}
+
+RETRO_API bool retro_serialize(void* data, size_t size)
+{
+    if (size < PlayStation::Snapshot::serialized_size())
+    {
+        return false;
+    }
+
+    // Frontends save states every frame for rewinding and running ahead, so
+    // memory is copied straight into theirs.
+    state.serialize(*emulator, static_cast<PlayStation::Byte*>(data));
+
+    return true;
+}
+
+RETRO_API bool retro_unserialize(const void* data, size_t size)
+{
+    if (!state.unserialize(static_cast<const PlayStation::Byte*>(data), size))
+    {
+        return false;
+    }
+
+    state.load(*emulator);
+    return true;
+}
+
+RETRO_API void retro_cheat_reset(void)
+{
+    cheats.clear();
+}
+
+// Frontends don't say when a single cheat is disabled, they reset them all and
+// set the enabled ones again.
+RETRO_API void retro_cheat_set(unsigned, bool enabled, const char* code)
+{
+    if (enabled && code)
+    {
+        cheats.add(code);
+    }
+}
+
+RETRO_API bool retro_load_game(const retro_game_info* game)
+{
+    if (!game || !game->data)
+    {
+        return false;
+    }
+
+    auto format{ RETRO_PIXEL_FORMAT_RGB565 };
+
+    if (!environment(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &format))
+    {
+        return false;
+    }
+
+    const auto data{ static_cast<const PlayStation::Byte*>(game->data) };
+
+    if (!exe.load({ data, data + game->size }))
+    {
+        return false;
+    }
+
+    has_bios = load_bios();
+    return boot();
+}
+
+RETRO_API bool retro_load_game_special(unsigned,
+                                       const retro_game_info*,
+                                       size_t)
+{
+    return false;
+}
+
+RETRO_API void retro_unload_game(void)
+{
+    emulator->reset();
+}
+
+RETRO_API unsigned retro_get_region(void)
+{
+    return RETRO_REGION_NTSC;
+}
+
+RETRO_API void* retro_get_memory_data(unsigned id)
+{
+    switch (id)
+    {
+        case RETRO_MEMORY_SYSTEM_RAM:
+            return emulator->bus.ram.data();
+
+        case RETRO_MEMORY_VIDEO_RAM:
+            return emulator->bus.gpu.vram.data();
+
+        default:
+            return nullptr;
+    }
+}
+
+RETRO_API size_t retro_get_memory_size(unsigned id)
+{
+    switch (id)
+    {
+        case RETRO_MEMORY_SYSTEM_RAM:
+            return emulator->bus.ram.size();
+
+        case RETRO_MEMORY_VIDEO_RAM:
+            return sizeof(PlayStation::VRAM);
+
+        default:
+            return 0;
+    }
+}
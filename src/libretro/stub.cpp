@@ -0,0 +1,285 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <libretro.h>
+#include "../libpsemu/include/file.h"
+
+/// @brief Pitch of the frame buffer given to the core, which is deliberately
+/// not that of VRAM to catch a core ignoring it.
+constexpr std::size_t FRAME_BUFFER_PITCH{ 2304 };
+
+/// @brief Height of the frame buffer given to the core
+constexpr std::size_t FRAME_BUFFER_HEIGHT{ 512 };
+
+/// @brief Directory given to the core to look for a BIOS in, if any
+static const char* system_directory;
+
+/// @brief Should the core render into `frame_buffer`?
+static bool provide_frame_buffer;
+
+/// @brief Frame buffer given to the core when asked for
+static std::vector<std::uint8_t> frame_buffer(FRAME_BUFFER_PITCH *
+                                              FRAME_BUFFER_HEIGHT);
+
+/// @brief Hash of the last frame presented by the core
+static std::uint64_t frame_hash;
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s [--frames N] [--system DIR] EXE\n"
+                 "\n"
+                 "Runs a PS-X EXE on the libretro core, saves its state, and "
+                 "checks that\n"
+                 "loading the state back replays the same frames.\n"
+                 "\n"
+                 "  --frames N    Frames to run before saving the state, and "
+                 "again after it\n"
+                 "                (default: 60)\n"
+                 "  --system DIR  Directory the core looks for a BIOS in "
+                 "(default: none, the\n"
+                 "                EXE is started directly)\n",
+                 program);
+}
+
+/// @brief Answers the core's requests of the frontend.
+/// @param cmd The request.
+/// @param data The request's argument.
+/// @return `false` if the request isn't supported.
+static auto environment(unsigned cmd, void* data) -> bool
+{
+    switch (cmd)
+    {
+        case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+            *static_cast<const char**>(data) = system_directory;
+            return system_directory != nullptr;
+
+        case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+            return *static_cast<const retro_pixel_format*>(data) ==
+                   RETRO_PIXEL_FORMAT_RGB565;
+
+        case RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER:
+        {
+            if (!provide_frame_buffer)
+            {
+                return false;
+            }
+
+            auto frame{ static_cast<retro_framebuffer*>(data) };
+
+            frame->data   = frame_buffer.data();
+            frame->pitch  = FRAME_BUFFER_PITCH;
+            frame->format = RETRO_PIXEL_FORMAT_RGB565;
+
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+/// @brief Hashes a frame presented by the core. Only the visible part of each
+/// line is hashed, so that frames are the same no matter whose buffer they
+/// were rendered into.
+static auto video_refresh(const void* data,
+                          unsigned width,
+                          unsigned height,
+                          std::size_t pitch) -> void
+{
+    std::uint64_t hash{ 0xCBF29CE484222325 };
+
+    for (unsigned int y{ 0 }; y < height; ++y)
+    {
+        const auto line{ static_cast<const std::uint8_t*>(data) + (y * pitch) };
+
+        for (std::size_t x{ 0 }; x < width * sizeof(std::uint16_t); ++x)
+        {
+            hash = (hash ^ line[x]) * 0x100000001B3;
+        }
+    }
+    frame_hash = hash;
+}
+
+/// @brief Discards audio from the core.
+static auto audio_sample(std::int16_t, std::int16_t) -> void
+{ }
+
+/// @brief Discards audio from the core.
+static auto audio_sample_batch(const std::int16_t*, std::size_t frames)
+-> std::size_t
+{
+    return frames;
+}
+
+/// @brief Leaves every button released.
+static auto input_poll() -> void
+{ }
+
+/// @brief Leaves every button released.
+static auto input_state(unsigned, unsigned, unsigned, unsigned) -> std::int16_t
+{
+    return 0;
+}
+
+/// @brief Runs the core, then saves its state.
+/// @param frames The number of frames to run.
+/// @param state Where to save the state.
+/// @return `false` if the state couldn't be saved.
+static auto run(const unsigned long frames, std::vector<std::uint8_t>& state)
+-> bool
+{
+    for (unsigned long frame{ 0 }; frame < frames; ++frame)
+    {
+        retro_run();
+    }
+    return retro_serialize(state.data(), state.size());
+}
+
+int main(int argc, char* argv[])
+{
+    const char* exe_path{ nullptr };
+    unsigned long frames{ 60 };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frames = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--system") == 0 && index + 1 < argc)
+        {
+            system_directory = argv[++index];
+        }
+        else if (argv[index][0] != '-' && !exe_path)
+        {
+            exe_path = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!exe_path || frames == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<PlayStation::Byte> exe;
+
+    if (!PlayStation::read_file(exe_path, exe))
+    {
+        std::fprintf(stderr, "Unable to read %s\n", exe_path);
+        return EXIT_FAILURE;
+    }
+
+    if (retro_api_version() != RETRO_API_VERSION)
+    {
+        std::fprintf(stderr, "The core uses a different libretro API\n");
+        return EXIT_FAILURE;
+    }
+
+    retro_set_environment(environment);
+    retro_set_video_refresh(video_refresh);
+    retro_set_audio_sample(audio_sample);
+    retro_set_audio_sample_batch(audio_sample_batch);
+    retro_set_input_poll(input_poll);
+    retro_set_input_state(input_state);
+
+    retro_init();
+
+    const retro_game_info game{ exe_path, exe.data(), exe.size(), nullptr };
+
+    if (!retro_load_game(&game))
+    {
+        std::fprintf(stderr, "The core didn't load %s\n", exe_path);
+        retro_deinit();
+
+        return EXIT_FAILURE;
+    }
+
+    const auto size{ retro_serialize_size() };
+
+    std::vector<std::uint8_t> saved(size);
+    std::vector<std::uint8_t> expected(size);
+    std::vector<std::uint8_t> replayed(size);
+
+    auto result{ EXIT_FAILURE };
+
+    if (!run(frames, saved) || !run(frames, expected))
+    {
+        std::fprintf(stderr, "The core didn't save its state\n");
+    }
+    else
+    {
+        const auto expected_hash{ frame_hash };
+
+        // A state cut short must be refused rather than half loaded.
+        if (retro_unserialize(saved.data(), size - 1))
+        {
+            std::fprintf(stderr, "The core loaded a truncated state\n");
+        }
+        else if (!retro_unserialize(saved.data(), size))
+        {
+            std::fprintf(stderr, "The core didn't load its own state\n");
+        }
+        else
+        {
+            // Replay into a buffer of our own, which the core must render the
+            // same frame into.
+            provide_frame_buffer = true;
+
+            if (!run(frames, replayed))
+            {
+                std::fprintf(stderr, "The core didn't save its state\n");
+            }
+            else if (frame_hash != expected_hash)
+            {
+                std::fprintf(stderr,
+                             "Frame %lu differs after loading the state\n",
+                             frames * 2);
+            }
+            else if (replayed != expected)
+            {
+                std::fprintf(stderr,
+                             "The state after frame %lu differs after "
+                             "loading the state\n",
+                             frames * 2);
+            }
+            else
+            {
+                std::printf("%lu frames replayed from a %zu byte state\n",
+                            frames,
+                            size);
+
+                result = EXIT_SUCCESS;
+            }
+        }
+    }
+
+    retro_unload_game();
+    retro_deinit();
+
+    return result;
+}
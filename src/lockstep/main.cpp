@@ -0,0 +1,199 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "../libpsemu/include/file.h"
+#include "../libpsemu/include/lockstep.h"
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s [--bios FILE [--no-hle-a] [--no-hle-b]] "
+                 "[--frames N] [--block] EXE\n"
+                 "\n"
+                 "Runs a PS-X EXE on two systems in lockstep and reports the "
+                 "first divergence.\n"
+                 "The TTY output of the reference system (A) is written to "
+                 "stdout.\n"
+                 "\n"
+                 "  --bios FILE  Boot the EXE through a BIOS image instead of "
+                 "starting it\n"
+                 "               directly\n"
+                 "  --no-hle-a   Execute the BIOS kernel functions on system A "
+                 "instead of\n"
+                 "               emulating them (requires --bios)\n"
+                 "  --no-hle-b   Likewise, for system B\n"
+                 "  --frames N   Stop after N frames (default: run until the "
+                 "EXE exits)\n"
+                 "  --block      Compare registers after every jump or taken "
+                 "branch instead\n"
+                 "               of after every instruction\n",
+                 program);
+}
+
+/// @brief Disables the emulation of every BIOS kernel function.
+/// @param system The system to change.
+static auto disable_hle(PlayStation::System& system) noexcept -> void
+{
+    using PlayStation::HLE;
+
+    for (auto f{ 0 }; f < HLE::FunctionCount; ++f)
+    {
+        system.hle.enable(static_cast<HLE::Function>(f), false);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* bios_path{ nullptr };
+    const char* exe_path{ nullptr };
+    bool hle_a{ true };
+    bool hle_b{ true };
+    bool block{ false };
+    unsigned long frames{ 0 };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--bios") == 0 && index + 1 < argc)
+        {
+            bios_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frames = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--no-hle-a") == 0)
+        {
+            hle_a = false;
+        }
+        else if (std::strcmp(argv[index], "--no-hle-b") == 0)
+        {
+            hle_b = false;
+        }
+        else if (std::strcmp(argv[index], "--block") == 0)
+        {
+            block = true;
+        }
+        else if (argv[index][0] != '-' && !exe_path)
+        {
+            exe_path = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Without the BIOS, there is nothing to fall back to.
+    if (!exe_path || (!bios_path && (!hle_a || !hle_b)))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::EXE exe;
+
+    if (!exe.load_file(exe_path))
+    {
+        std::fprintf(stderr, "%s is not a readable PS-X EXE\n", exe_path);
+        return EXIT_FAILURE;
+    }
+
+    // The systems are rather large, keep them off of the stack.
+    auto a{ std::make_unique<PlayStation::System>() };
+    auto b{ std::make_unique<PlayStation::System>() };
+
+    b->tty.discard();
+
+    if (bios_path)
+    {
+        PlayStation::BIOS bios;
+
+        if (!PlayStation::read_bios(bios_path, bios))
+        {
+            std::fprintf(stderr, "Unable to read BIOS %s\n", bios_path);
+            return EXIT_FAILURE;
+        }
+
+        if (!hle_a)
+        {
+            disable_hle(*a);
+        }
+
+        if (!hle_b)
+        {
+            disable_hle(*b);
+        }
+
+        a->set_bios_data(bios);
+        b->set_bios_data(bios);
+
+        if (!a->boot_exe(exe) || !b->boot_exe(exe))
+        {
+            std::fprintf(stderr,
+                         "%s didn't reach the shell within %u frames\n",
+                         bios_path,
+                         PlayStation::System::BOOT_FRAME_LIMIT);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        a->fast_boot(exe);
+        b->fast_boot(exe);
+    }
+
+    PlayStation::Lockstep lockstep{ *a, *b };
+
+    lockstep.resync_kernel_calls = hle_a != hle_b;
+    lockstep.granularity = block ? PlayStation::Lockstep::Granularity::Block :
+                                   PlayStation::Lockstep::Granularity::Instruction;
+
+    for (unsigned long frame{ 0 }; frames == 0 || frame < frames; ++frame)
+    {
+        const auto result{ lockstep.run_frame() };
+
+        if (result == PlayStation::Lockstep::Result::Diverged)
+        {
+            a->tty.flush();
+            std::fflush(stdout);
+
+            std::fprintf(stderr, "Divergence in frame %lu\n", frame);
+            lockstep.print_report(stderr);
+
+            return EXIT_FAILURE;
+        }
+
+        if (result == PlayStation::Lockstep::Result::Exited)
+        {
+            break;
+        }
+    }
+
+    a->tty.flush();
+    std::fflush(stdout);
+
+    std::fprintf(stderr,
+                 "No divergence after %llu instructions\n",
+                 static_cast<unsigned long long>(lockstep.instructions()));
+
+    return EXIT_SUCCESS;
+}
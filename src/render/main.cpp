@@ -0,0 +1,362 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../libpsemu/include/file.h"
+#include "../libpsemu/include/ps.h"
+#include "../libpsemu/include/snapshot.h"
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s [--bios FILE] [--interval SECONDS] [--jobs N] "
+                 "--frames N EXE OUTPUT\n"
+                 "\n"
+                 "Renders a PS-X EXE to a YUV4MPEG2 video in parallel. The EXE "
+                 "is run once without\n"
+                 "output, keeping the state of the system every few seconds. "
+                 "The segments\n"
+                 "between those keyframes are then rendered on as many "
+                 "threads as requested and\n"
+                 "joined into OUTPUT. Emulation is deterministic, so the "
+                 "video is the same as\n"
+                 "if it had been recorded in one go.\n"
+                 "\n"
+                 "  --bios FILE  Boot the EXE through a BIOS image instead of "
+                 "starting it\n"
+                 "               directly\n"
+                 "  --frames N   Render N frames, or fewer if the EXE exits "
+                 "first (required)\n"
+                 "  --interval SECONDS\n"
+                 "               Emulated time between keyframes (default: "
+                 "10)\n"
+                 "  --jobs N     Number of segments rendered at once (default: "
+                 "one per core)\n",
+                 program);
+}
+
+/// @brief Runs a system for up to a number of frames.
+/// @param system The system to run.
+/// @param frames The number of frames to run.
+/// @return The number of frames run, which is less than asked for if the EXE
+/// exited.
+static auto run_frames(PlayStation::System& system,
+                       const unsigned long frames) noexcept -> unsigned long
+{
+    unsigned long frame{ 0 };
+
+    while (frame < frames)
+    {
+        if (system.run_frame())
+        {
+            frame++;
+        }
+        else if (system.hle.exited())
+        {
+            break;
+        }
+    }
+    return frame;
+}
+
+/// @brief Appends a YUV4MPEG2 file to another.
+/// @param output The stream to append to.
+/// @param path The path of the file to append.
+/// @param header Append the stream header too, or only the frames?
+/// @return `false` if the file couldn't be read or written.
+static auto append_file(FILE* output,
+                        const std::string& path,
+                        const bool header) noexcept -> bool
+{
+    FILE* input{ std::fopen(path.c_str(), "rb") };
+
+    if (!input)
+    {
+        return false;
+    }
+
+    bool ok{ true };
+
+    if (!header)
+    {
+        int c;
+
+        while ((c = std::fgetc(input)) != EOF && c != '\n')
+        { }
+
+        ok = c == '\n';
+    }
+
+    std::vector<char> buffer(1 << 20);
+
+    while (ok)
+    {
+        const auto read{ std::fread(buffer.data(), 1, buffer.size(), input) };
+
+        if (read == 0)
+        {
+            break;
+        }
+        ok = std::fwrite(buffer.data(), 1, read, output) == read;
+    }
+
+    ok = ok && !std::ferror(input);
+    std::fclose(input);
+
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* bios_path{ nullptr };
+    const char* exe_path{ nullptr };
+    const char* output_path{ nullptr };
+    unsigned long frames{ 0 };
+    unsigned long interval{ 10 };
+    unsigned int jobs{ std::max(1U, std::thread::hardware_concurrency()) };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--bios") == 0 && index + 1 < argc)
+        {
+            bios_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+        {
+            frames = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--interval") == 0 &&
+                 index + 1 < argc)
+        {
+            interval = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--jobs") == 0 && index + 1 < argc)
+        {
+            jobs = std::strtoul(argv[++index], nullptr, 10);
+        }
+        else if (argv[index][0] != '-' && !exe_path)
+        {
+            exe_path = argv[index];
+        }
+        else if (argv[index][0] != '-' && !output_path)
+        {
+            output_path = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A keyframe is kept every interval, so the length of the video must be
+    // bounded.
+    if (!exe_path || !output_path || frames == 0 || interval == 0 ||
+        jobs == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::EXE exe;
+
+    if (!exe.load_file(exe_path))
+    {
+        std::fprintf(stderr, "%s is not a readable PS-X EXE\n", exe_path);
+        return EXIT_FAILURE;
+    }
+
+    // The system is rather large, keep it off of the stack.
+    auto system{ std::make_unique<PlayStation::System>() };
+    system->tty.discard();
+
+    PlayStation::BIOS bios;
+
+    if (bios_path)
+    {
+        if (!PlayStation::read_bios(bios_path, bios))
+        {
+            std::fprintf(stderr, "Unable to read BIOS %s\n", bios_path);
+            return EXIT_FAILURE;
+        }
+
+        system->set_bios_data(bios);
+
+        if (!system->boot_exe(exe))
+        {
+            std::fprintf(stderr,
+                         "%s didn't reach the shell within %u frames\n",
+                         bios_path,
+                         PlayStation::System::BOOT_FRAME_LIMIT);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        system->fast_boot(exe);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto start{ Clock::now() };
+
+    // First pass: find out how long the video is, keeping the state of the
+    // system at the start of every segment.
+    const auto segment_frames{ interval * PlayStation::Recorder::FRAME_RATE };
+
+    std::vector<PlayStation::Snapshot> keyframes;
+    unsigned long total{ 0 };
+
+    for (;;)
+    {
+        keyframes.emplace_back();
+        keyframes.back().capture(*system);
+
+        const auto length{ std::min(segment_frames, frames - total) };
+
+        const auto run{ run_frames(*system, length) };
+        total += run;
+
+        if (run < length || total == frames)
+        {
+            break;
+        }
+    }
+
+    // The last keyframe is only useful if frames follow it.
+    keyframes.erase(keyframes.begin() +
+                    std::max<std::size_t>(1, (total + segment_frames - 1) /
+                                             segment_frames),
+                    keyframes.end());
+
+    // The keyframes hold all that is needed from here on.
+    system.reset();
+
+    const std::chrono::duration<double> scan_time{ Clock::now() - start };
+
+    std::fprintf(stderr,
+                 "%lu frames, %zu segments (%.2f s)\n",
+                 total,
+                 keyframes.size(),
+                 scan_time.count());
+
+    // Second pass: render the segments in parallel.
+    const auto part_path = [&](const std::size_t segment)
+    {
+        return std::string{ output_path } + ".part" + std::to_string(segment) +
+               ".y4m";
+    };
+
+    std::atomic<std::size_t> next_segment{ 0 };
+    std::atomic<bool> failed{ false };
+
+    const auto render = [&]()
+    {
+        for (;;)
+        {
+            const auto segment{ next_segment.fetch_add(1) };
+
+            if (segment >= keyframes.size())
+            {
+                return;
+            }
+
+            auto worker{ std::make_unique<PlayStation::System>() };
+            worker->tty.discard();
+
+            if (bios_path)
+            {
+                worker->set_bios_data(bios);
+            }
+
+            keyframes[segment].load(*worker);
+
+            PlayStation::Recorder recorder;
+            recorder.drop_frames = false;
+
+            if (!recorder.open(part_path(segment)))
+            {
+                failed = true;
+                return;
+            }
+
+            worker->recorder = &recorder;
+
+            const auto first{ segment * segment_frames };
+            run_frames(*worker, std::min<unsigned long>(segment_frames,
+                                                        total - first));
+
+            if (!recorder.close())
+            {
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (unsigned int job{ 0 }; job < std::min<std::size_t>(jobs,
+                                                            keyframes.size());
+         ++job)
+    {
+        threads.emplace_back(render);
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Join the segments, keeping the stream header of the first only.
+    FILE* output{ failed ? nullptr : std::fopen(output_path, "wb") };
+    bool ok{ output != nullptr };
+
+    for (std::size_t segment{ 0 }; segment < keyframes.size(); ++segment)
+    {
+        const auto path{ part_path(segment) };
+
+        ok = ok && append_file(output, path, segment == 0);
+        std::remove(path.c_str());
+    }
+
+    if (output)
+    {
+        ok = std::fclose(output) == 0 && ok;
+    }
+
+    if (!ok)
+    {
+        std::fprintf(stderr, "Unable to write %s\n", output_path);
+        return EXIT_FAILURE;
+    }
+
+    const std::chrono::duration<double> time{ Clock::now() - start };
+
+    std::fprintf(stderr,
+                 "Rendered in %.2f s with %zu threads\n",
+                 time.count(),
+                 threads.size());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+// Copyright 2020 Michael Rodriguez
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS.IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "../libpsemu/include/disasm.h"
+#include "../libpsemu/include/file.h"
+#include "../libpsemu/include/ps.h"
+#include "../libpsemu/include/trace.h"
+
+/// @brief Prints the usage of the program.
+/// @param program The name of the program.
+static auto usage(const char* program) noexcept -> void
+{
+    std::fprintf(stderr,
+                 "usage: %s [--bios FILE] [--exe FILE] TRACE\n"
+                 "\n"
+                 "Executes the BIOS and/or a PS-X EXE and compares every "
+                 "instruction against a\n"
+                 "binary trace (see trace.h), stopping at the first "
+                 "mismatch.\n"
+                 "\n"
+                 "  --bios FILE  Start from reset with this BIOS image. If "
+                 "an EXE is also\n"
+                 "               given, it is loaded once the BIOS reaches "
+                 "the shell. BIOS\n"
+                 "               functions are always executed, not "
+                 "emulated.\n"
+                 "  --exe FILE   Start this EXE (without a BIOS, from its "
+                 "entry point)\n",
+                 program);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* bios_path{ nullptr };
+    const char* exe_path{ nullptr };
+    const char* trace_path{ nullptr };
+
+    for (auto index{ 1 }; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--bios") == 0 && index + 1 < argc)
+        {
+            bios_path = argv[++index];
+        }
+        else if (std::strcmp(argv[index], "--exe") == 0 && index + 1 < argc)
+        {
+            exe_path = argv[++index];
+        }
+        else if (argv[index][0] != '-' && !trace_path)
+        {
+            trace_path = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!trace_path || (!bios_path && !exe_path))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::TraceReader trace;
+
+    if (!trace.open(trace_path))
+    {
+        std::fprintf(stderr, "%s is not a readable trace\n", trace_path);
+        return EXIT_FAILURE;
+    }
+
+    PlayStation::EXE exe;
+
+    if (exe_path)
+    {
+        if (!exe.load_file(exe_path))
+        {
+            std::fprintf(stderr, "%s is not a readable PS-X EXE\n", exe_path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The system is rather large, keep it off of the stack.
+    auto system{ std::make_unique<PlayStation::System>() };
+    PlayStation::Hooks::Handle shell{ 0 };
+
+    if (bios_path)
+    {
+        PlayStation::BIOS bios;
+
+        if (!PlayStation::read_bios(bios_path, bios))
+        {
+            std::fprintf(stderr, "Unable to read BIOS %s\n", bios_path);
+            return EXIT_FAILURE;
+        }
+
+        // The reference executes the BIOS, so must we.
+        using PlayStation::HLE;
+
+        for (auto f{ 0 }; f < HLE::FunctionCount; ++f)
+        {
+            system->hle.enable(static_cast<HLE::Function>(f), false);
+        }
+
+        system->set_bios_data(bios);
+
+        if (exe_path)
+        {
+            shell = system->bus.hooks.add_breakpoint(
+            PlayStation::System::SHELL_ADDRESS,
+            [](const PlayStation::Word)
+            {
+                return PlayStation::HookAction::Break;
+            });
+        }
+    }
+    else
+    {
+        system->fast_boot(exe);
+    }
+
+    PlayStation::TraceRecord previous{ };
+    bool mismatch{ false };
+    bool ended{ false };
+
+    system->on_instruction = [&](const PlayStation::Word pc)
+    {
+        const auto& cpu{ system->cpu };
+        PlayStation::TraceRecord expected;
+
+        if (!trace.next(expected))
+        {
+            ended = true;
+            return;
+        }
+
+        const PlayStation::TraceRecord actual{ pc, cpu.gpr, cpu.hi, cpu.lo };
+
+        if (std::memcmp(&actual, &expected, sizeof(actual)) == 0)
+        {
+            previous = actual;
+            return;
+        }
+
+        mismatch = true;
+
+        system->tty.flush();
+        std::fflush(stdout);
+
+        std::fprintf(stderr,
+                     "Mismatch at instruction %" PRIu64 " of %" PRIu64
+                     " (previous instruction at 0x%08X):\n",
+                     trace.position() - 1,
+                     trace.size(),
+                     previous.pc);
+
+        char text[64];
+
+        PlayStation::format_instruction(
+            PlayStation::decode_instruction(pc, system->bus.fetch(pc)),
+            text,
+            sizeof(text));
+
+        std::fprintf(stderr, "  0x%08X: %s\n", pc, text);
+
+        const auto compare = [](const char* name,
+                                const PlayStation::Word e,
+                                const PlayStation::Word a)
+        {
+            if (e != a)
+            {
+                std::fprintf(stderr,
+                             "  %-5s expected 0x%08X, got 0x%08X\n",
+                             name,
+                             e,
+                             a);
+            }
+        };
+
+        compare("pc", expected.pc, actual.pc);
+
+        for (auto index{ 0 }; index < 32; ++index)
+        {
+            compare(PlayStation::GPR_NAMES[index],
+                    expected.gpr[index],
+                    actual.gpr[index]);
+        }
+
+        compare("hi", expected.hi, actual.hi);
+        compare("lo", expected.lo, actual.lo);
+    };
+
+    while (!mismatch && !ended)
+    {
+        if (!system->step())
+        {
+            if (system->hle.exited())
+            {
+                break;
+            }
+
+            // Reached the shell, inject the EXE and carry on from there.
+            system->bus.hooks.remove(shell);
+            system->load_exe(exe);
+        }
+    }
+
+    if (mismatch)
+    {
+        return EXIT_FAILURE;
+    }
+
+    system->tty.flush();
+    std::fflush(stdout);
+
+    std::fprintf(stderr,
+                 "%" PRIu64 " of %" PRIu64 " instructions match\n",
+                 trace.position(),
+                 trace.size());
+
+    // Either the trace or the program may end first, all that matters is
+    // that all of the trace was checked.
+    return trace.position() == trace.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}